@@ -46,10 +46,23 @@
 #define Dma3FillLarge16_(value, dest, size) Dma3FillLarge_(value, dest, size, 16)
 #define Dma3FillLarge32_(value, dest, size) Dma3FillLarge_(value, dest, size, 32)
 
+// What the last ProcessDma3Requests did. Requests which didn't fit in
+// VBlank are deferred to the next frame.
+struct Dma3Stats
+{
+    u32 bytesMoved;
+    u32 bytesDeferred;
+    u32 estimatedCycles;
+    u8 requestsMoved;
+    u8 requestsDeferred;
+    u16 requestsMerged; // Into pending requests since the frame before.
+};
+
 void ClearDma3Requests(void);
 void ProcessDma3Requests(void);
 s16 RequestDma3Copy(const void *src, void *dest, u16 size, u32 mode);
 s16 RequestDma3Fill(s32 value, void *dest, u16 size, u32 mode);
 s16 CheckForSpaceForDma3Request(s16 index);
+void GetDma3Stats(struct Dma3Stats *stats);
 
 #endif // GUARD_DMA3_H
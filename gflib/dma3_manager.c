@@ -8,17 +8,70 @@
 #define DMA_REQUEST_COPY16 3
 #define DMA_REQUEST_FILL16 4
 
+// Requests to palettes, OAM and sprite tiles are started before the other
+// requests, as they are what's most visibly wrong if they're late.
+#define DMA_PRIORITY_HIGH   0
+#define DMA_PRIORITY_NORMAL 1
+
+#define CYCLES_PER_SCANLINE 1232
+
+// Requests aren't started after this scanline, so that they finish before
+// VBlank does.
+#define LAST_DMA_SCANLINE 224
+
+// Cycles to set up and start each DMA.
+#define DMA_START_CYCLES 16
+
 struct Dma3Request
 {
     const u8 *src;
     u8 *dest;
     u16 size;
-    u16 mode;
+    u8 mode;
+    u8 priority;
     u32 value;
 };
 
+#define DMA_REGION(address) (((uintptr_t)(address) >> 24) & 0xF)
+
+// The bounds of the memory some requests read or write, in each memory region.
+struct Dma3Ranges
+{
+    const u8 *start[16];
+    const u8 *end[16];
+};
+
+// Cycles to read or write 16 and 32 bits in each memory region, with the
+// wait states set in InitMainCallbacks.
+static const u8 sAccessCycles[16][2] =
+{
+    [0x0] = { 1, 1 },   // BIOS
+    [0x1] = { 1, 1 },
+    [0x2] = { 3, 6 },   // EWRAM
+    [0x3] = { 1, 1 },   // IWRAM
+    [0x4] = { 1, 1 },   // I/O
+    [0x5] = { 1, 2 },   // Palettes
+    [0x6] = { 1, 2 },   // VRAM
+    [0x7] = { 1, 1 },   // OAM
+    [0x8] = { 2, 4 },   // ROM (wait state 0)
+    [0x9] = { 2, 4 },
+    [0xA] = { 2, 4 },   // ROM (wait state 1)
+    [0xB] = { 2, 4 },
+    [0xC] = { 9, 18 },  // ROM (wait state 2)
+    [0xD] = { 9, 18 },
+    [0xE] = { 5, 10 },  // SRAM
+    [0xF] = { 1, 1 },
+};
+
 static struct Dma3Request sDma3Requests[MAX_DMA_REQUESTS];
 
+// The pending requests in the order they were made.
+static u8 sDma3Queue[MAX_DMA_REQUESTS];
+static u8 sDma3QueueLength;
+
+static struct Dma3Stats sDma3Stats;
+static u16 sDma3RequestsMerged;
+
 static vbool8 sDma3ManagerLocked;
 static u8 sDma3RequestCursor;
 
@@ -28,6 +81,8 @@ void ClearDma3Requests(void)
 
     sDma3ManagerLocked = TRUE;
     sDma3RequestCursor = 0;
+    sDma3QueueLength = 0;
+    sDma3RequestsMerged = 0;
 
     for (i = 0; i < MAX_DMA_REQUESTS; i++)
     {
@@ -39,115 +94,291 @@ void ClearDma3Requests(void)
     sDma3ManagerLocked = FALSE;
 }
 
-void ProcessDma3Requests(void)
+static bool32 IsFillRequest(const struct Dma3Request *request)
+{
+    return request->mode == DMA_REQUEST_FILL32 || request->mode == DMA_REQUEST_FILL16;
+}
+
+static bool32 RangesOverlap(const u8 *a, u32 aSize, const u8 *b, u32 bSize)
 {
-    u16 bytesTransferred;
+    return a < b + bSize && b < a + aSize;
+}
 
-    if (sDma3ManagerLocked)
-        return;
+// Whether doing 'a' and 'b' in a different order could change the result.
+static bool32 RequestsConflict(const struct Dma3Request *a, const struct Dma3Request *b)
+{
+    if (RangesOverlap(a->dest, a->size, b->dest, b->size))
+        return TRUE;
+    if (!IsFillRequest(a) && RangesOverlap(a->src, a->size, b->dest, b->size))
+        return TRUE;
+    if (!IsFillRequest(b) && RangesOverlap(b->src, b->size, a->dest, a->size))
+        return TRUE;
+    return FALSE;
+}
 
-    bytesTransferred = 0;
+static u32 EstimateDma3RequestCycles(const struct Dma3Request *request)
+{
+    bool32 is32Bit = request->mode == DMA_REQUEST_COPY32 || request->mode == DMA_REQUEST_FILL32;
+    u32 units = request->size / (is32Bit ? 4 : 2);
+    u32 cycles = sAccessCycles[DMA_REGION(request->dest)][is32Bit];
+
+    // Fills read their value from the stack.
+    if (IsFillRequest(request))
+        cycles += 1;
+    else
+        cycles += sAccessCycles[DMA_REGION(request->src)][is32Bit];
+
+    return units * cycles + DMA_START_CYCLES * (1 + request->size / MAX_DMA_BLOCK_SIZE);
+}
+
+static u32 GetDma3RequestPriority(const void *dest)
+{
+    uintptr_t address = (uintptr_t)dest;
+
+    if ((address >= PLTT && address < PLTT + PLTT_SIZE)
+     || (address >= OBJ_VRAM0 && address < VRAM + VRAM_SIZE)
+     || (address >= OAM && address < OAM + OAM_SIZE))
+        return DMA_PRIORITY_HIGH;
+    return DMA_PRIORITY_NORMAL;
+}
 
-    // as long as there are DMA requests to process (unless size or vblank is an issue), do not exit
-    while (sDma3Requests[sDma3RequestCursor].size != 0)
+static void DoDma3Request(struct Dma3Request *request)
+{
+    switch (request->mode)
     {
-        bytesTransferred += sDma3Requests[sDma3RequestCursor].size;
+    case DMA_REQUEST_COPY32: // regular 32-bit copy
+        Dma3CopyLarge32_(request->src, request->dest, request->size);
+        break;
+    case DMA_REQUEST_FILL32: // repeat a single 32-bit value across RAM
+        Dma3FillLarge32_(request->value, request->dest, request->size);
+        break;
+    case DMA_REQUEST_COPY16: // regular 16-bit copy
+        Dma3CopyLarge16_(request->src, request->dest, request->size);
+        break;
+    case DMA_REQUEST_FILL16: // repeat a single 16-bit value across RAM
+        Dma3FillLarge16_(request->value, request->dest, request->size);
+        break;
+    }
+}
+
+// Requests are only started in VBlank, and not once it's about to end.
+static bool32 IsDma3WindowOpen(u32 vcount)
+{
+    return vcount >= DISPLAY_HEIGHT && vcount <= LAST_DMA_SCANLINE;
+}
 
-        if (bytesTransferred > 40 * 1024)
-            return; // don't transfer more than 40 KiB
-        if (*(u8 *)REG_ADDR_VCOUNT > 224)
-            return; // we're about to leave vblank, stop
+// Adds [address, address + size) to 'ranges'. The ranges are kept per memory
+// region, so that e.g. an EWRAM buffer doesn't make every VRAM request look
+// like it conflicts. A request which runs into the next region is added to
+// both.
+static void AddDma3Range(struct Dma3Ranges *ranges, const u8 *address, u32 size)
+{
+    u32 regions[2] = { DMA_REGION(address), DMA_REGION(address + size - 1) };
+    u32 i;
 
-        switch (sDma3Requests[sDma3RequestCursor].mode)
+    for (i = 0; i < ARRAY_COUNT(regions); i++)
+    {
+        u32 region = regions[i];
+        if (ranges->start[region] == ranges->end[region])
         {
-        case DMA_REQUEST_COPY32: // regular 32-bit copy
-            Dma3CopyLarge32_(sDma3Requests[sDma3RequestCursor].src,
-                             sDma3Requests[sDma3RequestCursor].dest,
-                             sDma3Requests[sDma3RequestCursor].size);
-            break;
-        case DMA_REQUEST_FILL32: // repeat a single 32-bit value across RAM
-            Dma3FillLarge32_(sDma3Requests[sDma3RequestCursor].value,
-                             sDma3Requests[sDma3RequestCursor].dest,
-                             sDma3Requests[sDma3RequestCursor].size);
-            break;
-        case DMA_REQUEST_COPY16:    // regular 16-bit copy
-            Dma3CopyLarge16_(sDma3Requests[sDma3RequestCursor].src,
-                             sDma3Requests[sDma3RequestCursor].dest,
-                             sDma3Requests[sDma3RequestCursor].size);
-            break;
-        case DMA_REQUEST_FILL16: // repeat a single 16-bit value across RAM
-            Dma3FillLarge16_(sDma3Requests[sDma3RequestCursor].value,
-                             sDma3Requests[sDma3RequestCursor].dest,
-                             sDma3Requests[sDma3RequestCursor].size);
-            break;
+            ranges->start[region] = address;
+            ranges->end[region] = address + size;
         }
+        else
+        {
+            if (ranges->start[region] > address)
+                ranges->start[region] = address;
+            if (ranges->end[region] < address + size)
+                ranges->end[region] = address + size;
+        }
+    }
+}
 
-        // Free the request
-        sDma3Requests[sDma3RequestCursor].src = NULL;
-        sDma3Requests[sDma3RequestCursor].dest = NULL;
-        sDma3Requests[sDma3RequestCursor].size = 0;
-        sDma3Requests[sDma3RequestCursor].mode = 0;
-        sDma3Requests[sDma3RequestCursor].value = 0;
-        sDma3RequestCursor++;
+static bool32 OverlapsDma3Ranges(const struct Dma3Ranges *ranges, const u8 *address, u32 size)
+{
+    u32 first = DMA_REGION(address);
+    u32 last = DMA_REGION(address + size - 1);
 
-        if (sDma3RequestCursor >= MAX_DMA_REQUESTS) // loop back to the first DMA request
-            sDma3RequestCursor = 0;
-    }
+    return RangesOverlap(ranges->start[first], ranges->end[first] - ranges->start[first], address, size)
+        || RangesOverlap(ranges->start[last], ranges->end[last] - ranges->start[last], address, size);
 }
 
-s16 RequestDma3Copy(const void *src, void *dest, u16 size, u32 mode)
+// Whether 'request' can be done before the requests that were made before it
+// but are still pending, whose memory is in 'written' and 'read'.
+static bool32 CanDoDma3RequestEarly(const struct Dma3Request *request, const struct Dma3Ranges *written, const struct Dma3Ranges *read)
 {
-    int cursor;
-    int i = 0;
+    if (OverlapsDma3Ranges(written, request->dest, request->size))
+        return FALSE;
+    if (OverlapsDma3Ranges(read, request->dest, request->size))
+        return FALSE;
+    if (!IsFillRequest(request) && OverlapsDma3Ranges(written, request->src, request->size))
+        return FALSE;
+    return TRUE;
+}
 
-    sDma3ManagerLocked = TRUE;
-    cursor = sDma3RequestCursor;
+// Starts as many requests as are estimated to fit in 'budget' cycles, high
+// priority ones first, and returns the estimated cycles they take.
+static u32 StartDma3Requests(u32 budget)
+{
+    u32 cycles, cost, pass, i;
+    struct Dma3Request *request;
+    struct Dma3Ranges written, read;
 
-    while (i < MAX_DMA_REQUESTS)
+    memset(&written, 0, sizeof(written));
+    memset(&read, 0, sizeof(read));
+    cycles = 0;
+
+    // The first pass only does the high priority requests, and the second
+    // does the rest in the order they were made. Both stop at the first
+    // request which doesn't fit, so that conflicting requests stay in order.
+    for (pass = DMA_PRIORITY_HIGH; pass <= DMA_PRIORITY_NORMAL; pass++)
     {
-        if (sDma3Requests[cursor].size == 0) // an empty request was found.
+        for (i = 0; i < sDma3QueueLength; i++)
         {
-            sDma3Requests[cursor].src = src;
-            sDma3Requests[cursor].dest = dest;
-            sDma3Requests[cursor].size = size;
+            request = &sDma3Requests[sDma3Queue[i]];
 
-            if (mode == 1)
-                sDma3Requests[cursor].mode = DMA_REQUEST_COPY32;
-            else
-                sDma3Requests[cursor].mode = DMA_REQUEST_COPY16;
+            if (request->size == 0)
+                continue;
+            if (pass == DMA_PRIORITY_HIGH
+             && (request->priority != DMA_PRIORITY_HIGH || !CanDoDma3RequestEarly(request, &written, &read)))
+            {
+                // Later requests can't jump ahead of this one either.
+                AddDma3Range(&written, request->dest, request->size);
+                if (!IsFillRequest(request))
+                    AddDma3Range(&read, request->src, request->size);
+                continue;
+            }
 
-            sDma3ManagerLocked = FALSE;
-            return cursor;
+            // At least one request is done each frame, however big it is.
+            cost = EstimateDma3RequestCycles(request);
+            if (!IsDma3WindowOpen(*(u8 *)REG_ADDR_VCOUNT)
+             || (sDma3Stats.requestsMoved != 0 && cycles + cost > budget))
+                break;
+
+            DoDma3Request(request);
+            cycles += cost;
+            sDma3Stats.bytesMoved += request->size;
+            sDma3Stats.requestsMoved++;
+
+            // Free the request
+            request->src = NULL;
+            request->dest = NULL;
+            request->size = 0;
+            request->mode = 0;
+            request->value = 0;
         }
-        if (++cursor >= MAX_DMA_REQUESTS) // loop back to start.
-            cursor = 0;
-        i++;
     }
-    sDma3ManagerLocked = FALSE;
-    return -1;  // no free DMA request was found
+
+    return cycles;
 }
 
-s16 RequestDma3Fill(s32 value, void *dest, u16 size, u32 mode)
+// Starts as many requests as are estimated to fit in what is left of
+// VBlank. The rest are left for the next frame.
+void ProcessDma3Requests(void)
+{
+    u32 vcount, cycles, i, length;
+    struct Dma3Request *request;
+
+    if (sDma3ManagerLocked)
+        return;
+
+    sDma3Stats.bytesMoved = 0;
+    sDma3Stats.bytesDeferred = 0;
+    sDma3Stats.requestsMoved = 0;
+    sDma3Stats.requestsDeferred = 0;
+
+    vcount = *(u8 *)REG_ADDR_VCOUNT;
+    if (IsDma3WindowOpen(vcount))
+        cycles = StartDma3Requests((LAST_DMA_SCANLINE + 1 - vcount) * CYCLES_PER_SCANLINE);
+    else
+        cycles = 0;
+
+    // Drop the requests which were done from the queue.
+    length = 0;
+    for (i = 0; i < sDma3QueueLength; i++)
+    {
+        request = &sDma3Requests[sDma3Queue[i]];
+        if (request->size != 0)
+        {
+            sDma3Stats.bytesDeferred += request->size;
+            sDma3Stats.requestsDeferred++;
+            sDma3Queue[length++] = sDma3Queue[i];
+        }
+    }
+    sDma3QueueLength = length;
+    sDma3Stats.estimatedCycles = cycles;
+    sDma3Stats.requestsMerged = sDma3RequestsMerged;
+    sDma3RequestsMerged = 0;
+}
+
+// Returns the index of a pending request which 'request' can be merged
+// into, or -1. A request can be merged if it repeats a pending request, or
+// continues the last one.
+static s32 FindMergeableDma3Request(const struct Dma3Request *request)
+{
+    s32 i;
+
+    for (i = sDma3QueueLength - 1; i >= 0; i--)
+    {
+        const struct Dma3Request *pending = &sDma3Requests[sDma3Queue[i]];
+
+        if (pending->mode == request->mode
+         && pending->value == request->value
+         && pending->dest == request->dest
+         && pending->size == request->size
+         && (IsFillRequest(request) || pending->src == request->src))
+            return sDma3Queue[i];
+
+        if (i == sDma3QueueLength - 1
+         && pending->mode == request->mode
+         && pending->value == request->value
+         && pending->dest + pending->size == request->dest
+         && (IsFillRequest(request) || pending->src + pending->size == request->src)
+         && pending->size + request->size <= UINT16_MAX)
+            return sDma3Queue[i];
+
+        if (RequestsConflict(pending, request))
+            break;
+    }
+
+    return -1;
+}
+
+static s16 AddDma3Request(const struct Dma3Request *request)
 {
     int cursor;
     int i = 0;
+    s32 merged;
 
-    cursor = sDma3RequestCursor;
     sDma3ManagerLocked = TRUE;
 
+    merged = request->size != 0 ? FindMergeableDma3Request(request) : -1;
+    if (merged != -1)
+    {
+        // A repeated request is already the same size.
+        if (sDma3Requests[merged].dest != request->dest)
+            sDma3Requests[merged].size += request->size;
+        sDma3RequestsMerged++;
+        sDma3ManagerLocked = FALSE;
+        return merged;
+    }
+
+    cursor = sDma3RequestCursor;
+
     while (i < MAX_DMA_REQUESTS)
     {
         if (sDma3Requests[cursor].size == 0) // an empty request was found.
         {
-            sDma3Requests[cursor].dest = dest;
-            sDma3Requests[cursor].size = size;
-            sDma3Requests[cursor].mode = mode;
-            sDma3Requests[cursor].value = value;
+            sDma3Requests[cursor] = *request;
+            sDma3Requests[cursor].priority = GetDma3RequestPriority(request->dest);
+            if (request->size != 0)
+                sDma3Queue[sDma3QueueLength++] = cursor;
 
-            if(mode == 1)
-                sDma3Requests[cursor].mode = DMA_REQUEST_FILL32;
-            else
-                sDma3Requests[cursor].mode = DMA_REQUEST_FILL16;
+            // Start looking for the next empty request after this one, so
+            // that a finished request's index isn't reused straight away.
+            sDma3RequestCursor = cursor + 1;
+            if (sDma3RequestCursor >= MAX_DMA_REQUESTS)
+                sDma3RequestCursor = 0;
 
             sDma3ManagerLocked = FALSE;
             return cursor;
@@ -160,6 +391,40 @@ s16 RequestDma3Fill(s32 value, void *dest, u16 size, u32 mode)
     return -1;  // no free DMA request was found
 }
 
+s16 RequestDma3Copy(const void *src, void *dest, u16 size, u32 mode)
+{
+    struct Dma3Request request;
+
+    request.src = src;
+    request.dest = dest;
+    request.size = size;
+    request.value = 0;
+
+    if (mode == 1)
+        request.mode = DMA_REQUEST_COPY32;
+    else
+        request.mode = DMA_REQUEST_COPY16;
+
+    return AddDma3Request(&request);
+}
+
+s16 RequestDma3Fill(s32 value, void *dest, u16 size, u32 mode)
+{
+    struct Dma3Request request;
+
+    request.src = NULL;
+    request.dest = dest;
+    request.size = size;
+    request.value = value;
+
+    if (mode == 1)
+        request.mode = DMA_REQUEST_FILL32;
+    else
+        request.mode = DMA_REQUEST_FILL16;
+
+    return AddDma3Request(&request);
+}
+
 s16 CheckForSpaceForDma3Request(s16 index)
 {
     int i = 0;
@@ -181,3 +446,8 @@ s16 CheckForSpaceForDma3Request(s16 index)
         return 0;
     }
 }
+
+void GetDma3Stats(struct Dma3Stats *stats)
+{
+    *stats = sDma3Stats;
+}
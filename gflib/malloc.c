@@ -4,8 +4,30 @@
 #include "test/test.h"
 #endif
 
+// Free blocks which are big enough to hold a FreeMemBlockLinks in their
+// data are also kept in one of FREE_LIST_COUNT lists by size, so that
+// allocating only looks at free blocks which might fit instead of walking
+// every block in the heap. Smaller free blocks are only reused once they
+// are merged with a neighbour. The lists belong to the heap set up by
+// InitHeap.
+#define FREE_LIST_COUNT 8
+
+struct FreeMemBlockLinks
+{
+    struct MemBlock *prev;
+    struct MemBlock *next;
+};
+
+#define FREE_LINKS(block) ((struct FreeMemBlockLinks *)(block)->data)
+
+static const u32 sFreeListMaxSizes[FREE_LIST_COUNT - 1] = { 16, 32, 64, 128, 256, 1024, 4096 };
+
 static void *sHeapStart;
 static u32 sHeapSize;
+EWRAM_DATA static struct MemBlock *sFreeLists[FREE_LIST_COUNT] = {0};
+EWRAM_DATA static u32 sAllocatedBytes = 0;
+EWRAM_DATA static u32 sPeakAllocatedBytes = 0;
+EWRAM_DATA static u16 sAllocatedBlocks = 0;
 
 ALIGNED(4) EWRAM_DATA u8 gHeap[HEAP_SIZE] = {0};
 
@@ -27,85 +49,139 @@ void PutFirstMemBlockHeader(void *block, u32 size)
     PutMemBlockHeader(block, (struct MemBlock *)block, (struct MemBlock *)block, size - sizeof(struct MemBlock));
 }
 
+static u32 FreeListIndex(u32 size)
+{
+    u32 i;
+
+    for (i = 0; i < FREE_LIST_COUNT - 1; i++)
+    {
+        if (size <= sFreeListMaxSizes[i])
+            return i;
+    }
+
+    return FREE_LIST_COUNT - 1;
+}
+
+static void AddToFreeList(struct MemBlock *block)
+{
+    u32 i;
+
+    if (block->size < sizeof(struct FreeMemBlockLinks))
+        return;
+
+    i = FreeListIndex(block->size);
+    FREE_LINKS(block)->prev = NULL;
+    FREE_LINKS(block)->next = sFreeLists[i];
+    if (sFreeLists[i] != NULL)
+        FREE_LINKS(sFreeLists[i])->prev = block;
+    sFreeLists[i] = block;
+}
+
+static void RemoveFromFreeList(struct MemBlock *block)
+{
+    struct FreeMemBlockLinks *links = FREE_LINKS(block);
+
+    if (block->size < sizeof(struct FreeMemBlockLinks))
+        return;
+
+    if (links->prev != NULL)
+        FREE_LINKS(links->prev)->next = links->next;
+    else
+        sFreeLists[FreeListIndex(block->size)] = links->next;
+
+    if (links->next != NULL)
+        FREE_LINKS(links->next)->prev = links->prev;
+}
+
 void *AllocInternal(void *heapStart, u32 size, const char *location)
 {
-    struct MemBlock *pos = (struct MemBlock *)heapStart;
-    struct MemBlock *head = pos;
+    struct MemBlock *head = (struct MemBlock *)heapStart;
+    struct MemBlock *pos;
+    struct MemBlock *block;
     struct MemBlock *splitBlock;
     u32 foundBlockSize;
+    u32 i;
 
     // Alignment
     if (size & 3)
         size = 4 * ((size / 4) + 1);
 
-    for (;;)
+    // Every block in the lists after the size's own list is big enough.
+    // The smallest block that fits is used, so that larger blocks are kept
+    // whole for larger allocations.
+    for (i = FreeListIndex(size); i < FREE_LIST_COUNT; i++)
     {
-        // Loop through the blocks looking for unused block that's big enough.
+        pos = NULL;
+        for (block = sFreeLists[i]; block != NULL; block = FREE_LINKS(block)->next)
+        {
+            if (block->size >= size
+             && (pos == NULL || block->size < pos->size || (block->size == pos->size && block < pos)))
+                pos = block;
+        }
 
-        if (!pos->allocated)
+        if (pos != NULL)
         {
             foundBlockSize = pos->size;
+            RemoveFromFreeList(pos);
 
-            if (foundBlockSize >= size)
+            if (foundBlockSize - size < 2 * sizeof(struct MemBlock))
             {
-                if (foundBlockSize - size < 2 * sizeof(struct MemBlock))
-                {
-                    // The block isn't much bigger than the requested size,
-                    // so just use it.
-                    pos->allocated = TRUE;
-                }
-                else
-                {
-                    // The block is significantly bigger than the requested
-                    // size, so split the rest into a separate block.
-                    foundBlockSize -= sizeof(struct MemBlock);
-                    foundBlockSize -= size;
-
-                    splitBlock = (struct MemBlock *)(pos->data + size);
+                // The block isn't much bigger than the requested size,
+                // so just use it.
+                pos->allocated = TRUE;
+            }
+            else
+            {
+                // The block is significantly bigger than the requested
+                // size, so split the rest into a separate block.
+                foundBlockSize -= sizeof(struct MemBlock);
+                foundBlockSize -= size;
 
-                    pos->allocated = TRUE;
-                    pos->size = size;
+                splitBlock = (struct MemBlock *)(pos->data + size);
 
-                    PutMemBlockHeader(splitBlock, pos, pos->next, foundBlockSize);
+                pos->allocated = TRUE;
+                pos->size = size;
 
-                    pos->next = splitBlock;
+                PutMemBlockHeader(splitBlock, pos, pos->next, foundBlockSize);
 
-                    if (splitBlock->next != head)
-                        splitBlock->next->prev = splitBlock;
-                }
+                pos->next = splitBlock;
 
-                pos->locationHi = ((uintptr_t)location) >> 14;
-                pos->locationLo = (uintptr_t)location;
+                if (splitBlock->next != head)
+                    splitBlock->next->prev = splitBlock;
 
-                return pos->data;
+                AddToFreeList(splitBlock);
             }
+
+            pos->locationHi = ((uintptr_t)location) >> 14;
+            pos->locationLo = (uintptr_t)location;
+
+            sAllocatedBytes += pos->size;
+            sAllocatedBlocks++;
+            if (sPeakAllocatedBytes < sAllocatedBytes)
+                sPeakAllocatedBytes = sAllocatedBytes;
+
+            return pos->data;
         }
+    }
 
-        if (pos->next == head)
-        {
 #if TESTING
-            const struct MemBlock *head = HeapHead();
-            const struct MemBlock *block = head;
-            do
-            {
-                if (block->allocated)
-                {
-                    const char *location = MemBlockLocation(block);
-                    if (location)
-                        MgbaPrintf_("%s: %d bytes allocated", location, block->size);
-                    else
-                        MgbaPrintf_("<unknown>: %d bytes allocated", block->size);
-                }
-                block = block->next;
-            }
-            while (block != head);
-            Test_ExitWithResult(TEST_RESULT_ERROR, "%s: OOM allocating %d bytes", location, size);
-#endif
-            return NULL;
+    block = head;
+    do
+    {
+        if (block->allocated)
+        {
+            const char *location = MemBlockLocation(block);
+            if (location)
+                MgbaPrintf_("%s: %d bytes allocated", location, block->size);
+            else
+                MgbaPrintf_("<unknown>: %d bytes allocated", block->size);
         }
-
-        pos = pos->next;
+        block = block->next;
     }
+    while (block != head);
+    Test_ExitWithResult(TEST_RESULT_ERROR, "%s: OOM allocating %d bytes", location, size);
+#endif
+    return NULL;
 }
 
 void FreeInternal(void *heapStart, void *pointer)
@@ -114,7 +190,22 @@ void FreeInternal(void *heapStart, void *pointer)
     {
         struct MemBlock *head = (struct MemBlock *)heapStart;
         struct MemBlock *block = (struct MemBlock *)((u8 *)pointer - sizeof(struct MemBlock));
+
+        // Freeing a block twice would list it twice.
+        if (!block->allocated)
+        {
+        #if TESTING
+            const char *location = MemBlockLocation(block);
+            Test_ExitWithResult(TEST_RESULT_ERROR, "%s: double free of %d bytes", location ? location : "<unknown>", block->size);
+        #else
+            AGB_ASSERT(FALSE);
+        #endif // TESTING
+            return;
+        }
+
         block->allocated = FALSE;
+        sAllocatedBytes -= block->size;
+        sAllocatedBlocks--;
 
         // If the freed block isn't the last one, merge with the next block
         // if it's not in use.
@@ -122,6 +213,7 @@ void FreeInternal(void *heapStart, void *pointer)
         {
             if (!block->next->allocated)
             {
+                RemoveFromFreeList(block->next);
                 block->size += sizeof(struct MemBlock) + block->next->size;
                 block->next->magic = 0;
                 block->next = block->next->next;
@@ -136,6 +228,7 @@ void FreeInternal(void *heapStart, void *pointer)
         {
             if (!block->prev->allocated)
             {
+                RemoveFromFreeList(block->prev);
                 block->prev->next = block->next;
 
                 if (block->next != head)
@@ -143,8 +236,11 @@ void FreeInternal(void *heapStart, void *pointer)
 
                 block->magic = 0;
                 block->prev->size += sizeof(struct MemBlock) + block->size;
+                block = block->prev;
             }
         }
+
+        AddToFreeList(block);
     }
 }
 
@@ -191,9 +287,49 @@ bool32 CheckMemBlockInternal(void *heapStart, void *pointer)
 
 void InitHeap(void *heapStart, u32 heapSize)
 {
+    u32 i;
+
     sHeapStart = heapStart;
     sHeapSize = heapSize;
     PutFirstMemBlockHeader(heapStart, heapSize);
+
+    for (i = 0; i < FREE_LIST_COUNT; i++)
+        sFreeLists[i] = NULL;
+    AddToFreeList((struct MemBlock *)heapStart);
+
+    sAllocatedBytes = 0;
+    sPeakAllocatedBytes = 0;
+    sAllocatedBlocks = 0;
+}
+
+// Rebuilds the free lists and the usage counts from the blocks, after
+// the block headers have been written directly rather than by Alloc and
+// Free.
+void RebuildHeapFreeLists(void)
+{
+    struct MemBlock *pos = (struct MemBlock *)sHeapStart;
+    u32 i;
+
+    for (i = 0; i < FREE_LIST_COUNT; i++)
+        sFreeLists[i] = NULL;
+    sAllocatedBytes = 0;
+    sAllocatedBlocks = 0;
+
+    do {
+        if (pos->allocated)
+        {
+            sAllocatedBytes += pos->size;
+            sAllocatedBlocks++;
+        }
+        else
+        {
+            AddToFreeList(pos);
+        }
+        pos = pos->next;
+    } while (pos != (struct MemBlock *)sHeapStart);
+
+    if (sPeakAllocatedBytes < sAllocatedBytes)
+        sPeakAllocatedBytes = sAllocatedBytes;
 }
 
 void *Alloc_(u32 size, const char *location)
@@ -219,14 +355,60 @@ bool32 CheckMemBlock(void *pointer)
 bool32 CheckHeap()
 {
     struct MemBlock *pos = (struct MemBlock *)sHeapStart;
+    u32 i;
+    u32 listedBlocks = 0;
 
     do {
         if (!CheckMemBlockInternal(sHeapStart, pos->data))
             return FALSE;
+        if (!pos->allocated && pos->size >= sizeof(struct FreeMemBlockLinks))
+            listedBlocks++;
         pos = pos->next;
     } while (pos != (struct MemBlock *)sHeapStart);
 
-    return TRUE;
+    // Every free block that can be listed must be, in the right list.
+    for (i = 0; i < FREE_LIST_COUNT; i++)
+    {
+        for (pos = sFreeLists[i]; pos != NULL; pos = FREE_LINKS(pos)->next)
+        {
+            if (pos->magic != MALLOC_SYSTEM_ID || pos->allocated || FreeListIndex(pos->size) != i || listedBlocks == 0)
+                return FALSE;
+            listedBlocks--;
+        }
+    }
+
+    return listedBlocks == 0;
+}
+
+void GetHeapStats(struct HeapStats *stats)
+{
+    const struct MemBlock *pos = (const struct MemBlock *)sHeapStart;
+
+    stats->allocatedBytes = sAllocatedBytes;
+    stats->peakAllocatedBytes = sPeakAllocatedBytes;
+    stats->allocatedBlocks = sAllocatedBlocks;
+    stats->freeBytes = 0;
+    stats->largestFreeBlock = 0;
+    stats->freeBlocks = 0;
+
+    if (pos == NULL)
+        return;
+
+    do {
+        if (!pos->allocated)
+        {
+            stats->freeBytes += pos->size;
+            stats->freeBlocks++;
+            if (stats->largestFreeBlock < pos->size)
+                stats->largestFreeBlock = pos->size;
+        }
+        pos = pos->next;
+    } while (pos != (const struct MemBlock *)sHeapStart);
+}
+
+void ResetHeapStatsPeak(void)
+{
+    sPeakAllocatedBytes = sAllocatedBytes;
 }
 
 const struct MemBlock *HeapHead(void)
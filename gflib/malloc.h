@@ -41,6 +41,18 @@ struct MemBlock
     u8 data[0];
 };
 
+// How much of the heap is in use. Fragmentation shows as a largest free
+// block which is much smaller than the free bytes.
+struct HeapStats
+{
+    u32 allocatedBytes;
+    u32 peakAllocatedBytes; // Since InitHeap or ResetHeapStatsPeak.
+    u32 freeBytes;
+    u32 largestFreeBlock;
+    u16 allocatedBlocks;
+    u16 freeBlocks;
+};
+
 #define HEAP_SIZE 0x1C000
 extern u8 gHeap[HEAP_SIZE];
 
@@ -60,6 +72,10 @@ void *Alloc_(u32 size, const char *location);
 void *AllocZeroed_(u32 size, const char *location);
 void Free(void *pointer);
 void InitHeap(void *pointer, u32 size);
+bool32 CheckHeap(void);
+void GetHeapStats(struct HeapStats *stats);
+void ResetHeapStatsPeak(void);
+void RebuildHeapFreeLists(void);
 
 const struct MemBlock *HeapHead(void);
 const char *MemBlockLocation(const struct MemBlock *block);
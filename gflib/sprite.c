@@ -16,17 +16,10 @@
     (sSpriteTileRanges + 1)[index * 2] = count;    \
 }
 
-#define ALLOC_SPRITE_TILE(n)                             \
-{                                                        \
-    sSpriteTileAllocBitmap[(n) / 8] |= (1 << ((n) % 8)); \
-}
-
-#define FREE_SPRITE_TILE(n)                               \
-{                                                         \
-    sSpriteTileAllocBitmap[(n) / 8] &= ~(1 << ((n) % 8)); \
-}
-
-#define SPRITE_TILE_IS_ALLOCATED(n) ((sSpriteTileAllocBitmap[(n) / 8] >> ((n) % 8)) & 1)
+// Sheets smaller than this many tiles are placed at the end of a hole
+// between other sheets instead of its start, so that what is left of the
+// hole stays next to the free tiles beyond it rather than being split off.
+#define SMALL_SPRITE_SHEET_TILES 16
 
 
 struct SpriteCopyRequest
@@ -52,6 +45,8 @@ static void SortSprites(u32 *spritePriorities, s32 n);
 static u32 CreateSpriteAt(u32 index, const struct SpriteTemplate *template, s16 x, s16 y, u32 subpriority);
 static void ResetOamMatrices(void);
 static void ResetSprite(struct Sprite *sprite);
+static u32 FindSpriteTile(u32 tile, bool32 allocated);
+static void SetSpriteTilesAllocated(u32 start, u32 count, bool32 allocated);
 static s16 AllocSpriteTiles(u16 tileCount);
 static void RequestSpriteFrameImageCopy(u16 index, u16 tileNum, const struct SpriteFrameImage *images);
 static void ResetAllSprites(void);
@@ -272,7 +267,8 @@ EWRAM_DATA static struct SpriteCopyRequest sSpriteCopyRequests[MAX_SPRITES] = {0
 EWRAM_DATA u8 gOamLimit = 0;
 static EWRAM_DATA u8 sOamDummyIndex = 0;
 EWRAM_DATA u16 gReservedSpriteTileCount = 0;
-EWRAM_DATA static u8 sSpriteTileAllocBitmap[128] = {0};
+EWRAM_DATA static u32 sSpriteTileAllocBitmap[TOTAL_OBJ_TILE_COUNT / 32] = {0};
+EWRAM_DATA static u16 sSpriteTileAllocFailures = 0;
 EWRAM_DATA s16 gSpriteCoordOffsetX = 0;
 EWRAM_DATA s16 gSpriteCoordOffsetY = 0;
 EWRAM_DATA struct OamMatrix gOamMatrices[OAM_MATRIX_COUNT] = {0};
@@ -289,6 +285,7 @@ void ResetSpriteData(void)
     gOamLimit = 64;
     gReservedSpriteTileCount = 0;
     AllocSpriteTiles(0);
+    sSpriteTileAllocFailures = 0;
     gSpriteCoordOffsetX = 0;
     gSpriteCoordOffsetY = 0;
 }
@@ -557,12 +554,7 @@ void DestroySprite(struct Sprite *sprite)
     if (sprite->inUse)
     {
         if (!sprite->usingSheet)
-        {
-            u16 i;
-            u16 tileEnd = (sprite->images->size / TILE_SIZE_4BPP) + sprite->oam.tileNum;
-            for (i = sprite->oam.tileNum; i < tileEnd; i++)
-                FREE_SPRITE_TILE(i);
-        }
+            SetSpriteTilesAllocated(sprite->oam.tileNum, sprite->images->size / TILE_SIZE_4BPP, FALSE);
         ResetSprite(sprite);
     }
 }
@@ -636,83 +628,134 @@ void CalcCenterToCornerVec(struct Sprite *sprite, u8 shape, u8 size, u8 affineMo
     sprite->centerToCornerVecY = y;
 }
 
+static u32 LowestSetBit(u32 value)
+{
+    static const u8 sDeBruijnBitPositions[32] =
+    {
+         0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+        31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9,
+    };
+
+    return sDeBruijnBitPositions[((value & -value) * 0x077CB531) >> 27];
+}
+
+// Returns the first tile from 'tile' onwards which is allocated, or free
+// if 'allocated' is FALSE, or TOTAL_OBJ_TILE_COUNT if there isn't one.
+// The bitmap is searched a word at a time.
+static u32 FindSpriteTile(u32 tile, bool32 allocated)
+{
+    while (tile < TOTAL_OBJ_TILE_COUNT)
+    {
+        u32 bits = sSpriteTileAllocBitmap[tile / 32];
+
+        if (!allocated)
+            bits = ~bits;
+        bits &= 0xFFFFFFFF << (tile % 32);
+
+        if (bits != 0)
+            return (tile & ~31) + LowestSetBit(bits);
+
+        tile = (tile | 31) + 1;
+    }
+
+    return TOTAL_OBJ_TILE_COUNT;
+}
+
+static void SetSpriteTilesAllocated(u32 start, u32 count, bool32 allocated)
+{
+    u32 end = start + count;
+
+    while (start < end)
+    {
+        u32 bits = 0xFFFFFFFF << (start % 32);
+
+        if (end - (start & ~31) < 32)
+            bits &= (1u << (end % 32)) - 1;
+
+        if (allocated)
+            sSpriteTileAllocBitmap[start / 32] |= bits;
+        else
+            sSpriteTileAllocBitmap[start / 32] &= ~bits;
+
+        start = (start | 31) + 1;
+    }
+}
+
+// Allocates the tiles from the smallest hole they fit in, which keeps
+// larger holes free for larger sheets.
 s16 AllocSpriteTiles(u16 tileCount)
 {
-    u16 i;
-    s16 start;
-    u16 numTilesFound;
+    u32 start, end;
+    u32 bestStart = 0;
+    u32 bestCount = TOTAL_OBJ_TILE_COUNT + 1;
 
     if (tileCount == 0)
     {
         // Free all unreserved tiles if the tile count is 0.
-        for (i = gReservedSpriteTileCount; i < TOTAL_OBJ_TILE_COUNT; i++)
-            FREE_SPRITE_TILE(i);
-
+        SetSpriteTilesAllocated(gReservedSpriteTileCount, TOTAL_OBJ_TILE_COUNT - gReservedSpriteTileCount, FALSE);
         return 0;
     }
 
-    i = gReservedSpriteTileCount;
-
-    for (;;)
+    for (start = FindSpriteTile(gReservedSpriteTileCount, FALSE); start < TOTAL_OBJ_TILE_COUNT; start = FindSpriteTile(end, FALSE))
     {
-        while (SPRITE_TILE_IS_ALLOCATED(i))
+        end = FindSpriteTile(start, TRUE);
+
+        if (end - start >= tileCount && end - start < bestCount)
         {
-            i++;
+            bestStart = start;
+            bestCount = end - start;
 
-            if (i == TOTAL_OBJ_TILE_COUNT)
-                return -1;
+            if (bestCount == tileCount)
+                break;
         }
+    }
 
-        start = i;
-        numTilesFound = 1;
+    if (bestCount > TOTAL_OBJ_TILE_COUNT)
+    {
+        sSpriteTileAllocFailures++;
+        return -1;
+    }
 
-        while (numTilesFound != tileCount)
-        {
-            i++;
+    if (tileCount < SMALL_SPRITE_SHEET_TILES && bestStart + bestCount < TOTAL_OBJ_TILE_COUNT)
+        bestStart += bestCount - tileCount;
 
-            if (i == TOTAL_OBJ_TILE_COUNT)
-                return -1;
+    SetSpriteTilesAllocated(bestStart, tileCount, TRUE);
 
-            if (!SPRITE_TILE_IS_ALLOCATED(i))
-                numTilesFound++;
-            else
-                break;
-        }
+    return bestStart;
+}
 
-        if (numTilesFound == tileCount)
-            break;
-    }
+void GetSpriteTileAllocStats(struct SpriteTileAllocStats *stats)
+{
+    u32 start, end;
 
-    for (i = start; i < tileCount + start; i++)
-        ALLOC_SPRITE_TILE(i);
+    stats->freeTiles = 0;
+    stats->freeHoles = 0;
+    stats->largestHole = 0;
+    stats->failures = sSpriteTileAllocFailures;
 
-    return start;
+    for (start = FindSpriteTile(gReservedSpriteTileCount, FALSE); start < TOTAL_OBJ_TILE_COUNT; start = FindSpriteTile(end, FALSE))
+    {
+        end = FindSpriteTile(start, TRUE);
+        stats->freeTiles += end - start;
+        stats->freeHoles++;
+        if (stats->largestHole < end - start)
+            stats->largestHole = end - start;
+    }
 }
 
 u8 SpriteTileAllocBitmapOp(u16 bit, u8 op)
 {
-    u8 index = bit / 8;
-    u8 shift = bit % 8;
-    u8 val = bit % 8;
-    u8 retVal = 0;
+    u32 index = bit / 32;
+    u32 mask = 1u << (bit % 32);
 
     if (op == 0)
-    {
-        val = ~(1 << val);
-        sSpriteTileAllocBitmap[index] &= val;
-    }
+        sSpriteTileAllocBitmap[index] &= ~mask;
     else if (op == 1)
-    {
-        val = (1 << val);
-        sSpriteTileAllocBitmap[index] |= val;
-    }
+        sSpriteTileAllocBitmap[index] |= mask;
     else
-    {
-        retVal = 1 << shift;
-        retVal &= sSpriteTileAllocBitmap[index];
-    }
+        return (sSpriteTileAllocBitmap[index] & mask) != 0;
 
-    return retVal;
+    return 0;
 }
 
 void SpriteCallbackDummy(struct Sprite *sprite)
@@ -1452,7 +1495,6 @@ void FreeSpriteTilesByTag(u16 tag)
     u8 index = IndexOfSpriteTileTag(tag);
     if (index != 0xFF)
     {
-        u16 i;
         u16 *rangeStarts;
         u16 *rangeCounts;
         u16 start;
@@ -1462,8 +1504,7 @@ void FreeSpriteTilesByTag(u16 tag)
         rangeCounts = sSpriteTileRanges + 1;
         count = rangeCounts[index * 2];
 
-        for (i = start; i < start + count; i++)
-            FREE_SPRITE_TILE(i);
+        SetSpriteTilesAllocated(start, count, FALSE);
 
         sSpriteTileRangeTags[index] = TAG_NONE;
     }
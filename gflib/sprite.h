@@ -250,6 +250,18 @@ struct OamMatrix
     s16 d;
 };
 
+// Describes how fragmented the unreserved OBJ tiles are. A sheet can only
+// be loaded if it fits in a single hole, so when 'largestHole' is much
+// smaller than 'freeTiles' large sheets can fail to load even though
+// there are enough free tiles.
+struct SpriteTileAllocStats
+{
+    u16 freeTiles;
+    u16 freeHoles;
+    u16 largestHole;
+    u16 failures; // Allocations which have failed since ResetSpriteData.
+};
+
 extern const struct OamData gDummyOamData;
 extern const union AnimCmd *const gDummySpriteAnimTable[];
 extern const union AffineAnimCmd *const gDummySpriteAffineAnimTable[];
@@ -322,6 +334,7 @@ bool8 AddSubspritesToOamBuffer(struct Sprite *sprite, struct OamData *destOam, u
 void CopyToSprites(u8 *src);
 void CopyFromSprites(u8 *dest);
 u8 SpriteTileAllocBitmapOp(u16 bit, u8 op);
+void GetSpriteTileAllocStats(struct SpriteTileAllocStats *stats);
 void ClearSpriteCopyRequests(void);
 void ResetAffineAnimData(void);
 
@@ -1,6 +1,7 @@
 #include "global.h"
 #include "battle.h"
 #include "main.h"
+#include "malloc.h"
 #include "m4a.h"
 #include "palette.h"
 #include "sound.h"
@@ -12,6 +13,7 @@
 #include "menu.h"
 #include "dynamic_placeholder_text_util.h"
 #include "fonts.h"
+#include "test_runner.h"
 
 static u16 RenderText(struct TextPrinter *);
 static u32 RenderFont(struct TextPrinter *);
@@ -34,10 +36,37 @@ static u32 GetGlyphWidth_Normal(u16, bool32);
 static u32 GetGlyphWidth_Short(u16, bool32);
 static u32 GetGlyphWidth_Narrow(u16, bool32);
 static u32 GetGlyphWidth_SmallNarrow(u16, bool32);
+static bool32 LoadCachedGlyph(u32 fontId, u32 glyphId, bool32 isJapanese);
+static void CacheCurrentGlyph(u32 fontId, u32 glyphId, bool32 isJapanese);
 
 static EWRAM_DATA struct TextPrinter sTempTextPrinter = {0};
 static EWRAM_DATA struct TextPrinter sTextPrinters[WINDOWS_MAX] = {0};
 
+// Decompressed glyphs are cached by font, glyph and colors, since menus
+// redraw the same strings over and over. The cache is set associative,
+// with the least recently used glyph in a set replaced on a miss. It holds
+// 64 glyphs (9 KiB), which fits a page of a bag pocket list with room to
+// spare. Screens which redraw many more distinct glyphs or colors at once
+// cycle through their sets and mostly miss; static text on them should use
+// PrerenderText instead.
+#define GLYPH_CACHE_SETS 16
+#define GLYPH_CACHE_WAYS 4
+
+struct CachedGlyph
+{
+    struct TextGlyph glyph;
+    u16 glyphId;
+    u8 fontId;
+    bool8 isJapanese;
+    u16 colors;
+    bool16 valid;
+    u32 lastUsed;
+};
+
+static EWRAM_DATA struct CachedGlyph sGlyphCache[GLYPH_CACHE_SETS][GLYPH_CACHE_WAYS] = {0};
+static EWRAM_DATA u32 sGlyphCacheClock = 0;
+static EWRAM_DATA struct GlyphCacheStats sGlyphCacheStats = {0};
+
 static u16 sFontHalfRowLookupTable[0x51];
 static u16 sLastTextBgColor;
 static u16 sLastTextFgColor;
@@ -337,7 +366,11 @@ bool32 AddTextPrinter(struct TextPrinterTemplate *printerTemplate, u8 speed, voi
     GenerateFontHalfRowLookupTable(printerTemplate->fgColor, printerTemplate->bgColor, printerTemplate->shadowColor);
     if (speed != TEXT_SKIP_DRAW && speed != 0)
     {
-        --sTempTextPrinter.textSpeed;
+        // Headless test runs keep waits and scrolling but drop the per-character delay.
+        if (gTestRunnerHeadless)
+            sTempTextPrinter.textSpeed = 0;
+        else
+            --sTempTextPrinter.textSpeed;
         sTextPrinters[printerTemplate->windowId] = sTempTextPrinter;
     }
     else
@@ -360,9 +393,103 @@ bool32 AddTextPrinter(struct TextPrinterTemplate *printerTemplate, u8 speed, voi
     return TRUE;
 }
 
+// Renders a single line of text into newly allocated tiles. color is
+// { bg, fg, shadow }, as for AddTextPrinterParameterized3. Printing is
+// done through window 0, whose buffer and text printer are swapped out
+// and restored around it.
+bool32 PrerenderText(struct PrerenderedText *text, u8 fontId, const u8 *color, const u8 *str)
+{
+    struct TextPrinterTemplate printerTemplate;
+    struct Window window = gWindows[0];
+    struct TextPrinter textPrinter = sTextPrinters[0];
+    u8 fgColor, bgColor, shadowColor;
+    u32 size;
+
+    text->width = GetStringWidth(fontId, str, GetFontAttribute(fontId, FONTATTR_LETTER_SPACING));
+    text->widthTiles = max(1, (text->width + 7) / 8);
+    text->heightTiles = (GetFontAttribute(fontId, FONTATTR_MAX_LETTER_HEIGHT) + 7) / 8;
+    text->bgColor = color[0];
+    size = text->widthTiles * text->heightTiles * TILE_SIZE_4BPP;
+    text->tiles = Alloc(size);
+    if (text->tiles == NULL)
+        return FALSE;
+    CpuFastFill8(PIXEL_FILL(text->bgColor), text->tiles, size);
+
+    gWindows[0].tileData = text->tiles;
+    gWindows[0].window.width = text->widthTiles;
+    gWindows[0].window.height = text->heightTiles;
+
+    printerTemplate.currentChar = str;
+    printerTemplate.windowId = 0;
+    printerTemplate.fontId = fontId;
+    printerTemplate.x = 0;
+    printerTemplate.y = 0;
+    printerTemplate.currentX = 0;
+    printerTemplate.currentY = 0;
+    printerTemplate.letterSpacing = GetFontAttribute(fontId, FONTATTR_LETTER_SPACING);
+    printerTemplate.lineSpacing = GetFontAttribute(fontId, FONTATTR_LINE_SPACING);
+    printerTemplate.unk = 0;
+    printerTemplate.fgColor = color[1];
+    printerTemplate.bgColor = color[0];
+    printerTemplate.shadowColor = color[2];
+
+    SaveTextColors(&fgColor, &bgColor, &shadowColor);
+    AddTextPrinter(&printerTemplate, TEXT_SKIP_DRAW, NULL);
+    RestoreTextColors(&fgColor, &bgColor, &shadowColor);
+
+    gWindows[0] = window;
+    sTextPrinters[0] = textPrinter;
+    return TRUE;
+}
+
+// Draws prerendered text into a window's buffer. When the text's
+// background is opaque and it is drawn at a tile boundary, whole tiles are
+// copied; otherwise it is blitted like any other bitmap.
+void BlitPrerenderedText(const struct PrerenderedText *text, u8 windowId, u16 x, u16 y)
+{
+    struct Window *window = &gWindows[windowId];
+    u32 fullTiles = text->width / 8;
+    u32 tileX, tileY, i;
+
+    if (text->tiles == NULL)
+        return;
+
+    if (text->bgColor == TEXT_COLOR_TRANSPARENT || (x % 8) != 0 || (y % 8) != 0)
+    {
+        BlitBitmapRectToWindow(windowId, text->tiles, 0, 0, text->widthTiles * 8, text->heightTiles * 8, x, y, text->width, text->heightTiles * 8);
+        return;
+    }
+
+    tileX = x / 8;
+    tileY = y / 8;
+    if (tileX >= window->window.width)
+        return;
+    if (fullTiles > window->window.width - tileX)
+        fullTiles = window->window.width - tileX;
+
+    for (i = 0; i < text->heightTiles && tileY + i < window->window.height; i++)
+    {
+        CpuCopy32(&text->tiles[i * text->widthTiles * TILE_SIZE_4BPP],
+                  &window->tileData[((tileY + i) * window->window.width + tileX) * TILE_SIZE_4BPP],
+                  fullTiles * TILE_SIZE_4BPP);
+    }
+
+    if (fullTiles * 8 < text->width)
+    {
+        BlitBitmapRectToWindow(windowId, text->tiles, fullTiles * 8, 0, text->widthTiles * 8, text->heightTiles * 8,
+                               x + fullTiles * 8, y, text->width - fullTiles * 8, text->heightTiles * 8);
+    }
+}
+
+void FreePrerenderedText(struct PrerenderedText *text)
+{
+    TRY_FREE_AND_SET_NULL(text->tiles);
+}
+
 void RunTextPrinters(void)
 {
     int i;
+    u16 j;
 
     if (!gDisableTextPrinters)
     {
@@ -371,6 +498,20 @@ void RunTextPrinters(void)
             if (sTextPrinters[i].active)
             {
                 u16 renderCmd = RenderFont(&sTextPrinters[i]);
+
+                // Headless test runs print everything up to the next wait in
+                // one frame, and only copy the window once at the end.
+                if (gTestRunnerHeadless)
+                {
+                    for (j = 0; j < 0x400 && renderCmd == RENDER_PRINT; ++j)
+                    {
+                        if (sTextPrinters[i].callback != NULL)
+                            sTextPrinters[i].callback(&sTextPrinters[i].printerTemplate, renderCmd);
+                        renderCmd = RenderFont(&sTextPrinters[i]);
+                    }
+                    if (j != 0 && renderCmd != RENDER_PRINT)
+                        CopyWindowToVram(sTextPrinters[i].printerTemplate.windowId, COPYWIN_GFX);
+                }
                 switch (renderCmd)
                 {
                 case RENDER_PRINT:
@@ -637,6 +778,98 @@ inline static void GLYPH_COPY(u8 *windowTiles, u32 widthOffset, u32 j, u32 i, u3
     }
 }
 
+static inline u32 GetGlyphCacheColors(void)
+{
+    return sLastTextFgColor | (sLastTextBgColor << 4) | (sLastTextShadowColor << 8);
+}
+
+// Only the fonts that RenderText decompresses into gCurGlyph.
+static inline bool32 IsGlyphCacheable(u32 fontId)
+{
+    return fontId != FONT_BRAILLE && fontId <= FONT_SMALL_NARROW;
+}
+
+static inline struct CachedGlyph *GetGlyphCacheSet(u32 fontId, u32 glyphId)
+{
+    return sGlyphCache[(glyphId ^ fontId) % GLYPH_CACHE_SETS];
+}
+
+// Loads the glyph into gCurGlyph if it was decompressed with the current
+// colors before.
+static bool32 LoadCachedGlyph(u32 fontId, u32 glyphId, bool32 isJapanese)
+{
+    u32 i;
+    u32 colors;
+    struct CachedGlyph *set;
+
+    if (!IsGlyphCacheable(fontId))
+        return FALSE;
+
+    colors = GetGlyphCacheColors();
+    set = GetGlyphCacheSet(fontId, glyphId);
+    for (i = 0; i < GLYPH_CACHE_WAYS; i++)
+    {
+        if (set[i].valid
+         && set[i].glyphId == glyphId
+         && set[i].fontId == fontId
+         && set[i].isJapanese == isJapanese
+         && set[i].colors == colors)
+        {
+            set[i].lastUsed = ++sGlyphCacheClock;
+            gCurGlyph = set[i].glyph;
+            sGlyphCacheStats.hits++;
+            return TRUE;
+        }
+    }
+    sGlyphCacheStats.misses++;
+    return FALSE;
+}
+
+static void CacheCurrentGlyph(u32 fontId, u32 glyphId, bool32 isJapanese)
+{
+    u32 i;
+    struct CachedGlyph *set;
+    struct CachedGlyph *entry;
+
+    if (!IsGlyphCacheable(fontId))
+        return;
+
+    set = GetGlyphCacheSet(fontId, glyphId);
+    entry = &set[0];
+    for (i = 0; i < GLYPH_CACHE_WAYS; i++)
+    {
+        if (!set[i].valid)
+        {
+            entry = &set[i];
+            break;
+        }
+        if (set[i].lastUsed < entry->lastUsed)
+            entry = &set[i];
+    }
+
+    if (entry->valid)
+        sGlyphCacheStats.evictions++;
+    entry->glyph = gCurGlyph;
+    entry->glyphId = glyphId;
+    entry->fontId = fontId;
+    entry->isJapanese = isJapanese;
+    entry->colors = GetGlyphCacheColors();
+    entry->valid = TRUE;
+    entry->lastUsed = ++sGlyphCacheClock;
+}
+
+void ClearGlyphCache(void)
+{
+    memset(sGlyphCache, 0, sizeof(sGlyphCache));
+    sGlyphCacheClock = 0;
+    memset(&sGlyphCacheStats, 0, sizeof(sGlyphCacheStats));
+}
+
+void GetGlyphCacheStats(struct GlyphCacheStats *stats)
+{
+    *stats = sGlyphCacheStats;
+}
+
 void CopyGlyphToWindow(struct TextPrinter *textPrinter)
 {
     struct Window *window;
@@ -1230,28 +1463,32 @@ static u16 RenderText(struct TextPrinter *textPrinter)
                 currChar = TO_LOWER(currChar);
         }
 
-        switch (subStruct->fontId)
+        if (!LoadCachedGlyph(subStruct->fontId, currChar, textPrinter->japanese))
         {
-        case FONT_SMALL:
-            DecompressGlyph_Small(currChar, textPrinter->japanese);
-            break;
-        case FONT_NORMAL:
-            DecompressGlyph_Normal(currChar, textPrinter->japanese);
-            break;
-        case FONT_SHORT:
-        case FONT_SHORT_COPY_1:
-        case FONT_SHORT_COPY_2:
-        case FONT_SHORT_COPY_3:
-            DecompressGlyph_Short(currChar, textPrinter->japanese);
-            break;
-        case FONT_NARROW:
-            DecompressGlyph_Narrow(currChar, textPrinter->japanese);
-            break;
-        case FONT_SMALL_NARROW:
-            DecompressGlyph_SmallNarrow(currChar, textPrinter->japanese);
-            break;
-        case FONT_BRAILLE:
-            break;
+            switch (subStruct->fontId)
+            {
+            case FONT_SMALL:
+                DecompressGlyph_Small(currChar, textPrinter->japanese);
+                break;
+            case FONT_NORMAL:
+                DecompressGlyph_Normal(currChar, textPrinter->japanese);
+                break;
+            case FONT_SHORT:
+            case FONT_SHORT_COPY_1:
+            case FONT_SHORT_COPY_2:
+            case FONT_SHORT_COPY_3:
+                DecompressGlyph_Short(currChar, textPrinter->japanese);
+                break;
+            case FONT_NARROW:
+                DecompressGlyph_Narrow(currChar, textPrinter->japanese);
+                break;
+            case FONT_SMALL_NARROW:
+                DecompressGlyph_SmallNarrow(currChar, textPrinter->japanese);
+                break;
+            case FONT_BRAILLE:
+                break;
+            }
+            CacheCurrentGlyph(subStruct->fontId, currChar, textPrinter->japanese);
         }
 
         CopyGlyphToWindow(textPrinter);
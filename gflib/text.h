@@ -139,6 +139,26 @@ struct TextGlyph
     u8 height;
 };
 
+// A string rendered once by PrerenderText into its own tiles, so that it
+// can be drawn again with BlitPrerenderedText without re-rendering it.
+struct PrerenderedText
+{
+    u8 *tiles;
+    u16 width; // in pixels
+    u8 widthTiles;
+    u8 heightTiles;
+    u8 bgColor;
+};
+
+// What the glyph cache did since ClearGlyphCache. An eviction is a miss
+// which replaced a cached glyph.
+struct GlyphCacheStats
+{
+    u32 hits;
+    u32 misses;
+    u32 evictions;
+};
+
 extern TextFlags gTextFlags;
 
 extern u8 gDisableTextPrinters;
@@ -168,6 +188,11 @@ void RestoreTextColors(u8 *fgColor, u8 *bgColor, u8 *shadowColor);
 void DecompressGlyphTile(const void *src_, void *dest_);
 void CopyGlyphToWindow(struct TextPrinter *x);
 void ClearTextSpan(struct TextPrinter *textPrinter, u32 width);
+bool32 PrerenderText(struct PrerenderedText *text, u8 fontId, const u8 *color, const u8 *str);
+void BlitPrerenderedText(const struct PrerenderedText *text, u8 windowId, u16 x, u16 y);
+void FreePrerenderedText(struct PrerenderedText *text);
+void ClearGlyphCache(void);
+void GetGlyphCacheStats(struct GlyphCacheStats *stats);
 
 void TextPrinterInitDownArrowCounters(struct TextPrinter *textPrinter);
 void TextPrinterDrawDownArrow(struct TextPrinter *textPrinter);
@@ -323,6 +323,51 @@ struct SwitchinCandidate
     bool8 hypotheticalStatus;
 };
 
+// Everything the AI damage matrix depends on for a single battler. If it's unchanged since the last turn, so are the battler's entries.
+// HP and PP change nearly every turn, so only the HP thresholds the calcs check are kept and moves which read more are never cached.
+struct AiDamageCacheKey
+{
+    u32 personality;
+    u32 status1;
+    u32 status2;
+    u32 status3;
+    u32 status4;
+    u32 resourceFlags;
+    u16 species;
+    u16 attack;
+    u16 defense;
+    u16 speed;
+    u16 spAttack;
+    u16 spDefense;
+    u16 item;
+    s8 statStages[NUM_BATTLE_STATS];
+    u8 types[3];
+    u8 level;
+    u8 friendship;
+    u8 hpThreshold; // See GetAiDamageCacheHpThreshold.
+    u8 isFirstTurn;
+    u8 sameMoveTurns;
+    u8 autotomizeCount; // Weight for Low Kick and Heat Crash.
+    bool8 tarShot;
+    bool8 slowStart;
+    u16 ability; // As assumed by the AI.
+    u16 holdEffect; // As assumed by the AI.
+    u16 moves[MAX_MON_MOVES]; // As known by the AI.
+    u16 partnerAbility;
+    u16 illusionSpecies;
+    u16 historyItem;
+    u8 moveLimitations;
+    bool8 zMoveUsed;
+    bool8 isDynamaxed;
+};
+
+struct AiDamageCacheFieldKey
+{
+    u32 weather;
+    u32 fieldStatuses;
+    u32 sideStatuses[NUM_BATTLE_SIDES];
+};
+
 // Ai Data used when deciding which move to use, computed only once before each turn's start.
 struct AiLogicData
 {
@@ -334,15 +379,25 @@ struct AiLogicData
     u8 hpPercents[MAX_BATTLERS_COUNT];
     u16 partnerMove;
     u16 speedStats[MAX_BATTLERS_COUNT]; // Speed stats for all battles, calculated only once, same way as damages
-    s32 simulatedDmg[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT][MAX_MON_MOVES]; // attacker, target, moveIndex
-    u8 effectiveness[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT][MAX_MON_MOVES]; // attacker, target, moveIndex
-    u8 moveAccuracy[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT][MAX_MON_MOVES]; // attacker, target, moveIndex
     u8 moveLimitations[MAX_BATTLERS_COUNT];
     bool8 shouldSwitchMon; // Because all available moves have no/little effect. Each bit per battler.
     u8 monToSwitchId[MAX_BATTLERS_COUNT]; // ID of the mon to switch.
     bool8 weatherHasEffect; // The same as WEATHER_HAS_EFFECT. Stored here, so it's called only once.
     u8 mostSuitableMonId[MAX_BATTLERS_COUNT]; // Stores result of GetMostSuitableMonToSwitchInto, which decides which generic mon the AI would switch into if they decide to switch. This can be overruled by specific mons found in ShouldSwitch; the final resulting mon is stored in AI_monToSwitchIntoId.
     struct SwitchinCandidate switchinCandidate; // Struct used for deciding which mon to switch to in battle_ai_switch_items.c
+    struct DamageContext damageContexts[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT]; // attacker, target. Shared by all moves between two battlers, see AI_GetDamageContext.
+    u8 damageContextValid[MAX_BATTLERS_COUNT]; // attacker. Each bit is a target whose damage context is up to date.
+    // Everything below is kept between turns and only the entries whose inputs changed are recalculated. See SetAiLogicDataForTurn.
+    // The matrices are filled on first access, read them through AI_GetSimulatedDmg, AI_GetSimulatedEffectiveness and AI_GetSimulatedAccuracy.
+    s32 simulatedDmg[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT][MAX_MON_MOVES]; // attacker, target, moveIndex
+    u8 effectiveness[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT][MAX_MON_MOVES]; // attacker, target, moveIndex
+    u8 moveAccuracy[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT][MAX_MON_MOVES]; // attacker, target, moveIndex
+    u8 dmgCalculated[MAX_BATTLERS_COUNT][MAX_BATTLERS_COUNT]; // attacker, target. Each bit is a moveIndex whose entries are up to date.
+    struct AiDamageCacheKey dmgCacheKeys[MAX_BATTLERS_COUNT];
+    struct AiDamageCacheFieldKey dmgCacheFieldKey;
+    u8 dmgCacheValid; // Each bit is a battler whose key is up to date.
+    u32 dmgCalcsPerformed; // Over the whole battle.
+    u32 dmgCalcsEager; // How many calcs the battle would have needed if the whole matrix was calculated every turn.
 };
 
 struct AI_ThinkingStruct
@@ -94,6 +94,9 @@ void Ai_InitPartyStruct(void);
 void Ai_UpdateSwitchInData(u32 battler);
 void Ai_UpdateFaintData(u32 battler);
 void SetAiLogicDataForTurn(struct AiLogicData *aiData);
+s32 AI_GetSimulatedDmg(u32 battlerAtk, u32 battlerDef, u32 moveIndex);
+u32 AI_GetSimulatedEffectiveness(u32 battlerAtk, u32 battlerDef, u32 moveIndex);
+u32 AI_GetSimulatedAccuracy(u32 battlerAtk, u32 battlerDef, u32 moveIndex);
 
 extern u8 sBattler_AI;
 
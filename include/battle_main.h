@@ -19,6 +19,24 @@ struct MultiPartnerMenuPokemon
     /*0x1D*/ u8 language;
 };
 
+// Everything that decides which of two battlers moves first, worked out once
+// per battler so that sorting several battlers doesn't redo it for every pair.
+struct TurnOrderKey
+{
+    u32 speed;
+    s8 priority;
+    u8 tier:4; // Quick Draw, Quick Claw/Custap Berry, no Lagging Tail, no Stall
+    u8 myceliumMight:1;
+    u8 statusMove:1;
+};
+
+struct TurnOrderKeys
+{
+    u8 computed; // Bit per battler
+    bool8 ignoreChosenMoves;
+    struct TurnOrderKey keys[MAX_BATTLERS_COUNT];
+};
+
 // defines for the 'DoBounceEffect' function
 #define BOUNCE_MON          0x0
 #define BOUNCE_HEALTHBOX    0x1
@@ -58,8 +76,10 @@ u32 GetBattlerTotalSpeedStatArgs(u32 battler, u32 ability, u32 holdEffect);
 u32 GetBattlerTotalSpeedStat(u32 battler);
 s8 GetChosenMovePriority(u32 battlerId);
 s8 GetMovePriority(u32 battlerId, u16 move);
-s32 GetWhichBattlerFasterArgs(u32 battler1, u32 battler2, bool32 ignoreChosenMoves, u32 ability1, u32 ability2,
-                              u32 holdEffectBattler1, u32 holdEffectBattler2, u32 speedBattler1, u32 speedBattler2, s32 priority1, s32 priority2);
+void InitTurnOrderKey(struct TurnOrderKey *key, u32 battler, u32 ability, u32 holdEffect, u32 speed, s32 priority);
+s32 CompareTurnOrderKeys(const struct TurnOrderKey *key1, const struct TurnOrderKey *key2);
+void ClearTurnOrderKeys(struct TurnOrderKeys *keys, bool32 ignoreChosenMoves);
+s32 GetWhichBattlerFasterWithKeys(struct TurnOrderKeys *keys, u32 battler1, u32 battler2);
 s32 GetWhichBattlerFaster(u32 battler1, u32 battler2, bool32 ignoreChosenMoves);
 void RunBattleScriptCommands_PopCallbacksStack(void);
 void RunBattleScriptCommands(void);
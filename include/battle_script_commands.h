@@ -57,6 +57,9 @@ bool32 DoSwitchInAbilities(u32 battlerId);
 u8 GetFirstFaintedPartyIndex(u8 battlerId);
 bool32 IsMoveAffectedByParentalBond(u32 move, u32 battler);
 
+void DispatchBattleScriptCommand(void);
+void PrintBattleScriptProfile(void);
+
 extern void (* const gBattleScriptingCommandsTable[])(void);
 extern const u8 gBattlePalaceNatureToMoveGroupLikelihood[NUM_NATURES][4];
 extern const struct StatFractions gAccuracyStageRatios[];
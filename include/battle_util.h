@@ -61,6 +61,22 @@
 #define IS_WHOLE_SIDE_ALIVE(battler)    ((IsBattlerAlive(battler) && IsBattlerAlive(BATTLE_PARTNER(battler))))
 #define IS_ALIVE_AND_PRESENT(battler)   (IsBattlerAlive(battler) && IsBattlerSpritePresent(battler))
 
+// The move-independent parts of a damage calculation between two battlers.
+// Built by InitDamageContext and used by CalculateMoveDamageWithContext, so
+// several moves between the same battlers share them.
+struct DamageContext
+{
+    u8 battlerAtk;
+    u8 battlerDef;
+    u16 abilityAtk;
+    u16 abilityDef;
+    u16 holdEffectAtk;
+    u16 holdEffectDef;
+    u32 weather;
+    u32 attack[2][2]; // [physical, special][not crit, crit], with stat stages applied
+    u32 defense[2][2]; // [defense, sp. defense][not crit, crit], with stat stages applied
+};
+
 // for Natural Gift and Fling
 struct TypePower
 {
@@ -147,6 +163,7 @@ bool32 TryChangeBattleWeather(u32 battler, u32 weatherEnumId, bool32 viaAbility)
 u32 AbilityBattleEffects(u32 caseID, u32 battler, u32 ability, u32 special, u32 moveArg);
 bool32 TryPrimalReversion(u32 battler);
 bool32 IsNeutralizingGasOnField(void);
+void InvalidateBattlerAbilityCache(void);
 bool32 IsMoldBreakerTypeAbility(u32 ability);
 u32 GetBattlerAbility(u32 battler);
 u32 IsAbilityOnSide(u32 battler, u32 ability);
@@ -176,9 +193,12 @@ u32 CalcFuryCutterBasePower(u32 basePower, u32 furyCutterCounter);
 s32 CalculateMoveDamage(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, s32 fixedBasePower, bool32 isCrit, bool32 randomFactor, bool32 updateFlags);
 s32 CalculateMoveDamageVars(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, s32 fixedBasePower, uq4_12_t typeEffectivenessModifier,
                                           u32 weather, bool32 isCrit, u32 holdEffectAtk, u32 holdEffectDef, u32 abilityAtk, u32 abilityDef);
+void InitDamageContext(struct DamageContext *ctx, u32 battlerAtk, u32 battlerDef, u32 weather, u32 holdEffectAtk, u32 holdEffectDef, u32 abilityAtk, u32 abilityDef);
+s32 CalculateMoveDamageWithContext(const struct DamageContext *ctx, u32 move, u32 moveType, s32 fixedBasePower, uq4_12_t typeEffectivenessModifier, bool32 isCrit);
 uq4_12_t CalcTypeEffectivenessMultiplier(u32 move, u32 moveType, u32 battlerAtk, u32 battlerDef, u32 defAbility, bool32 recordAbilities);
 uq4_12_t CalcPartyMonTypeEffectivenessMultiplier(u16 move, u16 speciesDef, u16 abilityDef);
 uq4_12_t GetTypeModifier(u32 atkType, u32 defType);
+uq4_12_t GetDualTypeModifier(u32 atkType, u32 defType1, u32 defType2);
 s32 GetStealthHazardDamage(u8 hazardType, u32 battler);
 s32 GetStealthHazardDamageByTypesAndHP(u8 hazardType, u8 type1, u8 type2, u32 maxHp);
 bool32 CanMegaEvolve(u32 battler);
@@ -10,6 +10,12 @@
 // Battle Debug Menu
 #define DEBUG_BATTLE_MENU               TRUE    // If set to TRUE, enables a debug menu to use in battles by pressing the Select button.
 #define DEBUG_AI_DELAY_TIMER            FALSE   // If set to TRUE, displays the number of frames it takes for the AI to choose a move. Replaces the "What will PKMN do" text. Useful for devs or anyone who modifies the AI code and wants to see if it doesn't take too long to run.
+#define DEBUG_AI_DAMAGE_CACHE_CHECK     TESTING // If set to TRUE, the AI damage matrix kept between turns is compared against a full recalculation every turn, and reused damage contexts against fresh ones. A mismatch fails the test in test builds and asserts otherwise.
+#define DEBUG_ABILITY_CACHE_CHECK       TESTING // If set to TRUE, every lookup of the cached battler abilities is compared against a full recalculation. A mismatch fails the test in test builds and asserts otherwise.
+#define DEBUG_BATTLE_SCRIPT_PROFILE     FALSE   // If set to TRUE, counts the calls and timer 3 ticks of every battle script command and prints them at the end of each battle over the debug print channel. Not measured in link battles.
+
+// Heap Debug
+#define DEBUG_HEAP_STATS                FALSE   // If set to TRUE, prints the peak heap usage, free bytes and largest free block over the debug print channel whenever the main callback changes. Walks the whole heap on every change.
 
 // Pokémon Debug
 #define DEBUG_POKEMON_MENU              TRUE    // Enables a debug menu for pokemon sprites and icons, accessed by pressing SELECT in the summary screen.
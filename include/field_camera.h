@@ -16,6 +16,8 @@ extern u16 gTotalCameraPixelOffsetX;
 extern u16 gTotalCameraPixelOffsetY;
 
 void DrawWholeMapView(void);
+void SetMapViewMetatileDirty(int x, int y);
+void InvalidateMapView(void);
 void CurrentMapDrawMetatileAt(int x, int y);
 void GetCameraOffsetWithPan(s16 *x, s16 *y);
 void DrawDoorMetatileAt(int x, int y, u16 *arr);
@@ -11,6 +11,14 @@
 
 #define NUM_TILES_PER_METATILE 8
 
+// MapGridGetMetatileInfoAt packs a map grid block into the low half and the
+// metatile's attributes into the high half.
+#define METATILE_INFO_ID(info)         ((info) & MAPGRID_METATILE_ID_MASK)
+#define METATILE_INFO_COLLISION(info)  (((info) & MAPGRID_COLLISION_MASK) >> MAPGRID_COLLISION_SHIFT)
+#define METATILE_INFO_ELEVATION(info)  (((info) & MAPGRID_ELEVATION_MASK) >> MAPGRID_ELEVATION_SHIFT)
+#define METATILE_INFO_BEHAVIOR(info)   (((info) >> 16) & METATILE_ATTR_BEHAVIOR_MASK)
+#define METATILE_INFO_LAYER_TYPE(info) ((((info) >> 16) & METATILE_ATTR_LAYER_MASK) >> METATILE_ATTR_LAYER_SHIFT)
+
 // Map coordinates are offset by 7 when using the map
 // buffer because it needs to load sufficient border
 // metatiles to fill the player's view (the player has
@@ -26,6 +34,7 @@ extern u16 ALIGNED(4) sBackupMapData[MAX_MAP_DATA_SIZE];
 
 u32 MapGridGetMetatileIdAt(int, int);
 u32 MapGridGetMetatileBehaviorAt(int, int);
+u32 MapGridGetMetatileInfoAt(int x, int y);
 void MapGridSetMetatileIdAt(int, int, u16);
 void MapGridSetMetatileEntryAt(int, int, u16);
 void GetCameraCoords(u16 *, u16 *);
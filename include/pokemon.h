@@ -262,6 +262,21 @@ struct BoxPokemon
     } secure;
 };
 
+// A decrypted copy of a BoxPokemon, for reading or writing several of its fields
+// with a single decryption. See OpenBoxMon and CloseBoxMon.
+struct BoxMonSession
+{
+    struct BoxPokemon *boxMon;
+    struct BoxPokemon decrypted;
+    struct PokemonSubstruct0 *substruct0;
+    struct PokemonSubstruct1 *substruct1;
+    struct PokemonSubstruct2 *substruct2;
+    struct PokemonSubstruct3 *substruct3;
+    bool8 isBadEgg;
+    bool8 modified;
+    bool8 substructsModified;
+};
+
 struct Pokemon
 {
     struct BoxPokemon box;
@@ -648,6 +663,7 @@ u16 GetUnionRoomTrainerClass(void);
 void CreateEnemyEventMon(void);
 void CalculateMonStats(struct Pokemon *mon);
 void BoxMonToMon(const struct BoxPokemon *src, struct Pokemon *dest);
+u8 GetLevelFromSpeciesAndExp(u16 species, u32 exp);
 u8 GetLevelFromMonExp(struct Pokemon *mon);
 u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon);
 u16 GiveMoveToMon(struct Pokemon *mon, u16 move);
@@ -687,6 +703,12 @@ u32 GetBoxMonData2(struct BoxPokemon *boxMon, s32 field);
 
 void SetMonData(struct Pokemon *mon, s32 field, const void *dataArg);
 void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg);
+#define GetBoxMonSessionData(...) CAT(GetBoxMonSessionData, NARG_8(__VA_ARGS__))(__VA_ARGS__)
+void OpenBoxMon(struct BoxMonSession *session, struct BoxPokemon *boxMon);
+u32 GetBoxMonSessionData3(struct BoxMonSession *session, s32 field, u8 *data);
+u32 GetBoxMonSessionData2(struct BoxMonSession *session, s32 field);
+void SetBoxMonSessionData(struct BoxMonSession *session, s32 field, const void *dataArg);
+void CloseBoxMon(struct BoxMonSession *session);
 void CopyMon(void *dest, void *src, size_t size);
 u8 GiveMonToPlayer(struct Pokemon *mon);
 u8 CopyMonToPC(struct Pokemon *mon);
@@ -747,6 +769,7 @@ void UpdatePartyPokerusTime(u16 days);
 void PartySpreadPokerus(struct Pokemon *party);
 bool8 TryIncrementMonLevel(struct Pokemon *mon);
 u8 CanLearnTeachableMove(u16 species, u16 move);
+bool32 IsMoveInTeachableLearnset(u16 species, u16 move);
 u8 GetMoveRelearnerMoves(struct Pokemon *mon, u16 *moves);
 u8 GetLevelUpMovesBySpecies(u16 species, u16 *moves);
 u8 GetNumberOfRelearnableMoves(struct Pokemon *mon);
@@ -479,7 +479,22 @@
  * EXPECT_MUL_EQ(a, m, b)
  * Causes the test to fail if a*m != b (within a threshold), e.g.
  *     // Expect results[0].damage * 1.5 == results[1].damage.
- *     EXPECT_EQ(results[0].damage, Q_4_12(1.5), results[1].damage); */
+ *     EXPECT_EQ(results[0].damage, Q_4_12(1.5), results[1].damage);
+ *
+ * AI SIMULATIONS
+ * AI_SIMULATION(name, trainerA, trainerB, battles)
+ * Plays battles between the parties of two trainers from
+ * src/data/trainers.h, with both sides controlled by the AI flags of
+ * their trainer, e.g.:
+ *     AI_SIMULATION("Roxanne vs Brawly", TRAINER_ROXANNE_1, TRAINER_BRAWLY_1, 200);
+ * Each battle is seeded with its index, so any one of them can be
+ * replayed. The battles are split into AI_SIMULATION_SHARDS tests so
+ * that they run in parallel. Simulations are not run by make check,
+ * instead use:
+ *     make simulate TESTS='Roxanne vs Brawly'
+ * which reports how often each trainer won (with a 95% confidence
+ * interval), the average number of turns, and the moves each trainer
+ * used. */
 
 #ifndef GUARD_TEST_BATTLE_H
 #define GUARD_TEST_BATTLE_H
@@ -718,6 +733,9 @@ struct BattleTestRunnerState
     u8 checkProgressParameter;
     u8 checkProgressTrial;
     u8 checkProgressTurn;
+    bool8 setupUsedRng; // A trial's setup depended on RNG, so cannot be snapshotted.
+    u32 setupStartFrame;
+    struct BattleTestSnapshot *snapshot;
 };
 
 extern const struct TestRunner gBattleTestRunner;
@@ -797,6 +815,58 @@ extern struct BattleTestRunnerState *const gBattleTestRunnerState;
 #define DOUBLE_BATTLE_TEST(_name, ...) BATTLE_TEST_ARGS_DOUBLE(_name, BATTLE_TEST_DOUBLES, __VA_ARGS__)
 #define AI_DOUBLE_BATTLE_TEST(_name, ...) BATTLE_TEST_ARGS_DOUBLE(_name, BATTLE_TEST_AI_DOUBLES, __VA_ARGS__)
 
+/* AI Simulations */
+
+#define AI_SIMULATION_SHARDS 8
+
+struct AiSimulation
+{
+    const char *name;
+    u16 trainerA; // Controls the player's side.
+    u16 trainerB;
+    u16 battles;
+};
+
+struct AiSimulationShard
+{
+    const struct AiSimulation *simulation;
+    u16 shard;
+};
+
+// AI_SIMULATION expands to one test per shard, so it has to be changed
+// along with AI_SIMULATION_SHARDS.
+STATIC_ASSERT(AI_SIMULATION_SHARDS == 8, AiSimulationShardsDontMatchExpansions)
+
+#define AI_SIMULATION(_name, _trainerA, _trainerB, _battles) \
+    static const struct AiSimulation CAT(sAiSimulation, __LINE__) = \
+    { \
+        .name = _name, \
+        .trainerA = _trainerA, \
+        .trainerB = _trainerB, \
+        .battles = _battles, \
+    }; \
+    AI_SIMULATION_SHARD(_name, 1) \
+    AI_SIMULATION_SHARD(_name, 2) \
+    AI_SIMULATION_SHARD(_name, 3) \
+    AI_SIMULATION_SHARD(_name, 4) \
+    AI_SIMULATION_SHARD(_name, 5) \
+    AI_SIMULATION_SHARD(_name, 6) \
+    AI_SIMULATION_SHARD(_name, 7) \
+    AI_SIMULATION_SHARD(_name, 8)
+
+#define AI_SIMULATION_SHARD(_name, _shard) \
+    __attribute__((section(".tests"))) static const struct Test CAT(CAT(sTest, __LINE__), _##_shard) = \
+    { \
+        .name = _name " (shard " #_shard ")", \
+        .filename = __FILE__, \
+        .runner = &gAiSimulationRunner, \
+        .data = (void *)&(const struct AiSimulationShard) \
+        { \
+            .simulation = &CAT(sAiSimulation, __LINE__), \
+            .shard = _shard - 1, \
+        }, \
+    };
+
 /* Parametrize */
 
 #undef PARAMETRIZE // Override test/test.h's implementation.
@@ -42,6 +42,7 @@ struct TestRunnerState
     const char *skipFilename;
     const struct Test *test;
     u32 processCosts[MAX_PROCESSES];
+    u8 processHeap[MAX_PROCESSES]; // Min heap of processes by cost.
 
     u8 result;
     u8 expectedResult;
@@ -49,13 +50,19 @@ struct TestRunnerState
     bool8 inBenchmark:1;
     bool8 tearDown:1;
     u32 timeoutSeconds;
+    u32 startFrame;
 };
 
 extern const u8 gTestRunnerN;
 extern const u8 gTestRunnerI;
 extern const char gTestRunnerArgv[256];
+extern const u16 gTestRunnerBatchStart;
+extern const u16 gTestRunnerBatchEnd;
+extern const bool8 gTestRunnerSnapshots;
+extern const bool8 gTestRunnerSimulations;
 
 extern const struct TestRunner gAssumptionsRunner;
+extern const struct TestRunner gAiSimulationRunner;
 
 struct FunctionTestRunnerState
 {
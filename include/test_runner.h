@@ -13,6 +13,7 @@ void TestRunner_Battle_RecordHP(u32 battlerId, u32 oldHP, u32 newHP);
 void TestRunner_Battle_RecordExp(u32 battlerId, u32 oldExp, u32 newExp);
 void TestRunner_Battle_RecordMessage(const u8 *message);
 void TestRunner_Battle_RecordStatus1(u32 battlerId, u32 status1);
+void TestRunner_Battle_BeforeFirstTurn(void);
 void TestRunner_Battle_AfterLastTurn(void);
 void TestRunner_Battle_CheckChosenMove(u32 battlerId, u32 moveId, u32 target);
 void TestRunner_Battle_CheckSwitch(u32 battlerId, u32 partyIndex);
@@ -24,6 +25,7 @@ void TestRunner_Battle_InvalidNoHPMon(u32 battlerId, u32 partyIndex);
 void TestRunner_Battle_CheckBattleRecordActionType(u32 battlerId, u32 recordIndex, u32 actionType);
 
 u32 TestRunner_Battle_GetForcedAbility(u32 side, u32 partyIndex);
+bool32 TestRunner_Battle_IsAiVsAiBattle(void);
 
 #else
 
@@ -33,6 +35,7 @@ u32 TestRunner_Battle_GetForcedAbility(u32 side, u32 partyIndex);
 #define TestRunner_Battle_RecordExp(...) (void)0
 #define TestRunner_Battle_RecordMessage(...) (void)0
 #define TestRunner_Battle_RecordStatus1(...) (void)0
+#define TestRunner_Battle_BeforeFirstTurn(...) (void)0
 #define TestRunner_Battle_AfterLastTurn(...) (void)0
 #define TestRunner_Battle_CheckChosenMove(...) (void)0
 #define TestRunner_Battle_CheckSwitch(...) (void)0
@@ -44,6 +47,7 @@ u32 TestRunner_Battle_GetForcedAbility(u32 side, u32 partyIndex);
 #define TestRunner_Battle_CheckBattleRecordActionType(...) (void)0
 
 #define TestRunner_Battle_GetForcedAbility(...) (u32)0
+#define TestRunner_Battle_IsAiVsAiBattle(...) FALSE
 
 #endif
 
@@ -12,3 +12,9 @@ $(DATA_SRC_SUBDIR)/region_map/region_map_entries.h: $(DATA_SRC_SUBDIR)/region_ma
 	$(JSONPROC) $^ $@
 
 $(C_BUILDDIR)/region_map.o: c_dep += $(DATA_SRC_SUBDIR)/region_map/region_map_entries.h
+
+AUTO_GEN_TARGETS += $(DATA_SRC_SUBDIR)/wild_encounter_index.h
+$(DATA_SRC_SUBDIR)/wild_encounter_index.h: $(DATA_SRC_SUBDIR)/wild_encounters.json include/constants/map_groups.h tools/wild_encounter_helpers/header_index.py
+	python3 tools/wild_encounter_helpers/header_index.py $(DATA_SRC_SUBDIR)/wild_encounters.json include/constants/map_groups.h $@
+
+$(C_BUILDDIR)/wild_encounter.o: c_dep += $(DATA_SRC_SUBDIR)/wild_encounter_index.h
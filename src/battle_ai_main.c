@@ -24,6 +24,9 @@
 #include "constants/moves.h"
 #include "constants/items.h"
 #include "constants/trainers.h"
+#if TESTING
+#include "test/test.h"
+#endif
 
 #define AI_ACTION_DONE          (1 << 0)
 #define AI_ACTION_FLEE          (1 << 1)
@@ -407,55 +410,289 @@ static u32 Ai_SetMoveAccuracy(struct AiLogicData *aiData, u32 battlerAtk, u32 ba
     return accuracy;
 }
 
-static void SetBattlerAiMovesData(struct AiLogicData *aiData, u32 battlerAtk, u32 battlersCount)
+// Moves whose damage depends on state that isn't part of struct AiDamageCacheKey are recalculated every turn.
+static bool32 IsMoveDamageCacheable(u32 move)
 {
-    u32 battlerDef, i, weather;
-    u16 *moves;
+    if (move == MOVE_UNAVAILABLE)
+        return TRUE;
 
-    SaveBattlerData(battlerAtk);
-    moves = GetMovesArray(battlerAtk);
-    weather = AI_GetWeather(aiData);
+    switch (gMovesInfo[move].effect)
+    {
+    case EFFECT_ROLLOUT:
+    case EFFECT_FURY_CUTTER:
+    case EFFECT_MAGNITUDE:
+    case EFFECT_PRESENT:
+    case EFFECT_TRIPLE_KICK:
+    case EFFECT_SPIT_UP:
+    case EFFECT_REVENGE:
+    case EFFECT_ASSURANCE:
+    case EFFECT_ECHOED_VOICE:
+    case EFFECT_PAYBACK:
+    case EFFECT_BOLT_BEAK:
+    case EFFECT_ROUND:
+    case EFFECT_FUSION_COMBO:
+    case EFFECT_LASH_OUT:
+    case EFFECT_PLEDGE:
+    case EFFECT_BEAT_UP:
+    case EFFECT_MAX_MOVE:
+    case EFFECT_RAGE_FIST:
+    case EFFECT_FICKLE_BEAM:
+    case EFFECT_LAST_RESPECTS:
+    case EFFECT_RETALIATE:
+    case EFFECT_STOMPING_TANTRUM:
+    // Depend on the exact HP or PP.
+    case EFFECT_ERUPTION:
+    case EFFECT_FLAIL:
+    case EFFECT_VARY_POWER_BASED_ON_HP:
+    case EFFECT_BRINE:
+    case EFFECT_TRUMP_CARD:
+    case EFFECT_ENDEAVOR:
+    case EFFECT_SUPER_FANG:
+    case EFFECT_FINAL_GAMBIT:
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Full HP (Multiscale), above half, above a third (Defeatist) or at most a third (Blaze and co.).
+static u32 GetAiDamageCacheHpThreshold(u32 battler)
+{
+    u32 hp = gBattleMons[battler].hp;
+    u32 maxHP = gBattleMons[battler].maxHP;
+
+    if (hp == maxHP)
+        return 0;
+    if (hp > maxHP / 2)
+        return 1;
+    if (hp > maxHP / 3)
+        return 2;
+    return 3;
+}
+
+static void GetAiDamageCacheKey(struct AiLogicData *aiData, u32 battler, struct AiDamageCacheKey *key)
+{
+    u32 i, partner = BATTLE_PARTNER(battler);
+    u16 *moves = GetMovesArray(battler);
+
+    memset(key, 0, sizeof(*key));
+    key->personality = gBattleMons[battler].personality;
+    key->status1 = gBattleMons[battler].status1;
+    key->status2 = gBattleMons[battler].status2;
+    key->resourceFlags = gBattleResources->flags->flags[battler];
+    key->species = gBattleMons[battler].species;
+    key->attack = gBattleMons[battler].attack;
+    key->defense = gBattleMons[battler].defense;
+    key->speed = gBattleMons[battler].speed;
+    key->spAttack = gBattleMons[battler].spAttack;
+    key->spDefense = gBattleMons[battler].spDefense;
+    key->item = gBattleMons[battler].item;
+    for (i = 0; i < NUM_BATTLE_STATS; i++)
+        key->statStages[i] = gBattleMons[battler].statStages[i];
+    key->types[0] = gBattleMons[battler].type1;
+    key->types[1] = gBattleMons[battler].type2;
+    key->types[2] = gBattleMons[battler].type3;
+    key->level = gBattleMons[battler].level;
+    key->friendship = gBattleMons[battler].friendship;
+    key->hpThreshold = GetAiDamageCacheHpThreshold(battler);
+    key->isFirstTurn = gDisableStructs[battler].isFirstTurn;
+    key->sameMoveTurns = gBattleStruct->sameMoveTurns[battler];
+    key->autotomizeCount = gDisableStructs[battler].autotomizeCount;
+    key->tarShot = gDisableStructs[battler].tarShot;
+    key->slowStart = (gDisableStructs[battler].slowStartTimer != 0);
+    key->status3 = gStatuses3[battler];
+    key->status4 = gStatuses4[battler];
+    key->ability = aiData->abilities[battler];
+    key->holdEffect = aiData->holdEffects[battler];
+    for (i = 0; i < MAX_MON_MOVES; i++)
+        key->moves[i] = moves[i];
+    if (IsBattlerAlive(partner))
+        key->partnerAbility = aiData->abilities[partner];
+    key->illusionSpecies = GetIllusionMonSpecies(battler);
+    key->historyItem = BATTLE_HISTORY->heldItems[battler];
+    key->moveLimitations = aiData->moveLimitations[battler];
+    key->zMoveUsed = gBattleStruct->zmove.used[battler];
+    key->isDynamaxed = IsDynamaxed(battler);
+}
+
+static void CalcBattlerAiMoveData(struct AiLogicData *aiData, u32 battlerAtk, u32 battlerDef, u32 moveIndex, u32 move, u32 weather, s32 *dmg, u8 *effectiveness, u8 *accuracy)
+{
+    *dmg = 0;
+    *effectiveness = AI_EFFECTIVENESS_x0;
+    *accuracy = 0;
+    if (move != 0
+     && move != 0xFFFF
+     //&& gMovesInfo[move].power != 0  /* we want to get effectiveness and accuracy of status moves */
+     && !(aiData->moveLimitations[battlerAtk] & gBitTable[moveIndex]))
+    {
+        *dmg = AI_CalcDamage(move, battlerAtk, battlerDef, effectiveness, TRUE, weather);
+        *accuracy = Ai_SetMoveAccuracy(aiData, battlerAtk, battlerDef, move);
+    }
+}
+
+// Marks the entries which have to be recalculated on their next access.
+static void InvalidateBattlerAiMovesData(struct AiLogicData *aiData, u32 battlerAtk, u32 battlersCount, u32 dirtyBattlers)
+{
+    u32 battlerDef, i;
+    u16 *moves = GetMovesArray(battlerAtk);
 
-    // Simulate dmg for both ai controlled mons and for player controlled mons.
     for (battlerDef = 0; battlerDef < battlersCount; battlerDef++)
     {
         if (battlerAtk == battlerDef)
             continue;
 
-        SaveBattlerData(battlerDef);
         for (i = 0; i < MAX_MON_MOVES; i++)
         {
-            s32 dmg = 0;
-            u8 effectiveness = AI_EFFECTIVENESS_x0;
-            u32 move = moves[i];
-
-            if (move != 0
-             && move != 0xFFFF
-             //&& gMovesInfo[move].power != 0  /* we want to get effectiveness and accuracy of status moves */
-             && !(aiData->moveLimitations[battlerAtk] & gBitTable[i]))
+            if ((dirtyBattlers & (gBitTable[battlerAtk] | gBitTable[battlerDef])) || !IsMoveDamageCacheable(moves[i]))
+                aiData->dmgCalculated[battlerAtk][battlerDef] &= ~gBitTable[i];
+        }
+        aiData->dmgCalcsEager += MAX_MON_MOVES;
+    }
+}
+
+static void TryCalcBattlerAiMoveData(struct AiLogicData *aiData, u32 battlerAtk, u32 battlerDef, u32 moveIndex)
+{
+    if (aiData->dmgCalculated[battlerAtk][battlerDef] & gBitTable[moveIndex])
+        return;
+
+    SaveBattlerData(battlerAtk);
+    SaveBattlerData(battlerDef);
+    // Simulate dmg for both ai controlled mons and for player controlled mons.
+    CalcBattlerAiMoveData(aiData, battlerAtk, battlerDef, moveIndex, GetMovesArray(battlerAtk)[moveIndex], AI_GetWeather(aiData),
+                          &aiData->simulatedDmg[battlerAtk][battlerDef][moveIndex],
+                          &aiData->effectiveness[battlerAtk][battlerDef][moveIndex],
+                          &aiData->moveAccuracy[battlerAtk][battlerDef][moveIndex]);
+    aiData->dmgCalculated[battlerAtk][battlerDef] |= gBitTable[moveIndex];
+    aiData->dmgCalcsPerformed++;
+}
+
+s32 AI_GetSimulatedDmg(u32 battlerAtk, u32 battlerDef, u32 moveIndex)
+{
+    struct AiLogicData *aiData = AI_DATA;
+
+    if (!(aiData->dmgCalculated[battlerAtk][battlerDef] & gBitTable[moveIndex]))
+    {
+        u32 move = GetMovesArray(battlerAtk)[moveIndex];
+        // Status moves never deal damage, no need to go through the whole calculation.
+        if (move == MOVE_NONE || move == MOVE_UNAVAILABLE || gMovesInfo[move].power == 0)
+            return 0;
+        TryCalcBattlerAiMoveData(aiData, battlerAtk, battlerDef, moveIndex);
+    }
+    return aiData->simulatedDmg[battlerAtk][battlerDef][moveIndex];
+}
+
+u32 AI_GetSimulatedEffectiveness(u32 battlerAtk, u32 battlerDef, u32 moveIndex)
+{
+    struct AiLogicData *aiData = AI_DATA;
+
+    TryCalcBattlerAiMoveData(aiData, battlerAtk, battlerDef, moveIndex);
+    return aiData->effectiveness[battlerAtk][battlerDef][moveIndex];
+}
+
+u32 AI_GetSimulatedAccuracy(u32 battlerAtk, u32 battlerDef, u32 moveIndex)
+{
+    struct AiLogicData *aiData = AI_DATA;
+
+    TryCalcBattlerAiMoveData(aiData, battlerAtk, battlerDef, moveIndex);
+    return aiData->moveAccuracy[battlerAtk][battlerDef][moveIndex];
+}
+
+// Returns a bit for every battler whose damage matrix entries have to be recalculated and updates the stored keys.
+static u32 UpdateAiDamageCacheKeys(struct AiLogicData *aiData, u32 battlersCount)
+{
+    u32 battler, dirtyBattlers = 0;
+    struct AiDamageCacheKey key;
+    struct AiDamageCacheFieldKey fieldKey;
+
+    memset(&fieldKey, 0, sizeof(fieldKey));
+    fieldKey.weather = AI_GetWeather(aiData);
+    fieldKey.fieldStatuses = gFieldStatuses;
+    fieldKey.sideStatuses[B_SIDE_PLAYER] = gSideStatuses[B_SIDE_PLAYER];
+    fieldKey.sideStatuses[B_SIDE_OPPONENT] = gSideStatuses[B_SIDE_OPPONENT];
+    if (memcmp(&fieldKey, &aiData->dmgCacheFieldKey, sizeof(fieldKey)) != 0)
+    {
+        aiData->dmgCacheFieldKey = fieldKey;
+        aiData->dmgCacheValid = 0;
+    }
+
+    for (battler = 0; battler < battlersCount; battler++)
+    {
+        GetAiDamageCacheKey(aiData, battler, &key);
+        if (!(aiData->dmgCacheValid & gBitTable[battler])
+         || memcmp(&key, &aiData->dmgCacheKeys[battler], sizeof(key)) != 0)
+        {
+            aiData->dmgCacheKeys[battler] = key;
+            dirtyBattlers |= gBitTable[battler];
+        }
+    }
+    aiData->dmgCacheValid = (1u << battlersCount) - 1;
+    return dirtyBattlers;
+}
+
+#if DEBUG_AI_DAMAGE_CACHE_CHECK
+static void CheckAiDamageCache(struct AiLogicData *aiData, u32 battlersCount)
+{
+    u32 battlerAtk, battlerDef, i, weather = AI_GetWeather(aiData);
+    s32 dmg;
+    u8 effectiveness, accuracy;
+    u16 *moves;
+
+    for (battlerAtk = 0; battlerAtk < battlersCount; battlerAtk++)
+    {
+        if (!IsBattlerAlive(battlerAtk))
+            continue;
+
+        SaveBattlerData(battlerAtk);
+        moves = GetMovesArray(battlerAtk);
+        for (battlerDef = 0; battlerDef < battlersCount; battlerDef++)
+        {
+            if (battlerAtk == battlerDef)
+                continue;
+
+            SaveBattlerData(battlerDef);
+            for (i = 0; i < MAX_MON_MOVES; i++)
             {
-                dmg = AI_CalcDamage(move, battlerAtk, battlerDef, &effectiveness, TRUE, weather);
-                aiData->moveAccuracy[battlerAtk][battlerDef][i] = Ai_SetMoveAccuracy(aiData, battlerAtk, battlerDef, move);
+                if (!(aiData->dmgCalculated[battlerAtk][battlerDef] & gBitTable[i]))
+                    continue;
+
+                CalcBattlerAiMoveData(aiData, battlerAtk, battlerDef, i, moves[i], weather, &dmg, &effectiveness, &accuracy);
+                if (dmg != aiData->simulatedDmg[battlerAtk][battlerDef][i]
+                 || effectiveness != aiData->effectiveness[battlerAtk][battlerDef][i]
+                 || accuracy != aiData->moveAccuracy[battlerAtk][battlerDef][i])
+                {
+                #if TESTING
+                    Test_ExitWithResult(TEST_RESULT_ERROR, "AI damage cache mismatch: battler %d vs %d, move %d: %d/%d/%d cached, %d/%d/%d calculated",
+                                        battlerAtk, battlerDef, moves[i],
+                                        aiData->simulatedDmg[battlerAtk][battlerDef][i], aiData->effectiveness[battlerAtk][battlerDef][i], aiData->moveAccuracy[battlerAtk][battlerDef][i],
+                                        dmg, effectiveness, accuracy);
+                #else
+                    DebugPrintf("AI damage cache mismatch: battler %d vs %d, move %d", battlerAtk, battlerDef, moves[i]);
+                    AGB_ASSERT(FALSE);
+                #endif // TESTING
+                }
             }
-            aiData->simulatedDmg[battlerAtk][battlerDef][i] = dmg;
-            aiData->effectiveness[battlerAtk][battlerDef][i] = effectiveness;
         }
     }
 }
+#endif // DEBUG_AI_DAMAGE_CACHE_CHECK
 
 void SetAiLogicDataForTurn(struct AiLogicData *aiData)
 {
-    u32 battlerAtk, battlersCount;
+    u32 battlerAtk, battlersCount, dirtyBattlers;
 
-    memset(aiData, 0, sizeof(struct AiLogicData));
     if (!(gBattleTypeFlags & BATTLE_TYPE_HAS_AI) && !IsWildMonSmart())
+    {
+        memset(aiData, 0, sizeof(struct AiLogicData));
         return;
+    }
+
+    // The damage matrix and its keys are at the end of the struct and survive between turns.
+    memset(aiData, 0, offsetof(struct AiLogicData, simulatedDmg));
 
     // Set delay timer to count how long it takes for AI to choose action/move
     gBattleStruct->aiDelayTimer = gMain.vblankCounter1;
 
     aiData->weatherHasEffect = WEATHER_HAS_EFFECT;
-    // get/assume all battler data and simulate AI damage
+    // get/assume all battler data
     battlersCount = gBattlersCount;
     for (battlerAtk = 0; battlerAtk < battlersCount; battlerAtk++)
     {
@@ -463,8 +700,27 @@ void SetAiLogicDataForTurn(struct AiLogicData *aiData)
             continue;
 
         SetBattlerAiData(battlerAtk, aiData);
-        SetBattlerAiMovesData(aiData, battlerAtk, battlersCount);
     }
+
+    // AI damage is simulated on first access, only for the battlers whose inputs changed since the last turn
+    dirtyBattlers = UpdateAiDamageCacheKeys(aiData, battlersCount);
+    for (battlerAtk = 0; battlerAtk < battlersCount; battlerAtk++)
+    {
+        if (!IsBattlerAlive(battlerAtk))
+        {
+            memset(aiData->simulatedDmg[battlerAtk], 0, sizeof(aiData->simulatedDmg[battlerAtk]));
+            memset(aiData->effectiveness[battlerAtk], 0, sizeof(aiData->effectiveness[battlerAtk]));
+            memset(aiData->moveAccuracy[battlerAtk], 0, sizeof(aiData->moveAccuracy[battlerAtk]));
+            memset(aiData->dmgCalculated[battlerAtk], (1 << MAX_MON_MOVES) - 1, sizeof(aiData->dmgCalculated[battlerAtk]));
+            continue;
+        }
+
+        InvalidateBattlerAiMovesData(aiData, battlerAtk, battlersCount, dirtyBattlers);
+    }
+
+#if DEBUG_AI_DAMAGE_CACHE_CHECK
+    CheckAiDamageCache(aiData, battlersCount);
+#endif // DEBUG_AI_DAMAGE_CACHE_CHECK
 }
 
 static bool32 AI_SwitchMonIfSuitable(u32 battler, bool32 doubleBattle)
@@ -786,7 +1042,7 @@ static s32 AI_CheckBadMove(u32 battlerAtk, u32 battlerDef, u32 move, s32 score)
     s32 moveType;
     u32 moveTarget = AI_GetBattlerMoveTargetType(battlerAtk, move);
     struct AiLogicData *aiData = AI_DATA;
-    u32 effectiveness = aiData->effectiveness[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex];
+    u32 effectiveness = AI_GetSimulatedEffectiveness(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex);
     bool32 isDoubleBattle = IsValidDoubleBattle(battlerAtk);
     u32 i;
     u32 weather;
@@ -1856,7 +2112,7 @@ static s32 AI_CheckBadMove(u32 battlerAtk, u32 battlerDef, u32 move, s32 score)
                 ADJUST_SCORE(-8); //No point in healing, but should at least do it if nothing better
             break;
         case EFFECT_RECOIL_IF_MISS:
-            if (aiData->abilities[battlerAtk] != ABILITY_MAGIC_GUARD && AI_DATA->moveAccuracy[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex] < 75)
+            if (aiData->abilities[battlerAtk] != ABILITY_MAGIC_GUARD && AI_GetSimulatedAccuracy(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex) < 75)
                 ADJUST_SCORE(-6);
             break;
         case EFFECT_TRANSFORM:
@@ -3035,8 +3291,8 @@ static bool32 IsPinchBerryItemEffect(u32 holdEffect)
 
 static s32 CompareMoveAccuracies(u32 battlerAtk, u32 battlerDef, u32 moveSlot1, u32 moveSlot2)
 {
-    u32 acc1 = AI_DATA->moveAccuracy[battlerAtk][battlerDef][moveSlot1];
-    u32 acc2 = AI_DATA->moveAccuracy[battlerAtk][battlerDef][moveSlot2];
+    u32 acc1 = AI_GetSimulatedAccuracy(battlerAtk, battlerDef, moveSlot1);
+    u32 acc2 = AI_GetSimulatedAccuracy(battlerAtk, battlerDef, moveSlot2);
 
     if (acc1 > acc2)
         return 1;
@@ -3076,7 +3332,7 @@ static s32 AI_CompareDamagingMoves(u32 battlerAtk, u32 battlerDef, u32 currId)
             isTwoTurnNotSemiInvulnerableMove[i] = FALSE;
         }
         /*
-            MgbaPrintf_("%S: required hits: %d Dmg: %d", gMoveNames[moves[i]], noOfHits[i], AI_DATA->simulatedDmg[battlerAtk][battlerDef][i]);
+            MgbaPrintf_("%S: required hits: %d Dmg: %d", gMoveNames[moves[i]], noOfHits[i], AI_GetSimulatedDmg(battlerAtk, battlerDef, i));
         */
     }
 
@@ -3148,7 +3404,7 @@ static u32 AI_CalcMoveScore(u32 battlerAtk, u32 battlerDef, u32 move)
     u32 moveEffect = gMovesInfo[move].effect;
     struct AiLogicData *aiData = AI_DATA;
     u32 movesetIndex = AI_THINKING_STRUCT->movesetIndex;
-    u32 effectiveness = aiData->effectiveness[battlerAtk][battlerDef][movesetIndex];
+    u32 effectiveness = AI_GetSimulatedEffectiveness(battlerAtk, battlerDef, movesetIndex);
 
     s32 score = 0;
     u32 predictedMove = aiData->predictedMoves[battlerDef];
@@ -14,6 +14,7 @@
 #include "pokemon.h"
 #include "random.h"
 #include "recorded_battle.h"
+#include "test_runner.h"
 #include "util.h"
 #include "constants/abilities.h"
 #include "constants/battle_ai.h"
@@ -21,6 +22,9 @@
 #include "constants/hold_effects.h"
 #include "constants/moves.h"
 #include "constants/items.h"
+#if DEBUG_AI_DAMAGE_CACHE_CHECK && TESTING
+#include "test/test.h"
+#endif
 
 #define CHECK_MOVE_FLAG(flag)                                                                                   \
     s32 i;                                                                                                      \
@@ -49,6 +53,8 @@ bool32 AI_RandLessThan(u32 val)
 
 bool32 IsAiVsAiBattle(void)
 {
+    if (gTestRunnerEnabled && TestRunner_Battle_IsAiVsAiBattle())
+        return TRUE;
     return (B_FLAG_AI_VS_AI_BATTLE && FlagGet(B_FLAG_AI_VS_AI_BATTLE));
 }
 
@@ -226,6 +232,7 @@ void SetBattlerData(u32 battlerId)
         // The ability is unknown.
         else
             gBattleMons[battlerId].ability = ABILITY_NONE;
+        InvalidateBattlerAbilityCache();
 
         if (AI_PARTY->mons[side][gBattlerPartyIndexes[battlerId]].heldEffect == 0)
             gBattleMons[battlerId].item = 0;
@@ -245,6 +252,7 @@ void RestoreBattlerData(u32 battlerId)
         u32 i;
 
         gBattleMons[battlerId].ability = AI_THINKING_STRUCT->saved[battlerId].ability;
+        InvalidateBattlerAbilityCache();
         gBattleMons[battlerId].item = AI_THINKING_STRUCT->saved[battlerId].heldItem;
         gBattleMons[battlerId].species = AI_THINKING_STRUCT->saved[battlerId].species;
         for (i = 0; i < 4; i++)
@@ -443,6 +451,54 @@ bool32 IsDamageMoveUsable(u32 move, u32 battlerAtk, u32 battlerDef)
     return FALSE;
 }
 
+// The move-independent parts of the damage calcs between two battlers are shared
+// by all of their moves. The stats they depend on only change while battle
+// scripts run, so the contexts are dropped whenever the AI starts a decision
+// (SetAiLogicDataForTurn clears them with the rest of the turn's data) and
+// whenever it simulates a battler that isn't on the field.
+static const struct DamageContext *AI_GetDamageContext(struct AiLogicData *aiData, u32 battlerAtk, u32 battlerDef, u32 weather)
+{
+    struct DamageContext *ctx = &aiData->damageContexts[battlerAtk][battlerDef];
+
+    if (!(aiData->damageContextValid[battlerAtk] & gBitTable[battlerDef])
+     || ctx->weather != weather
+     || ctx->abilityAtk != aiData->abilities[battlerAtk]
+     || ctx->abilityDef != aiData->abilities[battlerDef]
+     || ctx->holdEffectAtk != aiData->holdEffects[battlerAtk]
+     || ctx->holdEffectDef != aiData->holdEffects[battlerDef])
+    {
+        InitDamageContext(ctx, battlerAtk, battlerDef, weather,
+                          aiData->holdEffects[battlerAtk], aiData->holdEffects[battlerDef],
+                          aiData->abilities[battlerAtk], aiData->abilities[battlerDef]);
+        aiData->damageContextValid[battlerAtk] |= gBitTable[battlerDef];
+    }
+#if DEBUG_AI_DAMAGE_CACHE_CHECK
+    else
+    {
+        struct DamageContext check;
+
+        InitDamageContext(&check, battlerAtk, battlerDef, weather,
+                          aiData->holdEffects[battlerAtk], aiData->holdEffects[battlerDef],
+                          aiData->abilities[battlerAtk], aiData->abilities[battlerDef]);
+        if (memcmp(check.attack, ctx->attack, sizeof(check.attack)) != 0 || memcmp(check.defense, ctx->defense, sizeof(check.defense)) != 0)
+        {
+        #if TESTING
+            Test_ExitWithResult(TEST_RESULT_ERROR, "AI damage context mismatch: battler %d vs %d", battlerAtk, battlerDef);
+        #else
+            DebugPrintf("AI damage context mismatch: battler %d vs %d", battlerAtk, battlerDef);
+            AGB_ASSERT(FALSE);
+        #endif // TESTING
+        }
+    }
+#endif // DEBUG_AI_DAMAGE_CACHE_CHECK
+    return ctx;
+}
+
+void AI_InvalidateDamageContexts(void)
+{
+    memset(AI_DATA->damageContextValid, 0, sizeof(AI_DATA->damageContextValid));
+}
+
 s32 AI_CalcDamage(u32 move, u32 battlerAtk, u32 battlerDef, u8 *typeEffectiveness, bool32 considerZPower, u32 weather)
 {
     s32 dmg, moveType;
@@ -478,6 +534,7 @@ s32 AI_CalcDamage(u32 move, u32 battlerAtk, u32 battlerDef, u8 *typeEffectivenes
     if (gMovesInfo[move].power && !isDamageMoveUnusable)
     {
         s32 critChanceIndex, normalDmg, fixedBasePower, n;
+        const struct DamageContext *ctx = AI_GetDamageContext(aiData, battlerAtk, battlerDef, weather);
 
         ProteanTryChangeType(battlerAtk, aiData->abilities[battlerAtk], move, moveType);
         // Certain moves like Rollout calculate damage based on values which change during the move execution, but before calling dmg calc.
@@ -494,18 +551,12 @@ s32 AI_CalcDamage(u32 move, u32 battlerAtk, u32 battlerDef, u8 *typeEffectivenes
             fixedBasePower = 0;
             break;
         }
-        normalDmg = CalculateMoveDamageVars(move, battlerAtk, battlerDef, moveType, fixedBasePower,
-                                             effectivenessMultiplier, weather, FALSE,
-                                             aiData->holdEffects[battlerAtk], aiData->holdEffects[battlerDef],
-                                             aiData->abilities[battlerAtk], aiData->abilities[battlerDef]);
+        normalDmg = CalculateMoveDamageWithContext(ctx, move, moveType, fixedBasePower, effectivenessMultiplier, FALSE);
 
         critChanceIndex = CalcCritChanceStageArgs(battlerAtk, battlerDef, move, FALSE, aiData->abilities[battlerAtk], aiData->abilities[battlerDef], aiData->holdEffects[battlerAtk]);
         if (critChanceIndex > 1) // Consider crit damage only if a move has at least +1 crit chance
         {
-            s32 critDmg = CalculateMoveDamageVars(move, battlerAtk, battlerDef, moveType, fixedBasePower,
-                                             effectivenessMultiplier, weather, TRUE,
-                                             aiData->holdEffects[battlerAtk], aiData->holdEffects[battlerDef],
-                                             aiData->abilities[battlerAtk], aiData->abilities[battlerDef]);
+            s32 critDmg = CalculateMoveDamageWithContext(ctx, move, moveType, fixedBasePower, effectivenessMultiplier, TRUE);
             u32 critChance = GetCritHitChance(critChanceIndex);
             // With critChance getting closer to 1, dmg gets closer to critDmg.
             dmg = LowestRollDmg((critDmg + normalDmg * (critChance - 1)) / (critChance));
@@ -801,12 +852,12 @@ u32 GetNoOfHitsToKOBattlerDmg(u32 dmg, u32 battlerDef)
 
 u32 GetNoOfHitsToKOBattler(u32 battlerAtk, u32 battlerDef, u32 moveIndex)
 {
-    return GetNoOfHitsToKOBattlerDmg(AI_DATA->simulatedDmg[battlerAtk][battlerDef][moveIndex], battlerDef);
+    return GetNoOfHitsToKOBattlerDmg(AI_GetSimulatedDmg(battlerAtk, battlerDef, moveIndex), battlerDef);
 }
 
 u32 GetCurrDamageHpPercent(u32 battlerAtk, u32 battlerDef)
 {
-    int bestDmg = AI_DATA->simulatedDmg[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex];
+    int bestDmg = AI_GetSimulatedDmg(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex);
 
     return (bestDmg * 100) / gBattleMons[battlerDef].maxHP;
 }
@@ -874,6 +925,7 @@ s32 AI_WhoStrikesFirst(u32 battlerAI, u32 battler2, u32 moveConsidered)
     s8 prioAI = 0;
     s8 prioBattler2 = 0;
     u16 *battler2Moves = GetMovesArray(battler2);
+    struct TurnOrderKey keyAI, keyBattler2;
 
     // Check move priorities first.
     prioAI = GetMovePriority(battlerAI, moveConsidered);
@@ -903,11 +955,9 @@ s32 AI_WhoStrikesFirst(u32 battlerAI, u32 battler2, u32 moveConsidered)
         if (prioAI > prioBattler2)
             return AI_IS_FASTER;    // if we didn't know any of battler 2's moves to compare priorities, assume they don't have a prio+ move
         // Priorities are the same(at least comparing to moves the AI is aware of), decide by speed.
-        if (GetWhichBattlerFasterArgs(battlerAI, battler2, TRUE,
-                                      AI_DATA->abilities[battlerAI], AI_DATA->abilities[battler2],
-                                      AI_DATA->holdEffects[battlerAI], AI_DATA->holdEffects[battler2],
-                                      AI_DATA->speedStats[battlerAI], AI_DATA->speedStats[battler2],
-                                      prioAI, prioBattler2) == 1)
+        InitTurnOrderKey(&keyAI, battlerAI, AI_DATA->abilities[battlerAI], AI_DATA->holdEffects[battlerAI], AI_DATA->speedStats[battlerAI], prioAI);
+        InitTurnOrderKey(&keyBattler2, battler2, AI_DATA->abilities[battler2], AI_DATA->holdEffects[battler2], AI_DATA->speedStats[battler2], prioBattler2);
+        if (CompareTurnOrderKeys(&keyAI, &keyBattler2) == 1)
             return AI_IS_FASTER;
         else
             return AI_IS_SLOWER;
@@ -924,7 +974,7 @@ bool32 CanTargetFaintAi(u32 battlerDef, u32 battlerAtk)
     for (i = 0; i < MAX_MON_MOVES; i++)
     {
         if (moves[i] != MOVE_NONE && moves[i] != MOVE_UNAVAILABLE && !(unusable & gBitTable[i])
-            && AI_DATA->simulatedDmg[battlerDef][battlerAtk][i] >= gBattleMons[battlerAtk].hp)
+            && AI_GetSimulatedDmg(battlerDef, battlerAtk, i) >= gBattleMons[battlerAtk].hp)
         {
             return TRUE;
         }
@@ -962,9 +1012,9 @@ u32 GetBestDmgMoveFromBattler(u32 battlerAtk, u32 battlerDef)
     for (i = 0; i < MAX_MON_MOVES; i++)
     {
         if (moves[i] != MOVE_NONE && moves[i] != MOVE_UNAVAILABLE && !(unusable & gBitTable[i])
-            && bestDmg < AI_DATA->simulatedDmg[battlerAtk][battlerDef][i])
+            && bestDmg < AI_GetSimulatedDmg(battlerAtk, battlerDef, i))
         {
-            bestDmg = AI_DATA->simulatedDmg[battlerAtk][battlerDef][i];
+            bestDmg = AI_GetSimulatedDmg(battlerAtk, battlerDef, i);
             move = moves[i];
         }
     }
@@ -984,7 +1034,7 @@ bool32 CanAIFaintTarget(u32 battlerAtk, u32 battlerDef, u32 numHits)
         if (moves[i] != MOVE_NONE && moves[i] != MOVE_UNAVAILABLE && !(moveLimitations & gBitTable[i]))
         {
             // Use the pre-calculated value in simulatedDmg instead of re-calculating it
-            dmg = AI_DATA->simulatedDmg[battlerAtk][battlerDef][i];
+            dmg = AI_GetSimulatedDmg(battlerAtk, battlerDef, i);
 
             if (numHits)
                 dmg *= numHits;
@@ -1002,7 +1052,7 @@ bool32 CanTargetMoveFaintAi(u32 move, u32 battlerDef, u32 battlerAtk, u32 nHits)
     u32 indexSlot = GetMoveSlot(GetMovesArray(battlerDef), move);
     if (indexSlot < MAX_MON_MOVES)
     {
-        if (GetNoOfHitsToKO(AI_DATA->simulatedDmg[battlerDef][battlerAtk][indexSlot], gBattleMons[battlerAtk].hp) <= nHits)
+        if (GetNoOfHitsToKO(AI_GetSimulatedDmg(battlerDef, battlerAtk, indexSlot), gBattleMons[battlerAtk].hp) <= nHits)
             return TRUE;
     }
     return FALSE;
@@ -1022,7 +1072,7 @@ bool32 CanTargetFaintAiWithMod(u32 battlerDef, u32 battlerAtk, s32 hpMod, s32 dm
 
     for (i = 0; i < MAX_MON_MOVES; i++)
     {
-        dmg = AI_DATA->simulatedDmg[battlerAtk][battlerDef][i];
+        dmg = AI_GetSimulatedDmg(battlerAtk, battlerDef, i);
         if (dmgMod)
             dmg *= dmgMod;
 
@@ -1303,7 +1353,7 @@ bool32 IsMoveEncouragedToHit(u32 battlerAtk, u32 battlerDef, u32 move)
 bool32 ShouldTryOHKO(u32 battlerAtk, u32 battlerDef, u32 atkAbility, u32 defAbility, u32 move)
 {
     u32 holdEffect = AI_DATA->holdEffects[battlerDef];
-    u32 accuracy = AI_DATA->moveAccuracy[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex];
+    u32 accuracy = AI_GetSimulatedAccuracy(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex);
 
     gPotentialItemEffectBattler = battlerDef;
     if (holdEffect == HOLD_EFFECT_FOCUS_BAND && (Random() % 100) < AI_DATA->holdEffectParams[battlerDef])
@@ -1699,7 +1749,7 @@ bool32 ShouldLowerEvasion(u32 battlerAtk, u32 battlerDef, u32 defAbility)
 
 bool32 CanIndexMoveFaintTarget(u32 battlerAtk, u32 battlerDef, u32 index, u32 numHits)
 {
-    s32 dmg = AI_DATA->simulatedDmg[battlerAtk][battlerDef][index];
+    s32 dmg = AI_GetSimulatedDmg(battlerAtk, battlerDef, index);
 
     if (numHits)
         dmg *= numHits;
@@ -1870,7 +1920,7 @@ bool32 HasMoveWithLowAccuracy(u32 battlerAtk, u32 battlerDef, u32 accCheck, bool
               || AI_GetBattlerMoveTargetType(battlerAtk, moves[i]) & (MOVE_TARGET_USER | MOVE_TARGET_OPPONENTS_FIELD))
                 continue;
 
-            if (AI_DATA->moveAccuracy[battlerAtk][battlerDef][i] <= accCheck)
+            if (AI_GetSimulatedAccuracy(battlerAtk, battlerDef, i) <= accCheck)
                 return TRUE;
         }
     }
@@ -1891,7 +1941,7 @@ bool32 HasSleepMoveWithLowAccuracy(u32 battlerAtk, u32 battlerDef)
         if (!(gBitTable[i] & moveLimitations))
         {
             if (gMovesInfo[moves[i]].effect == EFFECT_SLEEP
-              && AI_DATA->moveAccuracy[battlerAtk][battlerDef][i] < 85)
+              && AI_GetSimulatedAccuracy(battlerAtk, battlerDef, i) < 85)
                 return TRUE;
         }
     }
@@ -2648,7 +2698,7 @@ bool32 ShouldPoisonSelf(u32 battler, u32 ability)
 bool32 AI_CanPoison(u32 battlerAtk, u32 battlerDef, u32 defAbility, u32 move, u32 partnerMove)
 {
     if (!AI_CanBePoisoned(battlerAtk, battlerDef, move)
-      || AI_DATA->effectiveness[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex] == AI_EFFECTIVENESS_x0
+      || AI_GetSimulatedEffectiveness(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex) == AI_EFFECTIVENESS_x0
       || DoesSubstituteBlockMove(battlerAtk, battlerDef, move)
       || PartnerMoveEffectIsStatusSameTarget(BATTLE_PARTNER(battlerAtk), battlerDef, partnerMove))
         return FALSE;
@@ -2674,7 +2724,7 @@ static bool32 AI_CanBeParalyzed(u32 battler, u32 ability)
 bool32 AI_CanParalyze(u32 battlerAtk, u32 battlerDef, u32 defAbility, u32 move, u32 partnerMove)
 {
     if (!AI_CanBeParalyzed(battlerDef, defAbility)
-      || AI_DATA->effectiveness[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex] == AI_EFFECTIVENESS_x0
+      || AI_GetSimulatedEffectiveness(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex) == AI_EFFECTIVENESS_x0
       || gSideStatuses[GetBattlerSide(battlerDef)] & SIDE_STATUS_SAFEGUARD
       || DoesSubstituteBlockMove(battlerAtk, battlerDef, move)
       || PartnerMoveEffectIsStatusSameTarget(BATTLE_PARTNER(battlerAtk), battlerDef, partnerMove))
@@ -2749,7 +2799,7 @@ bool32 ShouldBurnSelf(u32 battler, u32 ability)
 bool32 AI_CanBurn(u32 battlerAtk, u32 battlerDef, u32 defAbility, u32 battlerAtkPartner, u32 move, u32 partnerMove)
 {
     if (!AI_CanBeBurned(battlerDef, defAbility)
-      || AI_DATA->effectiveness[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex] == AI_EFFECTIVENESS_x0
+      || AI_GetSimulatedEffectiveness(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex) == AI_EFFECTIVENESS_x0
       || DoesSubstituteBlockMove(battlerAtk, battlerDef, move)
       || PartnerMoveEffectIsStatusSameTarget(battlerAtkPartner, battlerDef, partnerMove))
     {
@@ -2761,7 +2811,7 @@ bool32 AI_CanBurn(u32 battlerAtk, u32 battlerDef, u32 defAbility, u32 battlerAtk
 bool32 AI_CanGiveFrostbite(u32 battlerAtk, u32 battlerDef, u32 defAbility, u32 battlerAtkPartner, u32 move, u32 partnerMove)
 {
     if (!AI_CanGetFrostbite(battlerDef, defAbility)
-      || AI_DATA->effectiveness[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex] == AI_EFFECTIVENESS_x0
+      || AI_GetSimulatedEffectiveness(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex) == AI_EFFECTIVENESS_x0
       || DoesSubstituteBlockMove(battlerAtk, battlerDef, move)
       || PartnerMoveEffectIsStatusSameTarget(battlerAtkPartner, battlerDef, partnerMove))
     {
@@ -2773,7 +2823,7 @@ bool32 AI_CanGiveFrostbite(u32 battlerAtk, u32 battlerDef, u32 defAbility, u32 b
 bool32 AI_CanBeInfatuated(u32 battlerAtk, u32 battlerDef, u32 defAbility)
 {
     if ((gBattleMons[battlerDef].status2 & STATUS2_INFATUATION)
-      || AI_DATA->effectiveness[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex] == AI_EFFECTIVENESS_x0
+      || AI_GetSimulatedEffectiveness(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex) == AI_EFFECTIVENESS_x0
       || defAbility == ABILITY_OBLIVIOUS
       || !AreBattlersOfOppositeGender(battlerAtk, battlerDef)
       || AI_IsAbilityOnSide(battlerDef, ABILITY_AROMA_VEIL))
@@ -2942,7 +2992,7 @@ bool32 ShouldRecover(u32 battlerAtk, u32 battlerDef, u32 move, u32 healPercent)
     if (move == 0xFFFF || AI_WhoStrikesFirst(battlerAtk, battlerDef, move) == AI_IS_FASTER)
     {
         // using item or user going first
-        s32 damage = AI_DATA->simulatedDmg[battlerAtk][battlerDef][AI_THINKING_STRUCT->movesetIndex];
+        s32 damage = AI_GetSimulatedDmg(battlerAtk, battlerDef, AI_THINKING_STRUCT->movesetIndex);
         s32 healAmount = (healPercent * damage) / 100;
         if (gStatuses3[battlerAtk] & STATUS3_HEAL_BLOCK)
             healAmount = 0;
@@ -3194,6 +3244,7 @@ struct BattlePokemon *AllocSaveBattleMons(void)
 void FreeRestoreBattleMons(struct BattlePokemon *savedBattleMons)
 {
     memcpy(gBattleMons, savedBattleMons, SIZE_G_BATTLE_MONS);
+    InvalidateBattlerAbilityCache();
     Free(savedBattleMons);
 }
 
@@ -3207,8 +3258,11 @@ s32 AI_CalcPartyMonDamage(u32 move, u32 battlerAtk, u32 battlerDef, struct Battl
         gBattleMons[battlerAtk] = switchinCandidate;
     else
         gBattleMons[battlerDef] = switchinCandidate;
+    InvalidateBattlerAbilityCache();
+    AI_InvalidateDamageContexts();
     dmg = AI_CalcDamage(move, battlerAtk, battlerDef, &effectiveness, FALSE, AI_GetWeather(AI_DATA));
     FreeRestoreBattleMons(savedBattleMons);
+    AI_InvalidateDamageContexts();
     return dmg;
 }
 
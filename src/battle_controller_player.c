@@ -1511,7 +1511,7 @@ static void Task_GiveExpWithExpBar(u8 taskId)
     u16 species;
     s32 currExp, expOnNextLvl, newExpPoints;
 
-    if (gTasks[taskId].tExpTask_frames < 13)
+    if (gTasks[taskId].tExpTask_frames < 13 && !gTestRunnerHeadless)
     {
         gTasks[taskId].tExpTask_frames++;
     }
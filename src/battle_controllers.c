@@ -2290,7 +2290,7 @@ void Controller_WaitForString(u32 battler)
 
 static void Controller_WaitForPartyStatusSummary(u32 battler)
 {
-    if (gBattleSpritesDataPtr->healthBoxesData[battler].partyStatusDelayTimer++ > 92)
+    if (gBattleSpritesDataPtr->healthBoxesData[battler].partyStatusDelayTimer++ > 92 || gTestRunnerHeadless)
     {
         gBattleSpritesDataPtr->healthBoxesData[battler].partyStatusDelayTimer = 0;
         BattleControllerComplete(battler);
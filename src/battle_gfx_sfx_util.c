@@ -22,6 +22,7 @@
 #include "data.h"
 #include "palette.h"
 #include "contest.h"
+#include "test_runner.h"
 #include "constants/songs.h"
 #include "constants/rgb.h"
 #include "constants/battle_palace.h"
@@ -551,7 +552,8 @@ bool8 IsBattleSEPlaying(u8 battler)
 {
     u8 zero = 0;
 
-    if (IsSEPlaying())
+    // Headless test runs don't wait for sound effects to finish.
+    if (IsSEPlaying() && !gTestRunnerHeadless)
     {
         gBattleSpritesDataPtr->healthBoxesData[battler].soundTimer++;
         if (gBattleSpritesDataPtr->healthBoxesData[battler].soundTimer < 30)
@@ -2038,13 +2038,35 @@ static void CB2_HandleStartMultiBattle(void)
     }
 }
 
-void BattleMainCB2(void)
+// Headless test runs have nothing to show, so they step the battle this many
+// times per VBlank. Graphics and sound only catch up on the real frames.
+#define HEADLESS_FRAMES_PER_VBLANK 4
+
+static void RunBattleMainFrame(void)
 {
     AnimateSprites();
     BuildOamBuffer();
     RunTextPrinters();
     UpdatePaletteFade();
     RunTasks();
+}
+
+void BattleMainCB2(void)
+{
+    u32 i;
+
+    RunBattleMainFrame();
+
+    if (gTestRunnerHeadless)
+    {
+        for (i = 1; i < HEADLESS_FRAMES_PER_VBLANK; i++)
+        {
+            if (gMain.callback1 != BattleMainCB1 || gMain.callback2 != BattleMainCB2)
+                break;
+            BattleMainCB1();
+            RunBattleMainFrame();
+        }
+    }
 
     if (JOY_HELD(B_BUTTON) && gBattleTypeFlags & BATTLE_TYPE_RECORDED && RecordedBattle_CanStopPlayback())
     {
@@ -3245,6 +3267,7 @@ static void BattleMainCB1(void)
 {
     u32 battler;
 
+    InvalidateBattlerAbilityCache();
     gBattleMainFunc();
     for (battler = 0; battler < gBattlersCount; battler++)
         gBattlerControllerFuncs[battler](battler);
@@ -3301,6 +3324,7 @@ static void BattleStartClearSetData(void)
         gBattleStruct->skyDropTargets[i] = 0xFF;
         gBattleStruct->overwrittenAbilities[i] = ABILITY_NONE;
     }
+    InvalidateBattlerAbilityCache();
 
     gLastUsedMove = 0;
     gFieldStatuses = 0;
@@ -3522,6 +3546,7 @@ void SwitchInClearSetData(u32 battler)
     }
     #endif // TESTING
 
+    InvalidateBattlerAbilityCache();
     Ai_UpdateSwitchInData(battler);
 }
 
@@ -3537,6 +3562,7 @@ const u8* FaintClearSetData(u32 battler)
     gBattleMons[battler].status2 = 0;
     gStatuses3[battler] &= STATUS3_GASTRO_ACID; // Edge case: Keep Gastro Acid if pokemon's ability can have effect after fainting, for example Innards Out.
     gStatuses4[battler] = 0;
+    InvalidateBattlerAbilityCache();
 
     for (i = 0; i < gBattlersCount; i++)
     {
@@ -3723,6 +3749,7 @@ static void DoBattleIntro(void)
             if ((gBattleTypeFlags & BATTLE_TYPE_SAFARI) && GetBattlerSide(battler) == B_SIDE_PLAYER)
             {
                 memset(&gBattleMons[battler], 0, sizeof(struct BattlePokemon));
+                InvalidateBattlerAbilityCache();
             }
             else
             {
@@ -3731,6 +3758,7 @@ static void DoBattleIntro(void)
                 gBattleMons[battler].type2 = gSpeciesInfo[gBattleMons[battler].species].types[1];
                 gBattleMons[battler].type3 = TYPE_MYSTERY;
                 gBattleMons[battler].ability = GetAbilityBySpecies(gBattleMons[battler].species, gBattleMons[battler].abilityNum);
+                InvalidateBattlerAbilityCache();
                 gBattleStruct->hpOnSwitchout[GetBattlerSide(battler)] = gBattleMons[battler].hp;
                 gBattleMons[battler].status2 = 0;
                 for (i = 0; i < NUM_BATTLE_STATS; i++)
@@ -4050,18 +4078,22 @@ static void TryDoEventsBeforeFirstTurn(void)
             if (TestRunner_Battle_GetForcedAbility(side, partyIndex))
                 gBattleMons[i].ability = gBattleStruct->overwrittenAbilities[i] = TestRunner_Battle_GetForcedAbility(side, partyIndex);
         }
+        InvalidateBattlerAbilityCache();
     }
     #endif // TESTING
 
     if (gBattleStruct->switchInAbilitiesCounter == 0)
     {
+        struct TurnOrderKeys keys;
+
+        ClearTurnOrderKeys(&keys, TRUE);
         for (i = 0; i < gBattlersCount; i++)
             gBattlerByTurnOrder[i] = i;
         for (i = 0; i < gBattlersCount - 1; i++)
         {
             for (j = i + 1; j < gBattlersCount; j++)
             {
-                if (GetWhichBattlerFaster(gBattlerByTurnOrder[i], gBattlerByTurnOrder[j], TRUE) == -1)
+                if (GetWhichBattlerFasterWithKeys(&keys, gBattlerByTurnOrder[i], gBattlerByTurnOrder[j]) == -1)
                     SwapTurnOrder(i, j);
             }
         }
@@ -4169,6 +4201,9 @@ static void TryDoEventsBeforeFirstTurn(void)
 
     if ((i = ShouldDoTrainerSlide(GetBattlerAtPosition(B_POSITION_OPPONENT_LEFT), TRAINER_SLIDE_BEFORE_FIRST_TURN)))
         BattleScriptExecute(i == 1 ? BattleScript_TrainerASlideMsgEnd2 : BattleScript_TrainerBSlideMsgEnd2);
+
+    if (gTestRunnerEnabled)
+        TestRunner_Battle_BeforeFirstTurn();
 }
 
 static void HandleEndTurn_ContinueBattle(void)
@@ -4823,7 +4858,7 @@ static void HandleTurnActionSelectionState(void)
                 gBattlescriptCurrInstr = gSelectionBattleScripts[battler];
                 if (!(gBattleControllerExecFlags & ((gBitTable[battler]) | (0xF << 28) | (gBitTable[battler] << 4) | (gBitTable[battler] << 8) | (gBitTable[battler] << 12))))
                 {
-                    gBattleScriptingCommandsTable[gBattlescriptCurrInstr[0]]();
+                    DispatchBattleScriptCommand();
                 }
                 gSelectionBattleScripts[battler] = gBattlescriptCurrInstr;
             }
@@ -4855,7 +4890,7 @@ static void HandleTurnActionSelectionState(void)
                 gBattlescriptCurrInstr = gSelectionBattleScripts[battler];
                 if (!(gBattleControllerExecFlags & ((gBitTable[battler]) | (0xF << 28) | (gBitTable[battler] << 4) | (gBitTable[battler] << 8) | (gBitTable[battler] << 12))))
                 {
-                    gBattleScriptingCommandsTable[gBattlescriptCurrInstr[0]]();
+                    DispatchBattleScriptCommand();
                 }
                 gSelectionBattleScripts[battler] = gBattlescriptCurrInstr;
             }
@@ -5062,99 +5097,115 @@ s8 GetMovePriority(u32 battler, u16 move)
     return priority;
 }
 
-// Function for AI with variables provided as arguments to speed the computation time
-s32 GetWhichBattlerFasterArgs(u32 battler1, u32 battler2, bool32 ignoreChosenMoves, u32 ability1, u32 ability2,
-                              u32 holdEffectBattler1, u32 holdEffectBattler2, u32 speedBattler1, u32 speedBattler2, s32 priority1, s32 priority2)
-{
-    u32 strikesFirst = 0;
-
-    if (priority1 == priority2)
-    {
-        // QUICK CLAW / CUSTAP - always first
-        // LAGGING TAIL - always last
-        // STALL - always last
-
-        if (gProtectStructs[battler1].quickDraw && !gProtectStructs[battler2].quickDraw)
-            strikesFirst = 1;
-        else if (!gProtectStructs[battler1].quickDraw && gProtectStructs[battler2].quickDraw)
-            strikesFirst = -1;
-        else if (gProtectStructs[battler1].usedCustapBerry && !gProtectStructs[battler2].usedCustapBerry)
-            strikesFirst = 1;
-        else if (gProtectStructs[battler2].usedCustapBerry && !gProtectStructs[battler1].usedCustapBerry)
-            strikesFirst = -1;
-        else if (holdEffectBattler1 == HOLD_EFFECT_LAGGING_TAIL && holdEffectBattler2 != HOLD_EFFECT_LAGGING_TAIL)
-            strikesFirst = -1;
-        else if (holdEffectBattler2 == HOLD_EFFECT_LAGGING_TAIL && holdEffectBattler1 != HOLD_EFFECT_LAGGING_TAIL)
-            strikesFirst = 1;
-        else if (ability1 == ABILITY_STALL && ability2 != ABILITY_STALL)
-            strikesFirst = -1;
-        else if (ability2 == ABILITY_STALL && ability1 != ABILITY_STALL)
-            strikesFirst = 1;
-        else if (ability1 == ABILITY_MYCELIUM_MIGHT && ability2 != ABILITY_MYCELIUM_MIGHT && IS_MOVE_STATUS(gChosenMoveByBattler[battler1]))
-            strikesFirst = -1;
-        else if (ability2 == ABILITY_MYCELIUM_MIGHT && ability1 != ABILITY_MYCELIUM_MIGHT && IS_MOVE_STATUS(gChosenMoveByBattler[battler2]))
-            strikesFirst = 1;
-        else
-        {
-            if (speedBattler1 == speedBattler2 && Random() & 1)
-            {
-                strikesFirst = 0; // same speeds, same priorities
-            }
-            else if (speedBattler1 < speedBattler2)
-            {
-                // battler2 has more speed
-                if (gFieldStatuses & STATUS_FIELD_TRICK_ROOM)
-                    strikesFirst = 1;
-                else
-                    strikesFirst = -1;
-            }
-            else
-            {
-                // battler1 has more speed
-                if (gFieldStatuses & STATUS_FIELD_TRICK_ROOM)
-                    strikesFirst = -1;
-                else
-                    strikesFirst = 1;
-            }
-        }
-    }
-    else if (priority1 < priority2)
+// Quick Draw, Quick Claw and Custap Berry move first, Lagging Tail and Stall move last, in that order of precedence.
+static u32 GetTurnOrderTier(u32 battler, u32 ability, u32 holdEffect)
+{
+    u32 tier = 0;
+
+    if (gProtectStructs[battler].quickDraw)
+        tier |= 1 << 3;
+    if (gProtectStructs[battler].usedCustapBerry)
+        tier |= 1 << 2;
+    if (holdEffect != HOLD_EFFECT_LAGGING_TAIL)
+        tier |= 1 << 1;
+    if (ability != ABILITY_STALL)
+        tier |= 1 << 0;
+    return tier;
+}
+
+// The ability, hold effect and speed are passed in so that the AI can use the ones it assumes.
+void InitTurnOrderKey(struct TurnOrderKey *key, u32 battler, u32 ability, u32 holdEffect, u32 speed, s32 priority)
+{
+    key->speed = speed;
+    key->priority = priority;
+    key->tier = GetTurnOrderTier(battler, ability, holdEffect);
+    key->myceliumMight = (ability == ABILITY_MYCELIUM_MIGHT);
+    key->statusMove = IS_MOVE_STATUS(gChosenMoveByBattler[battler]);
+}
+
+s32 CompareTurnOrderKeys(const struct TurnOrderKey *key1, const struct TurnOrderKey *key2)
+{
+    if (key1->priority < key2->priority)
+        return -1; // battler2's move has greater priority
+    if (key1->priority > key2->priority)
+        return 1; // battler1's move has greater priority
+
+    if (key1->tier < key2->tier)
+        return -1;
+    if (key1->tier > key2->tier)
+        return 1;
+
+    if (key1->myceliumMight && !key2->myceliumMight && key1->statusMove)
+        return -1;
+    if (key2->myceliumMight && !key1->myceliumMight && key2->statusMove)
+        return 1;
+
+    if (key1->speed == key2->speed && Random() & 1)
+        return 0; // same speeds, same priorities
+
+    if (key1->speed < key2->speed)
     {
-        strikesFirst = -1; // battler2's move has greater priority
+        // battler2 has more speed
+        if (gFieldStatuses & STATUS_FIELD_TRICK_ROOM)
+            return 1;
+        else
+            return -1;
     }
     else
     {
-        strikesFirst = 1; // battler1's move has greater priority
+        // battler1 has more speed
+        if (gFieldStatuses & STATUS_FIELD_TRICK_ROOM)
+            return -1;
+        else
+            return 1;
     }
-    return strikesFirst;
 }
 
-s32 GetWhichBattlerFaster(u32 battler1, u32 battler2, bool32 ignoreChosenMoves)
+void ClearTurnOrderKeys(struct TurnOrderKeys *keys, bool32 ignoreChosenMoves)
 {
-    s32 priority1 = 0, priority2 = 0;
-    u32 ability1 = GetBattlerAbility(battler1);
-    u32 speedBattler1 = GetBattlerTotalSpeedStat(battler1);
-    u32 holdEffectBattler1 = GetBattlerHoldEffect(battler1, TRUE);
-    u32 speedBattler2 = GetBattlerTotalSpeedStat(battler2);
-    u32 holdEffectBattler2 = GetBattlerHoldEffect(battler2, TRUE);
-    u32 ability2 = GetBattlerAbility(battler2);
+    keys->computed = 0;
+    keys->ignoreChosenMoves = ignoreChosenMoves;
+}
 
-    if (!ignoreChosenMoves)
+static const struct TurnOrderKey *GetTurnOrderKey(struct TurnOrderKeys *keys, u32 battler)
+{
+    if (!(keys->computed & gBitTable[battler]))
     {
-        if (gChosenActionByBattler[battler1] == B_ACTION_USE_MOVE)
-            priority1 = GetChosenMovePriority(battler1);
-        if (gChosenActionByBattler[battler2] == B_ACTION_USE_MOVE)
-            priority2 = GetChosenMovePriority(battler2);
+        u32 ability = GetBattlerAbility(battler);
+        u32 holdEffect = GetBattlerHoldEffect(battler, TRUE);
+        s32 priority = 0;
+
+        if (!keys->ignoreChosenMoves && gChosenActionByBattler[battler] == B_ACTION_USE_MOVE)
+            priority = GetChosenMovePriority(battler);
+        InitTurnOrderKey(&keys->keys[battler], battler, ability, holdEffect, GetBattlerTotalSpeedStatArgs(battler, ability, holdEffect), priority);
+        keys->computed |= gBitTable[battler];
     }
+    return &keys->keys[battler];
+}
 
-    return GetWhichBattlerFasterArgs(battler1, battler2, ignoreChosenMoves, ability1, ability2,
-                                     holdEffectBattler1, holdEffectBattler2, speedBattler1, speedBattler2, priority1, priority2);
+// Same as GetWhichBattlerFaster, but each battler's key is only worked out the first time it's compared.
+// Random ties are still broken per comparison, so sorting uses the same random numbers as before.
+s32 GetWhichBattlerFasterWithKeys(struct TurnOrderKeys *keys, u32 battler1, u32 battler2)
+{
+    const struct TurnOrderKey *key1 = GetTurnOrderKey(keys, battler1);
+    const struct TurnOrderKey *key2 = GetTurnOrderKey(keys, battler2);
+
+    return CompareTurnOrderKeys(key1, key2);
+}
+
+s32 GetWhichBattlerFaster(u32 battler1, u32 battler2, bool32 ignoreChosenMoves)
+{
+    struct TurnOrderKeys keys;
+
+    ClearTurnOrderKeys(&keys, ignoreChosenMoves);
+    return GetWhichBattlerFasterWithKeys(&keys, battler1, battler2);
 }
 
 static void SetActionsAndBattlersTurnOrder(void)
 {
     s32 turnOrderId = 0;
     s32 i, j, battler;
+    struct TurnOrderKeys keys;
 
     if (gBattleTypeFlags & BATTLE_TYPE_SAFARI)
     {
@@ -5233,6 +5284,9 @@ static void SetActionsAndBattlersTurnOrder(void)
                     turnOrderId++;
                 }
             }
+            // A battler's key is worked out on its first comparison, after
+            // TryChangingTurnOrderEffects has set its Quick Claw and Quick Draw flags.
+            ClearTurnOrderKeys(&keys, FALSE);
             for (i = 0; i < gBattlersCount - 1; i++)
             {
                 for (j = i + 1; j < gBattlersCount; j++)
@@ -5247,7 +5301,7 @@ static void SetActionsAndBattlersTurnOrder(void)
                         && gActionsByTurnOrder[i] != B_ACTION_THROW_BALL
                         && gActionsByTurnOrder[j] != B_ACTION_THROW_BALL)
                     {
-                        if (GetWhichBattlerFaster(battler1, battler2, FALSE) == -1)
+                        if (GetWhichBattlerFasterWithKeys(&keys, battler1, battler2) == -1)
                             SwapTurnOrder(i, j);
                     }
                 }
@@ -5410,6 +5464,9 @@ static bool32 TryDoMoveEffectsBeforeMoves(void)
 static void TryChangeTurnOrder(void)
 {
     u32 i, j;
+    struct TurnOrderKeys keys;
+
+    ClearTurnOrderKeys(&keys, FALSE);
     for (i = 0; i < gBattlersCount - 1; i++)
     {
         for (j = i + 1; j < gBattlersCount; j++)
@@ -5420,7 +5477,7 @@ static void TryChangeTurnOrder(void)
             if (gActionsByTurnOrder[i] == B_ACTION_USE_MOVE
                 && gActionsByTurnOrder[j] == B_ACTION_USE_MOVE)
             {
-                if (GetWhichBattlerFaster(battler1, battler2, FALSE) == -1)
+                if (GetWhichBattlerFasterWithKeys(&keys, battler1, battler2) == -1)
                     SwapTurnOrder(i, j);
             }
         }
@@ -5738,6 +5795,7 @@ static void HandleEndTurn_FinishBattle(void)
         }
 
         RecordedBattle_SetPlaybackFinished();
+        PrintBattleScriptProfile();
         if (gTestRunnerEnabled)
             TestRunner_Battle_AfterLastTurn();
         BeginFastPaletteFade(3);
@@ -5784,7 +5842,7 @@ static void HandleEndTurn_FinishBattle(void)
     else
     {
         if (gBattleControllerExecFlags == 0)
-            gBattleScriptingCommandsTable[gBattlescriptCurrInstr[0]]();
+            DispatchBattleScriptCommand();
     }
 }
 
@@ -5923,14 +5981,14 @@ void RunBattleScriptCommands_PopCallbacksStack(void)
     else
     {
         if (gBattleControllerExecFlags == 0)
-            gBattleScriptingCommandsTable[gBattlescriptCurrInstr[0]]();
+            DispatchBattleScriptCommand();
     }
 }
 
 void RunBattleScriptCommands(void)
 {
     if (gBattleControllerExecFlags == 0)
-        gBattleScriptingCommandsTable[gBattlescriptCurrInstr[0]]();
+        DispatchBattleScriptCommand();
 }
 
 void SetTypeBeforeUsingMove(u32 move, u32 battlerAtk)
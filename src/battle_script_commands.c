@@ -1185,6 +1185,147 @@ static const u8 sBattlePalaceNatureToFlavorTextId[NUM_NATURES] =
     [NATURE_QUIRKY]  = B_MSG_EAGER_FOR_MORE,
 };
 
+// Commands which only read the battle state and move gBattlescriptCurrInstr.
+// They never wait for a controller or change what the battle main loop does
+// next, so DispatchBattleScriptCommand runs them back to back instead of
+// spending a frame on each. Taken from the most common commands in the
+// battle scripts; DEBUG_BATTLE_SCRIPT_PROFILE shows which ones are hot.
+// They're listed by handler so that the list follows the commands if
+// gBattleScriptingCommandsTable changes, and their opcodes are looked up
+// the first time a command is dispatched.
+static void (*const sChainableBattleScriptCommands[])(void) =
+{
+    Cmd_jumpifstatus,
+    Cmd_jumpifstatus2,
+    Cmd_jumpifability,
+    Cmd_jumpifsideaffecting,
+    Cmd_jumpifstat,
+    Cmd_jumpifstatus3condition,
+    Cmd_goto,
+    Cmd_jumpifbyte,
+    Cmd_jumpifhalfword,
+    Cmd_jumpifword,
+    Cmd_return,
+    Cmd_call,
+    Cmd_jumpifsubstituteblocks,
+};
+
+static EWRAM_DATA u32 sChainableBattleScriptOpcodes[(ARRAY_COUNT(gBattleScriptingCommandsTable) + 31) / 32] = {0};
+static EWRAM_DATA bool8 sChainableBattleScriptOpcodesFound = FALSE;
+
+static void FindChainableBattleScriptOpcodes(void)
+{
+    u32 opcode, i;
+
+    for (opcode = 0; opcode < ARRAY_COUNT(gBattleScriptingCommandsTable); opcode++)
+    {
+        for (i = 0; i < ARRAY_COUNT(sChainableBattleScriptCommands); i++)
+        {
+            if (gBattleScriptingCommandsTable[opcode] == sChainableBattleScriptCommands[i])
+                sChainableBattleScriptOpcodes[opcode / 32] |= 1u << (opcode % 32);
+        }
+    }
+    sChainableBattleScriptOpcodesFound = TRUE;
+}
+
+static inline bool32 IsBattleScriptCommandChainable(u32 opcode)
+{
+    return sChainableBattleScriptOpcodes[opcode / 32] & (1u << (opcode % 32));
+}
+
+#define MAX_CHAINED_BATTLE_SCRIPT_COMMANDS 32
+
+#if DEBUG_BATTLE_SCRIPT_PROFILE
+#define BATTLE_SCRIPT_PROFILE_BAR_WIDTH 32
+
+struct BattleScriptProfile
+{
+    u32 calls[ARRAY_COUNT(gBattleScriptingCommandsTable)];
+    u32 ticks[ARRAY_COUNT(gBattleScriptingCommandsTable)]; // In units of 64 cycles.
+};
+
+static EWRAM_DATA struct BattleScriptProfile sBattleScriptProfile = {0};
+
+static void RunProfiledBattleScriptCommand(u32 opcode)
+{
+    // Link battles use timer 3 for the serial connection.
+    if (gBattleTypeFlags & BATTLE_TYPE_LINK)
+    {
+        gBattleScriptingCommandsTable[opcode]();
+        return;
+    }
+
+    REG_TM3CNT_H = 0;
+    REG_TM3CNT = (TIMER_ENABLE | TIMER_64CLK) << 16;
+    gBattleScriptingCommandsTable[opcode]();
+    REG_TM3CNT_H = 0;
+    sBattleScriptProfile.calls[opcode]++;
+    sBattleScriptProfile.ticks[opcode] += REG_TM3CNT_L;
+}
+#endif // DEBUG_BATTLE_SCRIPT_PROFILE
+
+static inline void RunBattleScriptCommand(u32 opcode)
+{
+#if DEBUG_BATTLE_SCRIPT_PROFILE
+    RunProfiledBattleScriptCommand(opcode);
+#else
+    gBattleScriptingCommandsTable[opcode]();
+#endif
+}
+
+// Runs the command at gBattlescriptCurrInstr, followed by any chainable
+// commands after it if it was chainable too.
+void DispatchBattleScriptCommand(void)
+{
+    u32 opcode, chained = 0;
+
+    if (!sChainableBattleScriptOpcodesFound)
+        FindChainableBattleScriptOpcodes();
+
+    do
+    {
+        opcode = gBattlescriptCurrInstr[0];
+        RunBattleScriptCommand(opcode);
+    } while (IsBattleScriptCommandChainable(opcode)
+          && IsBattleScriptCommandChainable(gBattlescriptCurrInstr[0])
+          && gBattleControllerExecFlags == 0
+          && ++chained < MAX_CHAINED_BATTLE_SCRIPT_COMMANDS);
+}
+
+// Prints how often each command ran since the last call and how long it took,
+// most expensive first, then clears the counts.
+void PrintBattleScriptProfile(void)
+{
+#if DEBUG_BATTLE_SCRIPT_PROFILE
+    u8 order[ARRAY_COUNT(gBattleScriptingCommandsTable)];
+    char bar[BATTLE_SCRIPT_PROFILE_BAR_WIDTH + 1];
+    u32 i, j, count = 0, totalTicks = 0;
+
+    for (i = 0; i < ARRAY_COUNT(gBattleScriptingCommandsTable); i++)
+    {
+        if (sBattleScriptProfile.calls[i] == 0)
+            continue;
+        totalTicks += sBattleScriptProfile.ticks[i];
+        for (j = count++; j > 0 && sBattleScriptProfile.ticks[order[j - 1]] < sBattleScriptProfile.ticks[i]; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    DebugPrintf("battle script profile: %d commands, %d ticks of 64 cycles", count, totalTicks);
+    for (i = 0; i < count; i++)
+    {
+        u32 opcode = order[i];
+        u32 width = totalTicks != 0 ? sBattleScriptProfile.ticks[opcode] * BATTLE_SCRIPT_PROFILE_BAR_WIDTH / totalTicks : 0;
+
+        for (j = 0; j < width; j++)
+            bar[j] = '#';
+        bar[j] = '\0';
+        DebugPrintf("0x%x: %d calls, %d ticks %s", opcode, sBattleScriptProfile.calls[opcode], sBattleScriptProfile.ticks[opcode], bar);
+    }
+    memset(&sBattleScriptProfile, 0, sizeof(sBattleScriptProfile));
+#endif // DEBUG_BATTLE_SCRIPT_PROFILE
+}
+
 static bool32 NoTargetPresent(u8 battler, u32 move)
 {
     if (!IsBattlerAlive(gBattlerTarget))
@@ -4549,6 +4690,7 @@ static void Cmd_getexp(void)
             gBattleStruct->teamGotExpMsgPrinted = FALSE;
             gBattleMons[gBattlerFainted].item = ITEM_NONE;
             gBattleMons[gBattlerFainted].ability = ABILITY_NONE;
+            InvalidateBattlerAbilityCache();
             gBattlescriptCurrInstr = cmd->nextInstr;
         }
         break;
@@ -6432,6 +6574,7 @@ static void Cmd_switchindataupdate(void)
     gBattleMons[battler].type2 = gSpeciesInfo[gBattleMons[battler].species].types[1];
     gBattleMons[battler].type3 = TYPE_MYSTERY;
     gBattleMons[battler].ability = GetAbilityBySpecies(gBattleMons[battler].species, gBattleMons[battler].abilityNum);
+    InvalidateBattlerAbilityCache();
 
     // check knocked off item
     i = GetBattlerSide(battler);
@@ -8922,6 +9065,7 @@ static void Cmd_various(void)
     {
         VARIOUS_ARGS();
         gBattleMons[battler].ability = gBattleStruct->overwrittenAbilities[battler] = gBattleStruct->tracedAbility[battler];
+        InvalidateBattlerAbilityCache();
         break;
     }
     case VARIOUS_TRY_ILLUSION_OFF:
@@ -9546,6 +9690,7 @@ static void Cmd_various(void)
                 gSpecialStatuses[gBattlerTarget].neutralizingGasRemoved = TRUE;
 
             gBattleMons[gBattlerTarget].ability = gBattleStruct->overwrittenAbilities[gBattlerTarget] = ABILITY_SIMPLE;
+            InvalidateBattlerAbilityCache();
             gBattlescriptCurrInstr = cmd->nextInstr;
         }
         return;
@@ -9574,6 +9719,7 @@ static void Cmd_various(void)
             else
             {
                 gBattleMons[gBattlerTarget].ability = gBattleStruct->overwrittenAbilities[gBattlerTarget] = gBattleMons[gBattlerAttacker].ability;
+                InvalidateBattlerAbilityCache();
                 gBattlescriptCurrInstr = cmd->nextInstr;
             }
         }
@@ -12515,6 +12661,7 @@ static void Cmd_transformdataexecution(void)
 
         for (i = 0; i < offsetof(struct BattlePokemon, pp); i++)
             battleMonAttacker[i] = battleMonTarget[i];
+        InvalidateBattlerAbilityCache();
 
         gBattleStruct->overwrittenAbilities[gBattlerAttacker] = GetBattlerAbility(gBattlerTarget);
         for (i = 0; i < MAX_MON_MOVES; i++)
@@ -14159,6 +14306,7 @@ static void Cmd_trycopyability(void)
     {
         gBattleScripting.abilityPopupOverwrite = gBattleMons[battler].ability;
         gBattleMons[battler].ability = gBattleStruct->overwrittenAbilities[battler] = defAbility;
+        InvalidateBattlerAbilityCache();
         gLastUsedAbility = defAbility;
         gBattlescriptCurrInstr = cmd->nextInstr;
     }
@@ -14237,6 +14385,7 @@ static void Cmd_setgastroacid(void)
             gSpecialStatuses[gBattlerTarget].neutralizingGasRemoved = TRUE;
 
         gStatuses3[gBattlerTarget] |= STATUS3_GASTRO_ACID;
+        InvalidateBattlerAbilityCache();
         gBattlescriptCurrInstr = cmd->nextInstr;
     }
 }
@@ -14349,6 +14498,7 @@ static void Cmd_tryswapabilities(void)
             u16 abilityAtk = gBattleMons[gBattlerAttacker].ability;
             gBattleMons[gBattlerAttacker].ability = gBattleStruct->overwrittenAbilities[gBattlerAttacker] = gBattleMons[gBattlerTarget].ability;
             gBattleMons[gBattlerTarget].ability = gBattleStruct->overwrittenAbilities[gBattlerTarget] = abilityAtk;
+            InvalidateBattlerAbilityCache();
 
             gBattlescriptCurrInstr = cmd->nextInstr;
         }
@@ -14533,6 +14683,7 @@ static void Cmd_switchoutabilities(void)
     if (gBattleMons[battler].ability == ABILITY_NEUTRALIZING_GAS)
     {
         gBattleMons[battler].ability = ABILITY_NONE;
+        InvalidateBattlerAbilityCache();
         BattleScriptPush(gBattlescriptCurrInstr);
         gBattlescriptCurrInstr = BattleScript_NeutralizingGasExits;
     }
@@ -15622,6 +15773,7 @@ static void Cmd_tryworryseed(void)
     else
     {
         gBattleMons[gBattlerTarget].ability = gBattleStruct->overwrittenAbilities[gBattlerTarget] = ABILITY_INSOMNIA;
+        InvalidateBattlerAbilityCache();
         gBattlescriptCurrInstr = cmd->nextInstr;
     }
 }
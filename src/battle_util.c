@@ -47,6 +47,9 @@
 #include "constants/trainers.h"
 #include "constants/weather.h"
 #include "constants/pokemon.h"
+#if DEBUG_ABILITY_CACHE_CHECK && TESTING
+#include "test/test.h"
+#endif
 
 /*
 NOTE: The data and functions in this file up until (but not including) sSoundMovesTable
@@ -61,6 +64,7 @@ static u32 GetFlingPowerFromItemId(u32 itemId);
 static void SetRandomMultiHitCounter();
 static u32 GetBattlerItemHoldEffectParam(u32 battler, u32 item);
 static bool32 CanBeInfinitelyConfused(u32 battler);
+static bool32 CouldAbilityBeOnField(u32 ability);
 
 extern const u8 *const gBattlescriptsForRunningByItem[];
 extern const u8 *const gBattlescriptsForUsingItem[];
@@ -735,6 +739,10 @@ void HandleAction_ActionFinished(void)
 
     if (B_RECALC_TURN_AFTER_ACTIONS >= GEN_8 && !afterYouActive && !gBattleStruct->pledgeMove)
     {
+        struct TurnOrderKeys moveKeys, switchKeys;
+
+        ClearTurnOrderKeys(&moveKeys, FALSE);
+        ClearTurnOrderKeys(&switchKeys, TRUE);
         // i starts at `gCurrentTurnActionNumber` because we don't want to recalculate turn order for mon that have already
         // taken action. It's been previously increased, which we want in order to not recalculate the turn of the mon that just finished its action
         for (i = gCurrentTurnActionNumber; i < gBattlersCount - 1; i++)
@@ -752,12 +760,12 @@ void HandleAction_ActionFinished(void)
                 // have been executed before. The only recalculation needed is for moves/switch. Mega evolution is handled in src/battle_main.c/TryChangeOrder
                 if((gActionsByTurnOrder[i] == B_ACTION_USE_MOVE && gActionsByTurnOrder[j] == B_ACTION_USE_MOVE))
                 {
-                    if (GetWhichBattlerFaster(battler1, battler2, FALSE) == -1)
+                    if (GetWhichBattlerFasterWithKeys(&moveKeys, battler1, battler2) == -1)
                         SwapTurnOrder(i, j);
                 }
                 else if ((gActionsByTurnOrder[i] == B_ACTION_SWITCH && gActionsByTurnOrder[j] == B_ACTION_SWITCH))
                 {
-                    if (GetWhichBattlerFaster(battler1, battler2, TRUE) == -1) // If the actions chosen are switching, we recalc order but ignoring the moves
+                    if (GetWhichBattlerFasterWithKeys(&switchKeys, battler1, battler2) == -1) // If the actions chosen are switching, we recalc order but ignoring the moves
                         SwapTurnOrder(i, j);
                 }
             }
@@ -931,6 +939,8 @@ static const uq4_12_t sTypeEffectivenessTable[NUMBER_OF_MON_TYPES][NUMBER_OF_MON
 #undef ______
 #undef X
 
+#include "data/type_effectiveness.h"
+
 // code
 u8 GetBattlerForBattleScript(u8 caseId)
 {
@@ -1729,10 +1739,12 @@ u8 DoFieldEndTurnEffects(void)
     {
         s32 i;
         u8 side;
+        struct TurnOrderKeys keys;
 
         switch (gBattleStruct->turnCountersTracker)
         {
         case ENDTURN_ORDER:
+            ClearTurnOrderKeys(&keys, FALSE);
             for (i = 0; i < gBattlersCount; i++)
             {
                 gBattlerByTurnOrder[i] = i;
@@ -1744,7 +1756,7 @@ u8 DoFieldEndTurnEffects(void)
                 {
                     if (!gProtectStructs[i].quash
                             && !gProtectStructs[j].quash
-                            && GetWhichBattlerFaster(gBattlerByTurnOrder[i], gBattlerByTurnOrder[j], FALSE) == -1)
+                            && GetWhichBattlerFasterWithKeys(&keys, gBattlerByTurnOrder[i], gBattlerByTurnOrder[j]) == -1)
                         SwapTurnOrder(i, j);
                 }
             }
@@ -5268,6 +5280,7 @@ u32 AbilityBattleEffects(u32 caseID, u32 battler, u32 ability, u32 special, u32
                 }
 
                 gLastUsedAbility = gBattleMons[gBattlerAttacker].ability = gBattleStruct->overwrittenAbilities[gBattlerAttacker] = gBattleMons[gBattlerTarget].ability;
+                InvalidateBattlerAbilityCache();
                 BattleScriptPushCursor();
                 gBattlescriptCurrInstr = BattleScript_MummyActivates;
                 effect++;
@@ -5292,6 +5305,7 @@ u32 AbilityBattleEffects(u32 caseID, u32 battler, u32 ability, u32 special, u32
                 gLastUsedAbility = gBattleMons[gBattlerAttacker].ability;
                 gBattleMons[gBattlerAttacker].ability = gBattleStruct->overwrittenAbilities[gBattlerAttacker] = gBattleMons[gBattlerTarget].ability;
                 gBattleMons[gBattlerTarget].ability = gBattleStruct->overwrittenAbilities[gBattlerTarget] = gLastUsedAbility;
+                InvalidateBattlerAbilityCache();
                 BattleScriptPushCursor();
                 gBattlescriptCurrInstr = BattleScript_WanderingSpiritActivates;
                 effect++;
@@ -5766,6 +5780,8 @@ u32 AbilityBattleEffects(u32 caseID, u32 battler, u32 ability, u32 special, u32
          * Is called after ABILITYEFFECT_ON_SWITCHIN to copy any boosts
          * from switch in abilities e.g. intrepid sword, as
          */
+        if (!CouldAbilityBeOnField(ABILITY_OPPORTUNIST))
+            break;
         for (battler = 0; battler < gBattlersCount; battler++)
         {
             switch (GetBattlerAbility(battler))
@@ -6103,32 +6119,127 @@ bool32 TryPrimalReversion(u32 battler)
     return FALSE;
 }
 
-bool32 IsNeutralizingGasOnField(void)
+// The battlers' abilities after Gastro Acid, which of those abilities are on
+// the field, and which battlers have Neutralizing Gas or Mycelium Might. The
+// abilities on the field let IsAbilityOnSide, IsAbilityOnField and
+// AbilityBattleEffects skip looking at the battlers for abilities that nobody
+// has, which is most of them. Anything that changes a battler's
+// ability or Gastro Acid calls InvalidateBattlerAbilityCache, and the cache
+// is also dropped every frame in case something slips through. Whether a
+// battler is alive, the current move and Mold Breaker are still checked on
+// every lookup, so fainting and move selection need no invalidation.
+struct BattlerAbilityCache
+{
+    bool8 valid;
+    u8 neutralizingGasBattlers;
+    u8 myceliumMightBattlers;
+    u16 abilities[MAX_BATTLERS_COUNT];
+    u32 abilitiesOnField[(ABILITIES_COUNT + 31) / 32]; // Including fainted battlers, and always ABILITY_NONE.
+};
+
+static EWRAM_DATA struct BattlerAbilityCache sBattlerAbilityCache = {0};
+
+void InvalidateBattlerAbilityCache(void)
+{
+    sBattlerAbilityCache.valid = FALSE;
+}
+
+static void BuildBattlerAbilityCache(struct BattlerAbilityCache *cache)
 {
     u32 i;
 
-    for (i = 0; i < gBattlersCount; i++)
+    cache->neutralizingGasBattlers = 0;
+    cache->myceliumMightBattlers = 0;
+    memset(cache->abilitiesOnField, 0, sizeof(cache->abilitiesOnField));
+    // Suppressed abilities are ABILITY_NONE.
+    cache->abilitiesOnField[0] |= 1u << ABILITY_NONE;
+    for (i = 0; i < MAX_BATTLERS_COUNT; i++)
     {
-        if (IsBattlerAlive(i) && gBattleMons[i].ability == ABILITY_NEUTRALIZING_GAS && !(gStatuses3[i] & STATUS3_GASTRO_ACID))
-            return TRUE;
+        u32 ability = gBattleMons[i].ability;
+
+        if (!gAbilitiesInfo[ability].cantBeSuppressed && (gStatuses3[i] & STATUS3_GASTRO_ACID))
+        {
+            cache->abilities[i] = ABILITY_NONE;
+        }
+        else
+        {
+            cache->abilities[i] = ability;
+            if (ability == ABILITY_NEUTRALIZING_GAS && !(gStatuses3[i] & STATUS3_GASTRO_ACID))
+                cache->neutralizingGasBattlers |= 1u << i;
+        }
+        // Mycelium Might applies even under Gastro Acid.
+        if (ability == ABILITY_MYCELIUM_MIGHT)
+            cache->myceliumMightBattlers |= 1u << i;
+        cache->abilitiesOnField[cache->abilities[i] / 32] |= 1u << (cache->abilities[i] % 32);
     }
+    cache->valid = TRUE;
+}
 
-    return FALSE;
+#if DEBUG_ABILITY_CACHE_CHECK
+static void CheckBattlerAbilityCache(void)
+{
+    struct BattlerAbilityCache cache;
+
+    memset(&cache, 0, sizeof(cache));
+    BuildBattlerAbilityCache(&cache);
+    if (memcmp(&cache, &sBattlerAbilityCache, sizeof(cache)) != 0)
+    {
+    #if TESTING
+        Test_ExitWithResult(TEST_RESULT_ERROR, "Ability cache mismatch: gas %x/%x, mycelium %x/%x cached/calculated, abilities %d %d %d %d cached, %d %d %d %d calculated",
+                            sBattlerAbilityCache.neutralizingGasBattlers, cache.neutralizingGasBattlers,
+                            sBattlerAbilityCache.myceliumMightBattlers, cache.myceliumMightBattlers,
+                            sBattlerAbilityCache.abilities[0], sBattlerAbilityCache.abilities[1], sBattlerAbilityCache.abilities[2], sBattlerAbilityCache.abilities[3],
+                            cache.abilities[0], cache.abilities[1], cache.abilities[2], cache.abilities[3]);
+    #else
+        DebugPrintf("Ability cache mismatch");
+        AGB_ASSERT(FALSE);
+    #endif // TESTING
+    }
 }
+#endif // DEBUG_ABILITY_CACHE_CHECK
 
-bool32 IsMyceliumMightOnField(void)
+static inline const struct BattlerAbilityCache *GetBattlerAbilityCache(void)
+{
+    if (!sBattlerAbilityCache.valid)
+        BuildBattlerAbilityCache(&sBattlerAbilityCache);
+#if DEBUG_ABILITY_CACHE_CHECK
+    else
+        CheckBattlerAbilityCache();
+#endif // DEBUG_ABILITY_CACHE_CHECK
+    return &sBattlerAbilityCache;
+}
+
+static bool32 IsAnyBattlerAlive(u32 battlers)
 {
     u32 i;
 
-    for (i = 0; i < gBattlersCount; i++)
+    for (i = 0; battlers != 0; i++, battlers >>= 1)
     {
-        if (IsBattlerAlive(i) && gBattleMons[i].ability == ABILITY_MYCELIUM_MIGHT && IS_MOVE_STATUS(gCurrentMove))
+        if ((battlers & 1) && IsBattlerAlive(i))
             return TRUE;
     }
 
     return FALSE;
 }
 
+// Whether any battler, fainted or not, could have 'ability'. If not, none of
+// them needs to be looked at.
+static bool32 CouldAbilityBeOnField(u32 ability)
+{
+    const struct BattlerAbilityCache *cache = GetBattlerAbilityCache();
+    return cache->abilitiesOnField[ability / 32] & (1u << (ability % 32));
+}
+
+bool32 IsNeutralizingGasOnField(void)
+{
+    return IsAnyBattlerAlive(GetBattlerAbilityCache()->neutralizingGasBattlers);
+}
+
+bool32 IsMyceliumMightOnField(void)
+{
+    return IS_MOVE_STATUS(gCurrentMove) && IsAnyBattlerAlive(GetBattlerAbilityCache()->myceliumMightBattlers);
+}
+
 bool32 IsMoldBreakerTypeAbility(u32 ability)
 {
     return (ability == ABILITY_MOLD_BREAKER || ability == ABILITY_TERAVOLT || ability == ABILITY_TURBOBLAZE);
@@ -6136,33 +6247,36 @@ bool32 IsMoldBreakerTypeAbility(u32 ability)
 
 u32 GetBattlerAbility(u32 battler)
 {
-    if (gAbilitiesInfo[gBattleMons[battler].ability].cantBeSuppressed)
-        return gBattleMons[battler].ability;
+    const struct BattlerAbilityCache *cache = GetBattlerAbilityCache();
+    u32 ability = cache->abilities[battler];
 
-    if (gStatuses3[battler] & STATUS3_GASTRO_ACID)
-        return ABILITY_NONE;
+    // Abilities that can't be suppressed and Gastro Acid are already resolved in the cache.
+    if (ability == ABILITY_NONE || gAbilitiesInfo[ability].cantBeSuppressed)
+        return ability;
 
-    if (IsNeutralizingGasOnField() && gBattleMons[battler].ability != ABILITY_NEUTRALIZING_GAS)
+    if (ability != ABILITY_NEUTRALIZING_GAS && IsAnyBattlerAlive(cache->neutralizingGasBattlers))
         return ABILITY_NONE;
 
-    if (IsMyceliumMightOnField())
+    if (IS_MOVE_STATUS(gCurrentMove) && IsAnyBattlerAlive(cache->myceliumMightBattlers))
         return ABILITY_NONE;
 
     if (((IsMoldBreakerTypeAbility(gBattleMons[gBattlerAttacker].ability)
             && !(gStatuses3[gBattlerAttacker] & STATUS3_GASTRO_ACID))
             || gMovesInfo[gCurrentMove].ignoresTargetAbility)
-            && gAbilitiesInfo[gBattleMons[battler].ability].breakable
+            && gAbilitiesInfo[ability].breakable
             && gBattlerByTurnOrder[gCurrentTurnActionNumber] == gBattlerAttacker
             && gActionsByTurnOrder[gBattlerByTurnOrder[gBattlerAttacker]] == B_ACTION_USE_MOVE
             && gCurrentTurnActionNumber < gBattlersCount)
         return ABILITY_NONE;
 
-    return gBattleMons[battler].ability;
+    return ability;
 }
 
 u32 IsAbilityOnSide(u32 battler, u32 ability)
 {
-    if (IsBattlerAlive(battler) && GetBattlerAbility(battler) == ability)
+    if (!CouldAbilityBeOnField(ability))
+        return 0;
+    else if (IsBattlerAlive(battler) && GetBattlerAbility(battler) == ability)
         return battler + 1;
     else if (IsBattlerAlive(BATTLE_PARTNER(battler)) && GetBattlerAbility(BATTLE_PARTNER(battler)) == ability)
         return BATTLE_PARTNER(battler) + 1;
@@ -6179,6 +6293,9 @@ u32 IsAbilityOnField(u32 ability)
 {
     u32 i;
 
+    if (!CouldAbilityBeOnField(ability))
+        return 0;
+
     for (i = 0; i < gBattlersCount; i++)
     {
         if (IsBattlerAlive(i) && GetBattlerAbility(i) == ability)
@@ -6192,6 +6309,9 @@ u32 IsAbilityOnFieldExcept(u32 battler, u32 ability)
 {
     u32 i;
 
+    if (!CouldAbilityBeOnField(ability))
+        return 0;
+
     for (i = 0; i < gBattlersCount; i++)
     {
         if (i != battler && IsBattlerAlive(i) && GetBattlerAbility(i) == ability)
@@ -7921,7 +8041,7 @@ void ClearVariousBattlerFlags(u32 battler)
 void HandleAction_RunBattleScript(void) // identical to RunBattleScriptCommands
 {
     if (gBattleControllerExecFlags == 0)
-        gBattleScriptingCommandsTable[*gBattlescriptCurrInstr]();
+        DispatchBattleScriptCommand();
 }
 
 u32 SetRandomTarget(u32 battler)
@@ -9132,14 +9252,18 @@ static inline u32 CalcMoveBasePowerAfterModifiers(u32 move, u32 battlerAtk, u32
     return uq4_12_multiply_by_int_half_down(modifier, basePower);
 }
 
-static inline u32 CalcAttackStat(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, bool32 isCrit, bool32 updateFlags, u32 atkAbility, u32 defAbility, u32 holdEffectAtk)
+static inline u32 ApplyStatStage(u32 stat, u32 stage)
+{
+    stat *= gStatStageRatios[stage][0];
+    stat /= gStatStageRatios[stage][1];
+    return stat;
+}
+
+// The attack stat the move uses with its stage applied.
+static inline u32 GetStagedAttackStat(u32 move, u32 battlerAtk, u32 battlerDef, bool32 isCrit, u32 defAbility)
 {
     u8 atkStage;
     u32 atkStat;
-    uq4_12_t modifier;
-    u16 atkBaseSpeciesId;
-
-    atkBaseSpeciesId = GET_BASE_SPECIES_ID(gBattleMons[battlerAtk].species);
 
     if (gMovesInfo[move].effect == EFFECT_FOUL_PLAY)
     {
@@ -9180,8 +9304,16 @@ static inline u32 CalcAttackStat(u32 move, u32 battlerAtk, u32 battlerDef, u32 m
     if (defAbility == ABILITY_UNAWARE)
         atkStage = DEFAULT_STAT_STAGE;
 
-    atkStat *= gStatStageRatios[atkStage][0];
-    atkStat /= gStatStageRatios[atkStage][1];
+    return ApplyStatStage(atkStat, atkStage);
+}
+
+// atkStat is the attack stat the move uses with its stage applied, see GetStagedAttackStat.
+static inline u32 CalcAttackStat(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, u32 atkStat, bool32 updateFlags, u32 atkAbility, u32 defAbility, u32 holdEffectAtk)
+{
+    uq4_12_t modifier;
+    u16 atkBaseSpeciesId;
+
+    atkBaseSpeciesId = GET_BASE_SPECIES_ID(gBattleMons[battlerAtk].species);
 
     // apply attack stat modifiers
     modifier = UQ_4_12(1.0);
@@ -9346,12 +9478,11 @@ static bool32 CanEvolve(u32 species)
     return FALSE;
 }
 
-static inline u32 CalcDefenseStat(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, bool32 isCrit, bool32 updateFlags, u32 atkAbility, u32 defAbility, u32 holdEffectDef, u32 weather)
+// The defense stat the move targets with its stage applied.
+static inline u32 GetStagedDefenseStat(u32 move, u32 battlerDef, bool32 isCrit, u32 atkAbility)
 {
-    bool32 usesDefStat;
     u8 defStage;
     u32 defStat, def, spDef;
-    uq4_12_t modifier;
 
     if (gFieldStatuses & STATUS_FIELD_WONDER_ROOM) // the defense stats are swapped
     {
@@ -9368,13 +9499,11 @@ static inline u32 CalcDefenseStat(u32 move, u32 battlerAtk, u32 battlerDef, u32
     {
         defStat = def;
         defStage = gBattleMons[battlerDef].statStages[STAT_DEF];
-        usesDefStat = TRUE;
     }
     else // is special
     {
         defStat = spDef;
         defStage = gBattleMons[battlerDef].statStages[STAT_SPDEF];
-        usesDefStat = FALSE;
     }
 
     // Self-destruct / Explosion cut defense in half
@@ -9391,8 +9520,14 @@ static inline u32 CalcDefenseStat(u32 move, u32 battlerAtk, u32 battlerDef, u32
     if (gMovesInfo[move].ignoresTargetDefenseEvasionStages)
         defStage = DEFAULT_STAT_STAGE;
 
-    defStat *= gStatStageRatios[defStage][0];
-    defStat /= gStatStageRatios[defStage][1];
+    return ApplyStatStage(defStat, defStage);
+}
+
+// defStat is the defense stat the move targets with its stage applied, see GetStagedDefenseStat.
+static inline u32 CalcDefenseStat(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, u32 defStat, bool32 updateFlags, u32 atkAbility, u32 defAbility, u32 holdEffectDef, u32 weather)
+{
+    bool32 usesDefStat = (gMovesInfo[move].effect == EFFECT_PSYSHOCK || IS_MOVE_PHYSICAL(move));
+    uq4_12_t modifier;
 
     // apply defense stat modifiers
     modifier = UQ_4_12(1.0);
@@ -9794,21 +9929,83 @@ static inline uq4_12_t GetOtherModifiers(u32 move, u32 moveType, u32 battlerAtk,
     dmg = uq4_12_multiply_by_int_half_down(modifier, dmg); \
 } while (0)
 
-static inline s32 DoMoveDamageCalcVars(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, s32 fixedBasePower,
-                            bool32 isCrit, bool32 randomFactor, bool32 updateFlags, uq4_12_t typeEffectivenessModifier, u32 weather,
-                            u32 holdEffectAtk, u32 holdEffectDef, u32 abilityAtk, u32 abilityDef)
+// Stages a stat for a normal and a critical hit the same way GetStagedAttackStat and GetStagedDefenseStat do.
+static inline void StageDamageContextStat(u32 *stats, u32 stat, u32 stage, bool32 ignoreStages, bool32 isDefense)
+{
+    if (ignoreStages)
+        stage = DEFAULT_STAT_STAGE;
+    stats[0] = ApplyStatStage(stat, stage);
+    // critical hits ignore the attacker's stat drops and the target's stat boosts
+    if (isDefense ? stage > DEFAULT_STAT_STAGE : stage < DEFAULT_STAT_STAGE)
+        stats[1] = ApplyStatStage(stat, DEFAULT_STAT_STAGE);
+    else
+        stats[1] = stats[0];
+}
+
+void InitDamageContext(struct DamageContext *ctx, u32 battlerAtk, u32 battlerDef, u32 weather, u32 holdEffectAtk, u32 holdEffectDef, u32 abilityAtk, u32 abilityDef)
+{
+    u32 def, spDef;
+
+    ctx->battlerAtk = battlerAtk;
+    ctx->battlerDef = battlerDef;
+    ctx->abilityAtk = abilityAtk;
+    ctx->abilityDef = abilityDef;
+    ctx->holdEffectAtk = holdEffectAtk;
+    ctx->holdEffectDef = holdEffectDef;
+    ctx->weather = weather;
+
+    StageDamageContextStat(ctx->attack[0], gBattleMons[battlerAtk].attack, gBattleMons[battlerAtk].statStages[STAT_ATK], abilityDef == ABILITY_UNAWARE, FALSE);
+    StageDamageContextStat(ctx->attack[1], gBattleMons[battlerAtk].spAttack, gBattleMons[battlerAtk].statStages[STAT_SPATK], abilityDef == ABILITY_UNAWARE, FALSE);
+
+    if (gFieldStatuses & STATUS_FIELD_WONDER_ROOM) // the defense stats are swapped
+    {
+        def = gBattleMons[battlerDef].spDefense;
+        spDef = gBattleMons[battlerDef].defense;
+    }
+    else
+    {
+        def = gBattleMons[battlerDef].defense;
+        spDef = gBattleMons[battlerDef].spDefense;
+    }
+    StageDamageContextStat(ctx->defense[0], def, gBattleMons[battlerDef].statStages[STAT_DEF], abilityAtk == ABILITY_UNAWARE, TRUE);
+    StageDamageContextStat(ctx->defense[1], spDef, gBattleMons[battlerDef].statStages[STAT_SPDEF], abilityAtk == ABILITY_UNAWARE, TRUE);
+}
+
+// Foul Play and Body Press use other battlers' stats, so they are staged for the move.
+static inline u32 GetDamageContextAttackStat(const struct DamageContext *ctx, u32 move, bool32 isCrit)
+{
+    if (gMovesInfo[move].effect == EFFECT_FOUL_PLAY || gMovesInfo[move].effect == EFFECT_BODY_PRESS)
+        return GetStagedAttackStat(move, ctx->battlerAtk, ctx->battlerDef, isCrit, ctx->abilityDef);
+    return ctx->attack[IS_MOVE_PHYSICAL(move) ? 0 : 1][isCrit ? 1 : 0];
+}
+
+// Moves that ignore the target's stages and the old Explosion defense halving are staged for the move.
+static inline u32 GetDamageContextDefenseStat(const struct DamageContext *ctx, u32 move, bool32 isCrit)
+{
+    if (gMovesInfo[move].ignoresTargetDefenseEvasionStages
+     || (B_EXPLOSION_DEFENSE < GEN_5 && gMovesInfo[gCurrentMove].effect == EFFECT_EXPLOSION))
+        return GetStagedDefenseStat(move, ctx->battlerDef, isCrit, ctx->abilityAtk);
+    return ctx->defense[(gMovesInfo[move].effect == EFFECT_PSYSHOCK || IS_MOVE_PHYSICAL(move)) ? 0 : 1][isCrit ? 1 : 0];
+}
+
+static inline s32 DoMoveDamageCalcVars(const struct DamageContext *ctx, u32 move, u32 moveType, s32 fixedBasePower,
+                            bool32 isCrit, bool32 randomFactor, bool32 updateFlags, uq4_12_t typeEffectivenessModifier)
 {
     s32 dmg;
     u32 userFinalAttack;
     u32 targetFinalDefense;
+    u32 battlerAtk = ctx->battlerAtk, battlerDef = ctx->battlerDef;
+    u32 abilityAtk = ctx->abilityAtk, abilityDef = ctx->abilityDef;
+    u32 holdEffectAtk = ctx->holdEffectAtk, holdEffectDef = ctx->holdEffectDef;
+    u32 weather = ctx->weather;
 
     if (fixedBasePower)
         gBattleMovePower = fixedBasePower;
     else
         gBattleMovePower = CalcMoveBasePowerAfterModifiers(move, battlerAtk, battlerDef, moveType, updateFlags, abilityAtk, abilityDef, holdEffectAtk, weather);
 
-    userFinalAttack = CalcAttackStat(move, battlerAtk, battlerDef, moveType, isCrit, updateFlags, abilityAtk, abilityDef, holdEffectAtk);
-    targetFinalDefense = CalcDefenseStat(move, battlerAtk, battlerDef, moveType, isCrit, updateFlags, abilityAtk, abilityDef, holdEffectDef, weather);
+    userFinalAttack = CalcAttackStat(move, battlerAtk, battlerDef, moveType, GetDamageContextAttackStat(ctx, move, isCrit), updateFlags, abilityAtk, abilityDef, holdEffectAtk);
+    targetFinalDefense = CalcDefenseStat(move, battlerAtk, battlerDef, moveType, GetDamageContextDefenseStat(ctx, move, isCrit), updateFlags, abilityAtk, abilityDef, holdEffectDef, weather);
 
     dmg = CalculateBaseDamage(gBattleMovePower, userFinalAttack, gBattleMons[battlerAtk].level, targetFinalDefense);
     DAMAGE_APPLY_MODIFIER(GetTargetDamageModifier(move, battlerAtk, battlerDef));
@@ -9837,18 +10034,16 @@ static inline s32 DoMoveDamageCalcVars(u32 move, u32 battlerAtk, u32 battlerDef,
 static inline s32 DoMoveDamageCalc(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, s32 fixedBasePower,
                             bool32 isCrit, bool32 randomFactor, bool32 updateFlags, uq4_12_t typeEffectivenessModifier, u32 weather)
 {
-    u32 holdEffectAtk, holdEffectDef, abilityAtk, abilityDef;
+    struct DamageContext ctx;
 
     if (typeEffectivenessModifier == UQ_4_12(0.0))
         return 0;
 
-    holdEffectAtk = GetBattlerHoldEffect(battlerAtk, TRUE);
-    holdEffectDef = GetBattlerHoldEffect(battlerDef, TRUE);
-    abilityAtk = GetBattlerAbility(battlerAtk);
-    abilityDef = GetBattlerAbility(battlerDef);
+    InitDamageContext(&ctx, battlerAtk, battlerDef, weather,
+                      GetBattlerHoldEffect(battlerAtk, TRUE), GetBattlerHoldEffect(battlerDef, TRUE),
+                      GetBattlerAbility(battlerAtk), GetBattlerAbility(battlerDef));
 
-    return DoMoveDamageCalcVars(move, battlerAtk, battlerDef, moveType, fixedBasePower, isCrit, randomFactor,
-                            updateFlags, typeEffectivenessModifier, weather, holdEffectAtk, holdEffectDef, abilityAtk, abilityDef);
+    return DoMoveDamageCalcVars(&ctx, move, moveType, fixedBasePower, isCrit, randomFactor, updateFlags, typeEffectivenessModifier);
 }
 
 static inline s32 DoFutureSightAttackDamageCalcVars(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType,
@@ -9870,7 +10065,7 @@ static inline s32 DoFutureSightAttackDamageCalcVars(u32 move, u32 battlerAtk, u3
     else
         userFinalAttack = GetMonData(partyMon, MON_DATA_SPATK, NULL);
 
-    targetFinalDefense = CalcDefenseStat(move, battlerAtk, battlerDef, moveType, isCrit, updateFlags, ABILITY_NONE, abilityDef, holdEffectDef, weather);
+    targetFinalDefense = CalcDefenseStat(move, battlerAtk, battlerDef, moveType, GetStagedDefenseStat(move, battlerDef, isCrit, ABILITY_NONE), updateFlags, ABILITY_NONE, abilityDef, holdEffectDef, weather);
     dmg = CalculateBaseDamage(gBattleMovePower, userFinalAttack, partyMonLevel, targetFinalDefense);
 
     DAMAGE_APPLY_MODIFIER(GetCriticalModifier(isCrit));
@@ -9944,8 +10139,16 @@ s32 CalculateMoveDamage(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType,
 s32 CalculateMoveDamageVars(u32 move, u32 battlerAtk, u32 battlerDef, u32 moveType, s32 fixedBasePower, uq4_12_t typeEffectivenessModifier,
                                           u32 weather, bool32 isCrit, u32 holdEffectAtk, u32 holdEffectDef, u32 abilityAtk, u32 abilityDef)
 {
-    return DoMoveDamageCalcVars(move, battlerAtk, battlerDef, moveType, fixedBasePower, isCrit, FALSE, FALSE,
-                                typeEffectivenessModifier, weather, holdEffectAtk, holdEffectDef, abilityAtk, abilityDef);
+    struct DamageContext ctx;
+
+    InitDamageContext(&ctx, battlerAtk, battlerDef, weather, holdEffectAtk, holdEffectDef, abilityAtk, abilityDef);
+    return DoMoveDamageCalcVars(&ctx, move, moveType, fixedBasePower, isCrit, FALSE, FALSE, typeEffectivenessModifier);
+}
+
+// for AI so that everything that doesn't depend on the move is calculated once for each pair of battlers
+s32 CalculateMoveDamageWithContext(const struct DamageContext *ctx, u32 move, u32 moveType, s32 fixedBasePower, uq4_12_t typeEffectivenessModifier, bool32 isCrit)
+{
+    return DoMoveDamageCalcVars(ctx, move, moveType, fixedBasePower, isCrit, FALSE, FALSE, typeEffectivenessModifier);
 }
 
 static inline void MulByTypeEffectiveness(uq4_12_t *modifier, u32 move, u32 moveType, u32 battlerDef, u32 defType, u32 battlerAtk, bool32 recordAbilities)
@@ -10026,16 +10229,43 @@ static void UpdateMoveResultFlags(uq4_12_t modifier)
     }
 }
 
+// Returns the combined effectiveness against both types from sDualTypeEffectivenessTable,
+// or 0 if one of the exceptions in MulByTypeEffectiveness may apply. All of those except
+// Freeze-Dry, Tar Shot and strong winds only turn an immunity into a regular hit.
+static inline uq4_12_t GetDualTypeModifierNoExceptions(u32 move, u32 moveType, u32 battlerDef, u32 defType1, u32 defType2)
+{
+    if (defType1 >= NUMBER_OF_MON_TYPES || defType2 >= NUMBER_OF_MON_TYPES)
+        return UQ_4_12(0.0);
+    if (gMovesInfo[move].effect == EFFECT_FREEZE_DRY
+     || (moveType == TYPE_FIRE && gDisableStructs[battlerDef].tarShot)
+     || (gBattleWeather & B_WEATHER_STRONG_WINDS && (defType1 == TYPE_FLYING || defType2 == TYPE_FLYING)))
+        return UQ_4_12(0.0);
+    return GetDualTypeModifier(moveType, defType1, defType2);
+}
+
 static inline uq4_12_t CalcTypeEffectivenessMultiplierInternal(u32 move, u32 moveType, u32 battlerAtk, u32 battlerDef, bool32 recordAbilities, uq4_12_t modifier, u32 defAbility)
 {
     u32 illusionSpecies;
+    u32 defType1 = GetBattlerType(battlerDef, 0);
+    u32 defType2 = GetBattlerType(battlerDef, 1);
+    u32 defType3 = GetBattlerType(battlerDef, 2);
+    uq4_12_t mod = UQ_4_12(0.0);
 
-    MulByTypeEffectiveness(&modifier, move, moveType, battlerDef, GetBattlerType(battlerDef, 0), battlerAtk, recordAbilities);
-    if (GetBattlerType(battlerDef, 1) != GetBattlerType(battlerDef, 0))
-        MulByTypeEffectiveness(&modifier, move, moveType, battlerDef, GetBattlerType(battlerDef, 1), battlerAtk, recordAbilities);
-    if (GetBattlerType(battlerDef, 2) != TYPE_MYSTERY && GetBattlerType(battlerDef, 2) != GetBattlerType(battlerDef, 1)
-        && GetBattlerType(battlerDef, 2) != GetBattlerType(battlerDef, 0))
-        MulByTypeEffectiveness(&modifier, move, moveType, battlerDef, GetBattlerType(battlerDef, 2), battlerAtk, recordAbilities);
+    if (defType3 == TYPE_MYSTERY || defType3 == defType1 || defType3 == defType2)
+        mod = GetDualTypeModifierNoExceptions(move, moveType, battlerDef, defType1, defType2);
+
+    if (mod != UQ_4_12(0.0))
+    {
+        modifier = uq4_12_multiply(modifier, mod);
+    }
+    else
+    {
+        MulByTypeEffectiveness(&modifier, move, moveType, battlerDef, defType1, battlerAtk, recordAbilities);
+        if (defType2 != defType1)
+            MulByTypeEffectiveness(&modifier, move, moveType, battlerDef, defType2, battlerAtk, recordAbilities);
+        if (defType3 != TYPE_MYSTERY && defType3 != defType2 && defType3 != defType1)
+            MulByTypeEffectiveness(&modifier, move, moveType, battlerDef, defType3, battlerAtk, recordAbilities);
+    }
 
     if (recordAbilities && (illusionSpecies = GetIllusionMonSpecies(battlerDef)))
         TryNoticeIllusionInTypeEffectiveness(move, moveType, battlerAtk, battlerDef, modifier, illusionSpecies);
@@ -10115,9 +10345,18 @@ uq4_12_t CalcPartyMonTypeEffectivenessMultiplier(u16 move, u16 speciesDef, u16 a
 
     if (move != MOVE_STRUGGLE && moveType != TYPE_MYSTERY)
     {
-        MulByTypeEffectiveness(&modifier, move, moveType, 0, gSpeciesInfo[speciesDef].types[0], 0, FALSE);
-        if (gSpeciesInfo[speciesDef].types[1] != gSpeciesInfo[speciesDef].types[0])
-            MulByTypeEffectiveness(&modifier, move, moveType, 0, gSpeciesInfo[speciesDef].types[1], 0, FALSE);
+        uq4_12_t mod = GetDualTypeModifierNoExceptions(move, moveType, 0, gSpeciesInfo[speciesDef].types[0], gSpeciesInfo[speciesDef].types[1]);
+
+        if (mod != UQ_4_12(0.0))
+        {
+            modifier = uq4_12_multiply(modifier, mod);
+        }
+        else
+        {
+            MulByTypeEffectiveness(&modifier, move, moveType, 0, gSpeciesInfo[speciesDef].types[0], 0, FALSE);
+            if (gSpeciesInfo[speciesDef].types[1] != gSpeciesInfo[speciesDef].types[0])
+                MulByTypeEffectiveness(&modifier, move, moveType, 0, gSpeciesInfo[speciesDef].types[1], 0, FALSE);
+        }
 
         if (moveType == TYPE_GROUND && abilityDef == ABILITY_LEVITATE && !(gFieldStatuses & STATUS_FIELD_GRAVITY))
             modifier = UQ_4_12(0.0);
@@ -10144,13 +10383,24 @@ static uq4_12_t GetInverseTypeMultiplier(uq4_12_t multiplier)
     }
 }
 
+static inline bool32 IsInverseBattle(void)
+{
+    return B_FLAG_INVERSE_BATTLE != 0 && FlagGet(B_FLAG_INVERSE_BATTLE);
+}
+
 uq4_12_t GetTypeModifier(u32 atkType, u32 defType)
 {
-    if (B_FLAG_INVERSE_BATTLE != 0 && FlagGet(B_FLAG_INVERSE_BATTLE))
+    if (IsInverseBattle())
         return GetInverseTypeMultiplier(sTypeEffectivenessTable[atkType][defType]);
     return sTypeEffectivenessTable[atkType][defType];
 }
 
+// The effectiveness of atkType against a defender with both types, counting a repeated type once.
+uq4_12_t GetDualTypeModifier(u32 atkType, u32 defType1, u32 defType2)
+{
+    return sDualTypeEffectivenessTable[IsInverseBattle()][atkType][defType1][defType2];
+}
+
 s32 GetStealthHazardDamageByTypesAndHP(u8 hazardType, u8 type1, u8 type2, u32 maxHp)
 {
     s32 dmg = 0;
@@ -11085,6 +11335,7 @@ void CopyMonLevelAndBaseStatsToBattleMon(u32 battler, struct Pokemon *mon)
 void CopyMonAbilityAndTypesToBattleMon(u32 battler, struct Pokemon *mon)
 {
     gBattleMons[battler].ability = GetMonAbility(mon);
+    InvalidateBattlerAbilityCache();
     gBattleMons[battler].type1 = gSpeciesInfo[gBattleMons[battler].species].types[0];
     gBattleMons[battler].type2 = gSpeciesInfo[gBattleMons[battler].species].types[1];
     gBattleMons[battler].type3 = TYPE_MYSTERY;
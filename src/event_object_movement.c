@@ -80,6 +80,25 @@ static EWRAM_DATA u8 sCurrentReflectionType = 0;
 static EWRAM_DATA u16 sCurrentSpecialObjectPaletteTag = 0;
 static EWRAM_DATA struct LockedAnimObjectEvents *sLockedAnimObjectEvents = {0};
 
+// Object events are bucketed by their current and previous coords, so that
+// finding the objects at a position only has to check the objects in that
+// position's bucket instead of every object event. The bucket is a hash of
+// the coords modulo 8 on each axis, rather than a block of the map, so that
+// objects within 8 metatiles of each other never share one. Objects on
+// screen therefore rarely do.
+// Each bucket is a mask of object event ids, and each object event is in
+// exactly one bucket of each kind, the one recorded for it below.
+#define OBJECT_EVENT_BUCKET_SIZE 8
+#define OBJECT_EVENT_BUCKET_COUNT (OBJECT_EVENT_BUCKET_SIZE * OBJECT_EVENT_BUCKET_SIZE)
+#define OBJECT_EVENT_BUCKET(x, y) (((x) & (OBJECT_EVENT_BUCKET_SIZE - 1)) + ((y) & (OBJECT_EVENT_BUCKET_SIZE - 1)) * OBJECT_EVENT_BUCKET_SIZE)
+
+STATIC_ASSERT(OBJECT_EVENTS_COUNT <= 32, ObjectEventBucketMasksTooSmall);
+
+static EWRAM_DATA u32 sObjectEventsByCurrentCoords[OBJECT_EVENT_BUCKET_COUNT] = {0};
+static EWRAM_DATA u32 sObjectEventsByPreviousCoords[OBJECT_EVENT_BUCKET_COUNT] = {0};
+static EWRAM_DATA u8 sObjectEventCurrentBuckets[OBJECT_EVENTS_COUNT] = {0};
+static EWRAM_DATA u8 sObjectEventPreviousBuckets[OBJECT_EVENTS_COUNT] = {0};
+
 static void MoveCoordsInDirection(u32, s16 *, s16 *, s16, s16);
 static bool8 ObjectEventExecSingleMovementAction(struct ObjectEvent *, struct Sprite *);
 static void SetMovementDelay(struct Sprite *, s16);
@@ -90,7 +109,7 @@ static void TryEnableObjectEventAnim(struct ObjectEvent *, struct Sprite *);
 static void ObjectEventExecHeldMovementAction(struct ObjectEvent *, struct Sprite *);
 static void UpdateObjectEventSpriteAnimPause(struct ObjectEvent *, struct Sprite *);
 static bool8 IsCoordOutsideObjectEventMovementRange(struct ObjectEvent *, s16, s16);
-static bool8 IsMetatileDirectionallyImpassable(struct ObjectEvent *, s16, s16, u8);
+static bool8 IsMetatileDirectionallyImpassable(struct ObjectEvent *, u32, u8);
 static bool8 DoesObjectCollideWithObjectAt(struct ObjectEvent *, s16, s16);
 static void UpdateObjectEventOffscreen(struct ObjectEvent *, struct Sprite *);
 static void UpdateObjectEventSpriteVisibility(struct ObjectEvent *, struct Sprite *);
@@ -165,6 +184,7 @@ static void CreateLevitateMovementTask(struct ObjectEvent *);
 static void DestroyLevitateMovementTask(u8);
 static bool8 NpcTakeStep(struct Sprite *);
 static bool8 IsElevationMismatchAt(u8, s16, s16);
+static bool8 IsElevationMismatch(u8, u8);
 static bool8 AreElevationsCompatible(u8, u8);
 
 static const struct SpriteFrameImage sPicTable_PechaBerryTree[];
@@ -1184,6 +1204,44 @@ static void ClearAllObjectEvents(void)
 
     for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
         ClearObjectEvent(&gObjectEvents[i]);
+    RebuildObjectEventCoordsIndex();
+}
+
+// Moves the object event into the buckets for its current and previous
+// coords. Must be called whenever either of them changes.
+void UpdateObjectEventCoordsIndex(struct ObjectEvent *objectEvent)
+{
+    u32 objectEventId = objectEvent - gObjectEvents;
+    u32 bit = 1u << objectEventId;
+    u32 bucket;
+
+    bucket = OBJECT_EVENT_BUCKET(objectEvent->currentCoords.x, objectEvent->currentCoords.y);
+    sObjectEventsByCurrentCoords[sObjectEventCurrentBuckets[objectEventId]] &= ~bit;
+    sObjectEventsByCurrentCoords[bucket] |= bit;
+    sObjectEventCurrentBuckets[objectEventId] = bucket;
+
+    bucket = OBJECT_EVENT_BUCKET(objectEvent->previousCoords.x, objectEvent->previousCoords.y);
+    sObjectEventsByPreviousCoords[sObjectEventPreviousBuckets[objectEventId]] &= ~bit;
+    sObjectEventsByPreviousCoords[bucket] |= bit;
+    sObjectEventPreviousBuckets[objectEventId] = bucket;
+}
+
+// For when gObjectEvents has been overwritten wholesale, e.g. by loading a save.
+void RebuildObjectEventCoordsIndex(void)
+{
+    u32 i;
+
+    for (i = 0; i < OBJECT_EVENT_BUCKET_COUNT; i++)
+    {
+        sObjectEventsByCurrentCoords[i] = 0;
+        sObjectEventsByPreviousCoords[i] = 0;
+    }
+    for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
+    {
+        sObjectEventCurrentBuckets[i] = 0;
+        sObjectEventPreviousBuckets[i] = 0;
+        UpdateObjectEventCoordsIndex(&gObjectEvents[i]);
+    }
 }
 
 void ResetObjectEvents(void)
@@ -1240,14 +1298,16 @@ bool8 TryGetObjectEventIdByLocalIdAndMap(u8 localId, u8 mapNum, u8 mapGroupId, u
 
 u8 GetObjectEventIdByXY(s16 x, s16 y)
 {
-    u8 i;
-    for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
+    u32 i;
+    u32 objectEvents = sObjectEventsByCurrentCoords[OBJECT_EVENT_BUCKET(x, y)];
+
+    for (i = 0; objectEvents != 0; i++, objectEvents >>= 1)
     {
-        if (gObjectEvents[i].active && gObjectEvents[i].currentCoords.x == x && gObjectEvents[i].currentCoords.y == y)
-            break;
+        if ((objectEvents & 1) && gObjectEvents[i].active && gObjectEvents[i].currentCoords.x == x && gObjectEvents[i].currentCoords.y == y)
+            return i;
     }
 
-    return i;
+    return OBJECT_EVENTS_COUNT;
 }
 
 static u8 GetObjectEventIdByLocalIdAndMapInternal(u8 localId, u8 mapNum, u8 mapGroupId)
@@ -1300,6 +1360,7 @@ static u8 InitObjectEventStateFromTemplate(const struct ObjectEventTemplate *tem
     objectEvent->currentCoords.y = y;
     objectEvent->previousCoords.x = x;
     objectEvent->previousCoords.y = y;
+    UpdateObjectEventCoordsIndex(objectEvent);
     objectEvent->currentElevation = template->elevation;
     objectEvent->previousElevation = template->elevation;
     objectEvent->rangeX = template->movementRangeX;
@@ -2102,6 +2163,7 @@ static void UNUSED IncrementObjectEventCoords(struct ObjectEvent *objectEvent, s
     objectEvent->previousCoords.y = objectEvent->currentCoords.y;
     objectEvent->currentCoords.x += x;
     objectEvent->currentCoords.y += y;
+    UpdateObjectEventCoordsIndex(objectEvent);
 }
 
 void ShiftObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
@@ -2110,6 +2172,7 @@ void ShiftObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
     objectEvent->previousCoords.y = objectEvent->currentCoords.y;
     objectEvent->currentCoords.x = x;
     objectEvent->currentCoords.y = y;
+    UpdateObjectEventCoordsIndex(objectEvent);
 }
 
 static void SetObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
@@ -2118,6 +2181,7 @@ static void SetObjectEventCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
     objectEvent->previousCoords.y = y;
     objectEvent->currentCoords.x = x;
     objectEvent->currentCoords.y = y;
+    UpdateObjectEventCoordsIndex(objectEvent);
 }
 
 void MoveObjectEventToMapCoords(struct ObjectEvent *objectEvent, s16 x, s16 y)
@@ -2176,16 +2240,18 @@ void UpdateObjectEventCoordsForCameraUpdate(void)
                 gObjectEvents[i].previousCoords.y -= dy;
             }
         }
+        RebuildObjectEventCoordsIndex();
     }
 }
 
 u8 GetObjectEventIdByPosition(u16 x, u16 y, u8 elevation)
 {
-    u8 i;
+    u32 i;
+    u32 objectEvents = sObjectEventsByCurrentCoords[OBJECT_EVENT_BUCKET(x, y)];
 
-    for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
+    for (i = 0; objectEvents != 0; i++, objectEvents >>= 1)
     {
-        if (gObjectEvents[i].active)
+        if ((objectEvents & 1) && gObjectEvents[i].active)
         {
             if (gObjectEvents[i].currentCoords.x == x
              && gObjectEvents[i].currentCoords.y == y
@@ -4648,6 +4714,7 @@ static u8 GetCollisionInDirection(struct ObjectEvent *objectEvent, u8 direction)
 u8 GetCollisionAtCoords(struct ObjectEvent *objectEvent, s16 x, s16 y, u32 dir)
 {
     u8 direction = dir;
+    u32 info;
 
 #if OW_FLAG_NO_COLLISION != 0
     if (FlagGet(OW_FLAG_NO_COLLISION))
@@ -4656,11 +4723,13 @@ u8 GetCollisionAtCoords(struct ObjectEvent *objectEvent, s16 x, s16 y, u32 dir)
 
     if (IsCoordOutsideObjectEventMovementRange(objectEvent, x, y))
         return COLLISION_OUTSIDE_RANGE;
-    else if (MapGridGetCollisionAt(x, y) || GetMapBorderIdAt(x, y) == CONNECTION_INVALID || IsMetatileDirectionallyImpassable(objectEvent, x, y, direction))
+
+    info = MapGridGetMetatileInfoAt(x, y);
+    if (METATILE_INFO_COLLISION(info) || GetMapBorderIdAt(x, y) == CONNECTION_INVALID || IsMetatileDirectionallyImpassable(objectEvent, METATILE_INFO_BEHAVIOR(info), direction))
         return COLLISION_IMPASSABLE;
     else if (objectEvent->trackedByCamera && !CanCameraMoveInDirection(direction))
         return COLLISION_IMPASSABLE;
-    else if (IsElevationMismatchAt(objectEvent->currentElevation, x, y))
+    else if (IsElevationMismatch(objectEvent->currentElevation, METATILE_INFO_ELEVATION(info)))
         return COLLISION_ELEVATION_MISMATCH;
     else if (DoesObjectCollideWithObjectAt(objectEvent, x, y))
         return COLLISION_OBJECT_EVENT;
@@ -4670,12 +4739,13 @@ u8 GetCollisionAtCoords(struct ObjectEvent *objectEvent, s16 x, s16 y, u32 dir)
 u8 GetCollisionFlagsAtCoords(struct ObjectEvent *objectEvent, s16 x, s16 y, u8 direction)
 {
     u8 flags = 0;
+    u32 info = MapGridGetMetatileInfoAt(x, y);
 
     if (IsCoordOutsideObjectEventMovementRange(objectEvent, x, y))
         flags |= 1 << (COLLISION_OUTSIDE_RANGE - 1);
-    if (MapGridGetCollisionAt(x, y) || GetMapBorderIdAt(x, y) == CONNECTION_INVALID || IsMetatileDirectionallyImpassable(objectEvent, x, y, direction) || (objectEvent->trackedByCamera && !CanCameraMoveInDirection(direction)))
+    if (METATILE_INFO_COLLISION(info) || GetMapBorderIdAt(x, y) == CONNECTION_INVALID || IsMetatileDirectionallyImpassable(objectEvent, METATILE_INFO_BEHAVIOR(info), direction) || (objectEvent->trackedByCamera && !CanCameraMoveInDirection(direction)))
         flags |= 1 << (COLLISION_IMPASSABLE - 1);
-    if (IsElevationMismatchAt(objectEvent->currentElevation, x, y))
+    if (IsElevationMismatch(objectEvent->currentElevation, METATILE_INFO_ELEVATION(info)))
         flags |= 1 << (COLLISION_ELEVATION_MISMATCH - 1);
     if (DoesObjectCollideWithObjectAt(objectEvent, x, y))
         flags |= 1 << (COLLISION_OBJECT_EVENT - 1);
@@ -4708,10 +4778,10 @@ static bool8 IsCoordOutsideObjectEventMovementRange(struct ObjectEvent *objectEv
     return FALSE;
 }
 
-static bool8 IsMetatileDirectionallyImpassable(struct ObjectEvent *objectEvent, s16 x, s16 y, u8 direction)
+static bool8 IsMetatileDirectionallyImpassable(struct ObjectEvent *objectEvent, u32 metatileBehavior, u8 direction)
 {
     if (gOppositeDirectionBlockedMetatileFuncs[direction - 1](objectEvent->currentMetatileBehavior)
-        || gDirectionBlockedMetatileFuncs[direction - 1](MapGridGetMetatileBehaviorAt(x, y)))
+        || gDirectionBlockedMetatileFuncs[direction - 1](metatileBehavior))
         return TRUE;
 
     return FALSE;
@@ -4719,13 +4789,15 @@ static bool8 IsMetatileDirectionallyImpassable(struct ObjectEvent *objectEvent,
 
 static bool8 DoesObjectCollideWithObjectAt(struct ObjectEvent *objectEvent, s16 x, s16 y)
 {
-    u8 i;
+    u32 i;
     struct ObjectEvent *curObject;
+    u32 bucket = OBJECT_EVENT_BUCKET(x, y);
+    u32 objectEvents = sObjectEventsByCurrentCoords[bucket] | sObjectEventsByPreviousCoords[bucket];
 
-    for (i = 0; i < OBJECT_EVENTS_COUNT; i++)
+    for (i = 0; objectEvents != 0; i++, objectEvents >>= 1)
     {
         curObject = &gObjectEvents[i];
-        if (curObject->active && curObject != objectEvent)
+        if ((objectEvents & 1) && curObject->active && curObject != objectEvent)
         {
             if ((curObject->currentCoords.x == x && curObject->currentCoords.y == y) || (curObject->previousCoords.x == x && curObject->previousCoords.y == y))
             {
@@ -7702,12 +7774,16 @@ static void SetObjectEventSpriteOamTableForLongGrass(struct ObjectEvent *objEven
 
 static bool8 IsElevationMismatchAt(u8 elevation, s16 x, s16 y)
 {
-    u8 mapElevation;
-
     if (elevation == 0)
         return FALSE;
 
-    mapElevation = MapGridGetElevationAt(x, y);
+    return IsElevationMismatch(elevation, MapGridGetElevationAt(x, y));
+}
+
+static bool8 IsElevationMismatch(u8 elevation, u8 mapElevation)
+{
+    if (elevation == 0)
+        return FALSE;
 
     if (mapElevation == 0 || mapElevation == 15)
         return FALSE;
@@ -1,5 +1,6 @@
 #include "global.h"
 #include "berry.h"
+#include "bg.h"
 #include "bike.h"
 #include "field_camera.h"
 #include "field_player_avatar.h"
@@ -31,6 +32,10 @@ static s32 MapPosToBgTilemapOffset(struct FieldCameraOffset *, s32, s32);
 static void DrawWholeMapViewInternal(int, int, const struct MapLayout *);
 static void DrawMetatileAt(const struct MapLayout *, u16, int, int);
 static void DrawMetatile(s32, const u16 *, u16);
+static void BufferMetatileAt(const struct MapLayout *, u16, int, int);
+static void BufferMetatile(s32, const u16 *, u16);
+static void RecordMapViewDrawn(void);
+static bool32 TryDrawDirtyMapView(void);
 static void CameraPanningCB_PanAhead(void);
 
 static struct FieldCameraOffset sFieldCameraOffset;
@@ -43,6 +48,26 @@ struct CameraObject gFieldCamera;
 u16 gTotalCameraPixelOffsetY;
 u16 gTotalCameraPixelOffsetX;
 
+// What the overworld bg tilemap buffers were last drawn from. While the
+// camera, layout and tile offsets still match, DrawWholeMapView only has
+// to redraw the metatiles that were changed since, which are listed in
+// sDirtyMetatiles. If too many change, the whole view is redrawn.
+#define MAX_DIRTY_METATILES 64
+
+struct MapViewState
+{
+    const struct MapLayout *mapLayout;
+    s16 x;
+    s16 y;
+    u8 xTileOffset;
+    u8 yTileOffset;
+    bool8 drawn;
+    u8 dirtyCount;
+};
+
+EWRAM_DATA static struct MapViewState sMapViewState = {0};
+EWRAM_DATA static struct Coords16 sDirtyMetatiles[MAX_DIRTY_METATILES] = {0};
+
 static void ResetCameraOffset(struct FieldCameraOffset *cameraOffset)
 {
     cameraOffset->xTileOffset = 0;
@@ -50,6 +75,7 @@ static void ResetCameraOffset(struct FieldCameraOffset *cameraOffset)
     cameraOffset->xPixelOffset = 0;
     cameraOffset->yPixelOffset = 0;
     cameraOffset->copyBGToVRAM = TRUE;
+    InvalidateMapView();
 }
 
 static void AddCameraTileOffset(struct FieldCameraOffset *cameraOffset, u32 xOffset, u32 yOffset)
@@ -93,10 +119,113 @@ void GetCameraOffsetWithPan(s16 *x, s16 *y)
 
 void DrawWholeMapView(void)
 {
-    DrawWholeMapViewInternal(gSaveBlock1Ptr->pos.x, gSaveBlock1Ptr->pos.y, gMapHeader.mapLayout);
+    if (!TryDrawDirtyMapView())
+    {
+        DrawWholeMapViewInternal(gSaveBlock1Ptr->pos.x, gSaveBlock1Ptr->pos.y, gMapHeader.mapLayout);
+        RecordMapViewDrawn();
+    }
     sFieldCameraOffset.copyBGToVRAM = TRUE;
 }
 
+// Called when a metatile in the map grid changes, so that the next
+// DrawWholeMapView redraws it.
+void SetMapViewMetatileDirty(int x, int y)
+{
+    u32 i;
+
+    if (!sMapViewState.drawn)
+        return;
+
+    for (i = 0; i < sMapViewState.dirtyCount; i++)
+    {
+        if (sDirtyMetatiles[i].x == x && sDirtyMetatiles[i].y == y)
+            return;
+    }
+
+    if (sMapViewState.dirtyCount == MAX_DIRTY_METATILES)
+    {
+        InvalidateMapView();
+        return;
+    }
+
+    sDirtyMetatiles[sMapViewState.dirtyCount].x = x;
+    sDirtyMetatiles[sMapViewState.dirtyCount].y = y;
+    sMapViewState.dirtyCount++;
+}
+
+// Called when the tilemap buffers or the map grid change in a way that
+// dirty metatiles can't describe, so that the next DrawWholeMapView
+// redraws everything.
+void InvalidateMapView(void)
+{
+    sMapViewState.drawn = FALSE;
+    sMapViewState.dirtyCount = 0;
+}
+
+static void RecordMapViewDrawn(void)
+{
+    sMapViewState.mapLayout = gMapHeader.mapLayout;
+    sMapViewState.x = gSaveBlock1Ptr->pos.x;
+    sMapViewState.y = gSaveBlock1Ptr->pos.y;
+    sMapViewState.xTileOffset = sFieldCameraOffset.xTileOffset;
+    sMapViewState.yTileOffset = sFieldCameraOffset.yTileOffset;
+    sMapViewState.drawn = TRUE;
+    sMapViewState.dirtyCount = 0;
+}
+
+static bool32 TryDrawDirtyMapView(void)
+{
+    u32 i;
+    u32 rows = 0;
+    u32 row;
+    u32 numRows;
+    const struct MapLayout *mapLayout = gMapHeader.mapLayout;
+
+    if (!sMapViewState.drawn
+     || sMapViewState.mapLayout != mapLayout
+     || sMapViewState.x != gSaveBlock1Ptr->pos.x
+     || sMapViewState.y != gSaveBlock1Ptr->pos.y
+     || sMapViewState.xTileOffset != sFieldCameraOffset.xTileOffset
+     || sMapViewState.yTileOffset != sFieldCameraOffset.yTileOffset)
+        return FALSE;
+
+    for (i = 0; i < sMapViewState.dirtyCount; i++)
+    {
+        s32 offset = MapPosToBgTilemapOffset(&sFieldCameraOffset, sDirtyMetatiles[i].x, sDirtyMetatiles[i].y);
+
+        if (offset >= 0)
+        {
+            BufferMetatileAt(mapLayout, offset, sDirtyMetatiles[i].x, sDirtyMetatiles[i].y);
+            rows |= 3u << (offset / 32);
+        }
+    }
+    sMapViewState.dirtyCount = 0;
+
+    // Only copy the rows of the tilemaps that were redrawn. Each run of
+    // rows is one copy per background.
+    row = 0;
+    while (rows != 0)
+    {
+        if (!(rows & 1))
+        {
+            row++;
+            rows >>= 1;
+            continue;
+        }
+        for (numRows = 0; numRows < 32 && (rows & (1u << numRows)); numRows++)
+            ;
+        if (LoadBgTilemap(1, &gOverworldTilemapBuffer_Bg1[row * 32], numRows * 32 * 2, row * 32) == 0xFFFF)
+            ScheduleBgCopyTilemapToVram(1);
+        if (LoadBgTilemap(2, &gOverworldTilemapBuffer_Bg2[row * 32], numRows * 32 * 2, row * 32) == 0xFFFF)
+            ScheduleBgCopyTilemapToVram(2);
+        if (LoadBgTilemap(3, &gOverworldTilemapBuffer_Bg3[row * 32], numRows * 32 * 2, row * 32) == 0xFFFF)
+            ScheduleBgCopyTilemapToVram(3);
+        row += numRows;
+        rows = (numRows < 32) ? rows >> numRows : 0;
+    }
+    return TRUE;
+}
+
 static void DrawWholeMapViewInternal(int x, int y, const struct MapLayout *mapLayout)
 {
     u8 i;
@@ -133,6 +262,16 @@ static void RedrawMapSlicesForCameraUpdate(struct FieldCameraOffset *cameraOffse
     if (y < 0)
         RedrawMapSliceSouth(cameraOffset, mapLayout);
     cameraOffset->copyBGToVRAM = TRUE;
+
+    // The slices keep the view in step with the camera, so metatiles
+    // changed since the last draw can still be redrawn on their own.
+    if (sMapViewState.drawn && sMapViewState.mapLayout == mapLayout)
+    {
+        sMapViewState.x = gSaveBlock1Ptr->pos.x;
+        sMapViewState.y = gSaveBlock1Ptr->pos.y;
+        sMapViewState.xTileOffset = cameraOffset->xTileOffset;
+        sMapViewState.yTileOffset = cameraOffset->yTileOffset;
+    }
 }
 
 static void RedrawMapSliceNorth(struct FieldCameraOffset *cameraOffset, const struct MapLayout *mapLayout)
@@ -220,10 +359,30 @@ void DrawDoorMetatileAt(int x, int y, u16 *tiles)
     {
         DrawMetatile(METATILE_LAYER_TYPE_COVERED, tiles, offset);
         sFieldCameraOffset.copyBGToVRAM = TRUE;
+
+        // The door's frames aren't in the map grid, so the view no longer
+        // matches it.
+        InvalidateMapView();
     }
 }
 
 static void DrawMetatileAt(const struct MapLayout *mapLayout, u16 offset, int x, int y)
+{
+    BufferMetatileAt(mapLayout, offset, x, y);
+    ScheduleBgCopyTilemapToVram(1);
+    ScheduleBgCopyTilemapToVram(2);
+    ScheduleBgCopyTilemapToVram(3);
+}
+
+static void DrawMetatile(s32 metatileLayerType, const u16 *tiles, u16 offset)
+{
+    BufferMetatile(metatileLayerType, tiles, offset);
+    ScheduleBgCopyTilemapToVram(1);
+    ScheduleBgCopyTilemapToVram(2);
+    ScheduleBgCopyTilemapToVram(3);
+}
+
+static void BufferMetatileAt(const struct MapLayout *mapLayout, u16 offset, int x, int y)
 {
     u16 metatileId = MapGridGetMetatileIdAt(x, y);
     const u16 *metatiles;
@@ -237,10 +396,10 @@ static void DrawMetatileAt(const struct MapLayout *mapLayout, u16 offset, int x,
         metatiles = mapLayout->secondaryTileset->metatiles;
         metatileId -= NUM_METATILES_IN_PRIMARY;
     }
-    DrawMetatile(MapGridGetMetatileLayerTypeAt(x, y), metatiles + metatileId * NUM_TILES_PER_METATILE, offset);
+    BufferMetatile(MapGridGetMetatileLayerTypeAt(x, y), metatiles + metatileId * NUM_TILES_PER_METATILE, offset);
 }
 
-static void DrawMetatile(s32 metatileLayerType, const u16 *tiles, u16 offset)
+static void BufferMetatile(s32 metatileLayerType, const u16 *tiles, u16 offset)
 {
     switch (metatileLayerType)
     {
@@ -302,9 +461,6 @@ static void DrawMetatile(s32 metatileLayerType, const u16 *tiles, u16 offset)
         gOverworldTilemapBuffer_Bg1[offset + 0x21] = tiles[7];
         break;
     }
-    ScheduleBgCopyTilemapToVram(1);
-    ScheduleBgCopyTilemapToVram(2);
-    ScheduleBgCopyTilemapToVram(3);
 }
 
 static s32 MapPosToBgTilemapOffset(struct FieldCameraOffset *cameraOffset, s32 x, s32 y)
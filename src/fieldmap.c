@@ -1,6 +1,7 @@
 #include "global.h"
 #include "battle_pyramid.h"
 #include "bg.h"
+#include "field_camera.h"
 #include "fieldmap.h"
 #include "fldeff.h"
 #include "fldeff_misc.h"
@@ -29,6 +30,10 @@ EWRAM_DATA u16 ALIGNED(4) sBackupMapData[MAX_MAP_DATA_SIZE] = {0};
 EWRAM_DATA struct MapHeader gMapHeader = {0};
 EWRAM_DATA struct Camera gCamera = {0};
 EWRAM_DATA static struct ConnectionFlags sMapConnectionFlags = {0};
+// The attributes of every metatile in the current layout's tilesets, so that
+// looking one up doesn't have to go through the layout and pick a tileset.
+EWRAM_DATA static u16 sMetatileAttributes[NUM_METATILES_TOTAL] = {0};
+EWRAM_DATA static const struct MapLayout *sMetatileAttributesLayout = NULL;
 EWRAM_DATA static u32 UNUSED sFiller = 0; // without this, the next file won't align properly
 
 struct BackupMapLayout gBackupMapLayout;
@@ -42,6 +47,7 @@ static void FillNorthConnection(struct MapHeader const *mapHeader, struct MapHea
 static void FillWestConnection(struct MapHeader const *mapHeader, struct MapHeader const *connectedMapHeader, s32 offset);
 static void FillEastConnection(struct MapHeader const *mapHeader, struct MapHeader const *connectedMapHeader, s32 offset);
 static void InitBackupMapLayoutConnections(struct MapHeader *mapHeader);
+static void LoadMetatileAttributes(struct MapLayout const *mapLayout);
 static void LoadSavedMapView(void);
 static bool8 SkipCopyingMetatileFromSavedMap(u16 *mapBlock, u16 mapWidth, u8 yMode);
 static const struct MapConnection *GetIncomingConnection(u8 direction, int x, int y);
@@ -85,12 +91,14 @@ void InitBattlePyramidMap(bool8 setPlayerPosition)
 {
     CpuFastFill16(MAPGRID_UNDEFINED, sBackupMapData, sizeof(sBackupMapData));
     GenerateBattlePyramidFloorLayout(sBackupMapData, setPlayerPosition);
+    InvalidateMapView();
 }
 
 void InitTrainerHillMap(void)
 {
     CpuFastFill16(MAPGRID_UNDEFINED, sBackupMapData, sizeof(sBackupMapData));
     GenerateTrainerHillFloorLayout(sBackupMapData);
+    InvalidateMapView();
 }
 
 static void InitMapLayoutData(struct MapHeader *mapHeader)
@@ -99,6 +107,8 @@ static void InitMapLayoutData(struct MapHeader *mapHeader)
     int width;
     int height;
     mapLayout = mapHeader->mapLayout;
+    InvalidateMapView();
+    LoadMetatileAttributes(mapLayout);
     CpuFastFill16(MAPGRID_UNDEFINED, sBackupMapData, sizeof(sBackupMapData));
     gBackupMapLayout.map = sBackupMapData;
     width = mapLayout->width + MAP_OFFSET_W;
@@ -368,16 +378,56 @@ u32 MapGridGetMetatileIdAt(int x, int y)
     return block & MAPGRID_METATILE_ID_MASK;
 }
 
+static void LoadMetatileAttributes(struct MapLayout const *mapLayout)
+{
+    struct Tileset const *primaryTileset = mapLayout->primaryTileset;
+    struct Tileset const *secondaryTileset = mapLayout->secondaryTileset;
+
+    if (primaryTileset != NULL)
+        CpuCopy16(primaryTileset->metatileAttributes, sMetatileAttributes, NUM_METATILES_IN_PRIMARY * sizeof(u16));
+    else
+        CpuFill16(MB_INVALID, sMetatileAttributes, NUM_METATILES_IN_PRIMARY * sizeof(u16));
+
+    if (secondaryTileset != NULL)
+        CpuCopy16(secondaryTileset->metatileAttributes, &sMetatileAttributes[NUM_METATILES_IN_PRIMARY], (NUM_METATILES_TOTAL - NUM_METATILES_IN_PRIMARY) * sizeof(u16));
+    else
+        CpuFill16(MB_INVALID, &sMetatileAttributes[NUM_METATILES_IN_PRIMARY], (NUM_METATILES_TOTAL - NUM_METATILES_IN_PRIMARY) * sizeof(u16));
+
+    sMetatileAttributesLayout = mapLayout;
+}
+
+// The table is loaded with the map, but some maps switch layouts
+// afterwards, so it is checked against the current layout here.
+static inline const u16 *GetMetatileAttributes(void)
+{
+    if (sMetatileAttributesLayout != gMapHeader.mapLayout)
+        LoadMetatileAttributes(gMapHeader.mapLayout);
+    return sMetatileAttributes;
+}
+
 u32 MapGridGetMetatileBehaviorAt(int x, int y)
 {
-    u16 metatile = MapGridGetMetatileIdAt(x, y);
-    return GetMetatileAttributesById(metatile) & METATILE_ATTR_BEHAVIOR_MASK;
+    u32 metatile = MapGridGetMetatileIdAt(x, y);
+    return GetMetatileAttributes()[metatile] & METATILE_ATTR_BEHAVIOR_MASK;
 }
 
 u8 MapGridGetMetatileLayerTypeAt(int x, int y)
 {
-    u16 metatile = MapGridGetMetatileIdAt(x, y);
-    return (GetMetatileAttributesById(metatile) & METATILE_ATTR_LAYER_MASK) >> METATILE_ATTR_LAYER_SHIFT;
+    u32 metatile = MapGridGetMetatileIdAt(x, y);
+    return (GetMetatileAttributes()[metatile] & METATILE_ATTR_LAYER_MASK) >> METATILE_ATTR_LAYER_SHIFT;
+}
+
+// Everything about the block at (x, y) at once, to be read with the
+// METATILE_INFO_* macros. Agrees with MapGridGetMetatileIdAt,
+// MapGridGetCollisionAt, MapGridGetElevationAt and the attribute getters.
+u32 MapGridGetMetatileInfoAt(int x, int y)
+{
+    u32 block = GetMapGridBlockAt(x, y);
+
+    if (block == MAPGRID_UNDEFINED)
+        block = (GetBorderBlockAt(x, y) & MAPGRID_METATILE_ID_MASK) | (TRUE << MAPGRID_COLLISION_SHIFT);
+
+    return block | (GetMetatileAttributes()[block & MAPGRID_METATILE_ID_MASK] << 16);
 }
 
 void MapGridSetMetatileIdAt(int x, int y, u16 metatile)
@@ -387,6 +437,7 @@ void MapGridSetMetatileIdAt(int x, int y, u16 metatile)
     {
         i = x + y * gBackupMapLayout.width;
         gBackupMapLayout.map[i] = (gBackupMapLayout.map[i] & MAPGRID_ELEVATION_MASK) | (metatile & ~MAPGRID_ELEVATION_MASK);
+        SetMapViewMetatileDirty(x, y);
     }
 }
 
@@ -397,21 +448,15 @@ void MapGridSetMetatileEntryAt(int x, int y, u16 metatile)
     {
         i = x + gBackupMapLayout.width * y;
         gBackupMapLayout.map[i] = metatile;
+        SetMapViewMetatileDirty(x, y);
     }
 }
 
 u16 GetMetatileAttributesById(u16 metatile)
 {
-    const u16 *attributes;
-    if (metatile < NUM_METATILES_IN_PRIMARY)
-    {
-        attributes = gMapHeader.mapLayout->primaryTileset->metatileAttributes;
-        return attributes[metatile];
-    }
-    else if (metatile < NUM_METATILES_TOTAL)
+    if (metatile < NUM_METATILES_TOTAL)
     {
-        attributes = gMapHeader.mapLayout->secondaryTileset->metatileAttributes;
-        return attributes[metatile - NUM_METATILES_IN_PRIMARY];
+        return GetMetatileAttributes()[metatile];
     }
     else
     {
@@ -206,6 +206,14 @@ static void CallCallbacks(void)
 
 void SetMainCallback2(MainCallback callback)
 {
+#if DEBUG_HEAP_STATS
+    // Reports how much heap the scene which is ending needed.
+    struct HeapStats heapStats;
+    GetHeapStats(&heapStats);
+    DebugPrintf("heap: peak %d bytes, %d bytes free, largest free block %d bytes", heapStats.peakAllocatedBytes, heapStats.freeBytes, heapStats.largestFreeBlock);
+    ResetHeapStatsPeak();
+#endif // DEBUG_HEAP_STATS
+
     gMain.callback2 = callback;
     gMain.state = 0;
 }
@@ -1448,6 +1448,7 @@ static void InitOverworldBgs(void)
     SetBgTilemapBuffer(1, gOverworldTilemapBuffer_Bg1);
     SetBgTilemapBuffer(2, gOverworldTilemapBuffer_Bg2);
     SetBgTilemapBuffer(3, gOverworldTilemapBuffer_Bg3);
+    InvalidateMapView();
     InitStandardTextBoxWindows();
 }
 
@@ -2999,6 +3000,7 @@ static void InitLinkPlayerObjectEventPos(struct ObjectEvent *objEvent, s16 x, s1
     objEvent->currentCoords.y = y;
     objEvent->previousCoords.x = x;
     objEvent->previousCoords.y = y;
+    UpdateObjectEventCoordsIndex(objEvent);
     SetSpritePosToMapCoords(x, y, &objEvent->initialCoords.x, &objEvent->initialCoords.y);
     objEvent->initialCoords.x += 8;
     ObjectEventUpdateElevation(objEvent);
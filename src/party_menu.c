@@ -7696,23 +7696,29 @@ void MoveDeleterForgetMove(void)
 
 static void ShiftMoveSlot(struct Pokemon *mon, u8 slotTo, u8 slotFrom)
 {
-    u16 move1 = GetMonData(mon, MON_DATA_MOVE1 + slotTo);
-    u16 move0 = GetMonData(mon, MON_DATA_MOVE1 + slotFrom);
-    u8 pp1 = GetMonData(mon, MON_DATA_PP1 + slotTo);
-    u8 pp0 = GetMonData(mon, MON_DATA_PP1 + slotFrom);
-    u8 ppBonuses = GetMonData(mon, MON_DATA_PP_BONUSES);
-    u8 ppBonusMask1 = gPPUpGetMask[slotTo];
-    u8 ppBonusMove1 = (ppBonuses & ppBonusMask1) >> (slotTo * 2);
-    u8 ppBonusMask2 = gPPUpGetMask[slotFrom];
-    u8 ppBonusMove2 = (ppBonuses & ppBonusMask2) >> (slotFrom * 2);
+    struct BoxMonSession session;
+    u16 move1, move0;
+    u8 pp1, pp0, ppBonuses, ppBonusMask1, ppBonusMove1, ppBonusMask2, ppBonusMove2;
+
+    OpenBoxMon(&session, &mon->box);
+    move1 = GetBoxMonSessionData(&session, MON_DATA_MOVE1 + slotTo);
+    move0 = GetBoxMonSessionData(&session, MON_DATA_MOVE1 + slotFrom);
+    pp1 = GetBoxMonSessionData(&session, MON_DATA_PP1 + slotTo);
+    pp0 = GetBoxMonSessionData(&session, MON_DATA_PP1 + slotFrom);
+    ppBonuses = GetBoxMonSessionData(&session, MON_DATA_PP_BONUSES);
+    ppBonusMask1 = gPPUpGetMask[slotTo];
+    ppBonusMove1 = (ppBonuses & ppBonusMask1) >> (slotTo * 2);
+    ppBonusMask2 = gPPUpGetMask[slotFrom];
+    ppBonusMove2 = (ppBonuses & ppBonusMask2) >> (slotFrom * 2);
     ppBonuses &= ~ppBonusMask1;
     ppBonuses &= ~ppBonusMask2;
     ppBonuses |= (ppBonusMove1 << (slotFrom * 2)) + (ppBonusMove2 << (slotTo * 2));
-    SetMonData(mon, MON_DATA_MOVE1 + slotTo, &move0);
-    SetMonData(mon, MON_DATA_MOVE1 + slotFrom, &move1);
-    SetMonData(mon, MON_DATA_PP1 + slotTo, &pp0);
-    SetMonData(mon, MON_DATA_PP1 + slotFrom, &pp1);
-    SetMonData(mon, MON_DATA_PP_BONUSES, &ppBonuses);
+    SetBoxMonSessionData(&session, MON_DATA_MOVE1 + slotTo, &move0);
+    SetBoxMonSessionData(&session, MON_DATA_MOVE1 + slotFrom, &move1);
+    SetBoxMonSessionData(&session, MON_DATA_PP1 + slotTo, &pp0);
+    SetBoxMonSessionData(&session, MON_DATA_PP1 + slotFrom, &pp1);
+    SetBoxMonSessionData(&session, MON_DATA_PP_BONUSES, &ppBonuses);
+    CloseBoxMon(&session);
 }
 
 void IsSelectedMonEgg(void)
@@ -68,6 +68,7 @@ struct SpeciesItem
 static u16 CalculateBoxMonChecksum(struct BoxPokemon *boxMon);
 static union PokemonSubstruct *GetSubstruct(struct BoxPokemon *boxMon, u32 personality, u8 substructType);
 static void EncryptBoxMon(struct BoxPokemon *boxMon);
+static bool32 DecryptAndValidateBoxMon(struct BoxPokemon *boxMon);
 static void DecryptBoxMon(struct BoxPokemon *boxMon);
 static void Task_PlayMapChosenOrBattleBGM(u8 taskId);
 static bool8 ShouldSkipFriendshipChange(void);
@@ -441,7 +442,8 @@ const s8 gNatureStatTable[NUM_NATURES][NUM_NATURE_STATS] =
 #include "data/pokemon/level_up_learnsets/gen_1.h" // Yellow
 #endif
 
-#include "data/pokemon/teachable_learnsets.h"
+// Generated from data/pokemon/teachable_learnsets.h.
+#include "data/pokemon/teachable_learnset_bitsets.h"
 #include "data/pokemon/form_species_tables.h"
 #include "data/pokemon/form_change_tables.h"
 #include "data/pokemon/form_change_table_pointers.h"
@@ -1569,10 +1571,8 @@ void BoxMonToMon(const struct BoxPokemon *src, struct Pokemon *dest)
     SetMonData(dest, MON_DATA_HP, &value);
 }
 
-u8 GetLevelFromMonExp(struct Pokemon *mon)
+u8 GetLevelFromSpeciesAndExp(u16 species, u32 exp)
 {
-    u16 species = GetMonData(mon, MON_DATA_SPECIES, NULL);
-    u32 exp = GetMonData(mon, MON_DATA_EXP, NULL);
     s32 level = 1;
 
     while (level <= MAX_LEVEL && gExperienceTables[gSpeciesInfo[species].growthRate][level] <= exp)
@@ -1581,16 +1581,14 @@ u8 GetLevelFromMonExp(struct Pokemon *mon)
     return level - 1;
 }
 
-u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon)
+u8 GetLevelFromMonExp(struct Pokemon *mon)
 {
-    u16 species = GetBoxMonData(boxMon, MON_DATA_SPECIES, NULL);
-    u32 exp = GetBoxMonData(boxMon, MON_DATA_EXP, NULL);
-    s32 level = 1;
-
-    while (level <= MAX_LEVEL && gExperienceTables[gSpeciesInfo[species].growthRate][level] <= exp)
-        level++;
+    return GetLevelFromSpeciesAndExp(GetMonData(mon, MON_DATA_SPECIES, NULL), GetMonData(mon, MON_DATA_EXP, NULL));
+}
 
-    return level - 1;
+u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon)
+{
+    return GetLevelFromSpeciesAndExp(GetBoxMonData(boxMon, MON_DATA_SPECIES, NULL), GetBoxMonData(boxMon, MON_DATA_EXP, NULL));
 }
 
 u16 GiveMoveToMon(struct Pokemon *mon, u16 move)
@@ -1983,6 +1981,22 @@ static void DecryptBoxMon(struct BoxPokemon *boxMon)
     }
 }
 
+// Decrypts boxMon in place and flags it as a Bad Egg if its checksum doesn't match.
+static bool32 DecryptAndValidateBoxMon(struct BoxPokemon *boxMon)
+{
+    DecryptBoxMon(boxMon);
+
+    if (CalculateBoxMonChecksum(boxMon) != boxMon->checksum)
+    {
+        boxMon->isBadEgg = TRUE;
+        boxMon->isEgg = TRUE;
+        GetSubstruct(boxMon, boxMon->personality, 3)->type3.isEgg = TRUE;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 #define SUBSTRUCT_CASE(n, v1, v2, v3, v4)                               \
 case n:                                                                 \
     {                                                                   \
@@ -2121,37 +2135,15 @@ union EvolutionTracker
     struct EvolutionTrackerBitfield asField;
 };
 
-/* GameFreak called GetBoxMonData with either 2 or 3 arguments, for type
- * safety we have a GetBoxMonData macro (in include/pokemon.h) which
- * dispatches to either GetBoxMonData2 or GetBoxMonData3 based on the
- * number of arguments. */
-u32 GetBoxMonData3(struct BoxPokemon *boxMon, s32 field, u8 *data)
+static u32 GetDecryptedBoxMonData(struct BoxPokemon *boxMon, struct PokemonSubstruct0 *substruct0, struct PokemonSubstruct1 *substruct1, struct PokemonSubstruct2 *substruct2, struct PokemonSubstruct3 *substruct3, s32 field, u8 *data)
 {
     s32 i;
     u32 retVal = 0;
-    struct PokemonSubstruct0 *substruct0 = NULL;
-    struct PokemonSubstruct1 *substruct1 = NULL;
-    struct PokemonSubstruct2 *substruct2 = NULL;
-    struct PokemonSubstruct3 *substruct3 = NULL;
     union EvolutionTracker evoTracker;
 
-    // Any field greater than MON_DATA_ENCRYPT_SEPARATOR is encrypted and must be treated as such
+    // Any field greater than MON_DATA_ENCRYPT_SEPARATOR is read from the decrypted substructs
     if (field > MON_DATA_ENCRYPT_SEPARATOR)
     {
-        substruct0 = &(GetSubstruct(boxMon, boxMon->personality, 0)->type0);
-        substruct1 = &(GetSubstruct(boxMon, boxMon->personality, 1)->type1);
-        substruct2 = &(GetSubstruct(boxMon, boxMon->personality, 2)->type2);
-        substruct3 = &(GetSubstruct(boxMon, boxMon->personality, 3)->type3);
-
-        DecryptBoxMon(boxMon);
-
-        if (CalculateBoxMonChecksum(boxMon) != boxMon->checksum)
-        {
-            boxMon->isBadEgg = TRUE;
-            boxMon->isEgg = TRUE;
-            substruct3->isEgg = TRUE;
-        }
-
         switch (field)
         {
         case MON_DATA_NICKNAME:
@@ -2589,6 +2581,34 @@ u32 GetBoxMonData3(struct BoxPokemon *boxMon, s32 field, u8 *data)
         }
     }
 
+    return retVal;
+}
+
+/* GameFreak called GetBoxMonData with either 2 or 3 arguments, for type
+ * safety we have a GetBoxMonData macro (in include/pokemon.h) which
+ * dispatches to either GetBoxMonData2 or GetBoxMonData3 based on the
+ * number of arguments. */
+u32 GetBoxMonData3(struct BoxPokemon *boxMon, s32 field, u8 *data)
+{
+    u32 retVal;
+    struct PokemonSubstruct0 *substruct0 = NULL;
+    struct PokemonSubstruct1 *substruct1 = NULL;
+    struct PokemonSubstruct2 *substruct2 = NULL;
+    struct PokemonSubstruct3 *substruct3 = NULL;
+
+    // Any field greater than MON_DATA_ENCRYPT_SEPARATOR is encrypted and must be treated as such
+    if (field > MON_DATA_ENCRYPT_SEPARATOR)
+    {
+        substruct0 = &(GetSubstruct(boxMon, boxMon->personality, 0)->type0);
+        substruct1 = &(GetSubstruct(boxMon, boxMon->personality, 1)->type1);
+        substruct2 = &(GetSubstruct(boxMon, boxMon->personality, 2)->type2);
+        substruct3 = &(GetSubstruct(boxMon, boxMon->personality, 3)->type3);
+
+        DecryptAndValidateBoxMon(boxMon);
+    }
+
+    retVal = GetDecryptedBoxMonData(boxMon, substruct0, substruct1, substruct2, substruct3, field, data);
+
     if (field > MON_DATA_ENCRYPT_SEPARATOR)
         EncryptBoxMon(boxMon);
 
@@ -2662,33 +2682,11 @@ void SetMonData(struct Pokemon *mon, s32 field, const void *dataArg)
     }
 }
 
-void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg)
+static void SetDecryptedBoxMonData(struct BoxPokemon *boxMon, struct PokemonSubstruct0 *substruct0, struct PokemonSubstruct1 *substruct1, struct PokemonSubstruct2 *substruct2, struct PokemonSubstruct3 *substruct3, s32 field, const u8 *data)
 {
-    const u8 *data = dataArg;
-
-    struct PokemonSubstruct0 *substruct0 = NULL;
-    struct PokemonSubstruct1 *substruct1 = NULL;
-    struct PokemonSubstruct2 *substruct2 = NULL;
-    struct PokemonSubstruct3 *substruct3 = NULL;
-
+    // Any field greater than MON_DATA_ENCRYPT_SEPARATOR is written to the decrypted substructs
     if (field > MON_DATA_ENCRYPT_SEPARATOR)
     {
-        substruct0 = &(GetSubstruct(boxMon, boxMon->personality, 0)->type0);
-        substruct1 = &(GetSubstruct(boxMon, boxMon->personality, 1)->type1);
-        substruct2 = &(GetSubstruct(boxMon, boxMon->personality, 2)->type2);
-        substruct3 = &(GetSubstruct(boxMon, boxMon->personality, 3)->type3);
-
-        DecryptBoxMon(boxMon);
-
-        if (CalculateBoxMonChecksum(boxMon) != boxMon->checksum)
-        {
-            boxMon->isBadEgg = TRUE;
-            boxMon->isEgg = TRUE;
-            substruct3->isEgg = TRUE;
-            EncryptBoxMon(boxMon);
-            return;
-        }
-
         switch (field)
         {
         case MON_DATA_NICKNAME:
@@ -3011,6 +3009,30 @@ void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg)
         }
         }
     }
+}
+
+void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg)
+{
+    struct PokemonSubstruct0 *substruct0 = NULL;
+    struct PokemonSubstruct1 *substruct1 = NULL;
+    struct PokemonSubstruct2 *substruct2 = NULL;
+    struct PokemonSubstruct3 *substruct3 = NULL;
+
+    if (field > MON_DATA_ENCRYPT_SEPARATOR)
+    {
+        substruct0 = &(GetSubstruct(boxMon, boxMon->personality, 0)->type0);
+        substruct1 = &(GetSubstruct(boxMon, boxMon->personality, 1)->type1);
+        substruct2 = &(GetSubstruct(boxMon, boxMon->personality, 2)->type2);
+        substruct3 = &(GetSubstruct(boxMon, boxMon->personality, 3)->type3);
+
+        if (!DecryptAndValidateBoxMon(boxMon))
+        {
+            EncryptBoxMon(boxMon);
+            return;
+        }
+    }
+
+    SetDecryptedBoxMonData(boxMon, substruct0, substruct1, substruct2, substruct3, field, dataArg);
 
     if (field > MON_DATA_ENCRYPT_SEPARATOR)
     {
@@ -3019,6 +3041,74 @@ void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg)
     }
 }
 
+// Decrypts a copy of boxMon and validates its checksum once, so that any number
+// of fields can then be read or written through the session without decrypting
+// boxMon again. Changes are only written back by CloseBoxMon.
+void OpenBoxMon(struct BoxMonSession *session, struct BoxPokemon *boxMon)
+{
+    struct BoxPokemon *decrypted = &session->decrypted;
+
+    session->boxMon = boxMon;
+    session->modified = FALSE;
+    session->substructsModified = FALSE;
+
+    *decrypted = *boxMon;
+    session->substruct0 = &(GetSubstruct(decrypted, decrypted->personality, 0)->type0);
+    session->substruct1 = &(GetSubstruct(decrypted, decrypted->personality, 1)->type1);
+    session->substruct2 = &(GetSubstruct(decrypted, decrypted->personality, 2)->type2);
+    session->substruct3 = &(GetSubstruct(decrypted, decrypted->personality, 3)->type3);
+
+    session->isBadEgg = !DecryptAndValidateBoxMon(decrypted);
+    if (session->isBadEgg)
+    {
+        // GetBoxMonData stores the Bad Egg flags back, so do the same.
+        *boxMon = *decrypted;
+        EncryptBoxMon(boxMon);
+    }
+}
+
+u32 GetBoxMonSessionData3(struct BoxMonSession *session, s32 field, u8 *data)
+{
+    return GetDecryptedBoxMonData(&session->decrypted, session->substruct0, session->substruct1, session->substruct2, session->substruct3, field, data);
+}
+
+u32 GetBoxMonSessionData2(struct BoxMonSession *session, s32 field)
+{
+    return GetBoxMonSessionData3(session, field, NULL);
+}
+
+// Like SetBoxMonData, writing encrypted fields of a Bad Egg does nothing.
+void SetBoxMonSessionData(struct BoxMonSession *session, s32 field, const void *dataArg)
+{
+    if (field > MON_DATA_ENCRYPT_SEPARATOR)
+    {
+        if (session->isBadEgg)
+            return;
+        session->substructsModified = TRUE;
+    }
+
+    session->modified = TRUE;
+    SetDecryptedBoxMonData(&session->decrypted, session->substruct0, session->substruct1, session->substruct2, session->substruct3, field, dataArg);
+}
+
+// Re-encrypts the session's copy into the original BoxPokemon if anything was written.
+// Writes made to the original BoxPokemon while the session was open are overwritten.
+void CloseBoxMon(struct BoxMonSession *session)
+{
+    struct BoxPokemon *boxMon = session->boxMon;
+
+    if (!session->modified)
+        return;
+
+    if (session->substructsModified)
+        session->decrypted.checksum = CalculateBoxMonChecksum(&session->decrypted);
+
+    *boxMon = session->decrypted;
+    EncryptBoxMon(boxMon);
+    session->modified = FALSE;
+    session->substructsModified = FALSE;
+}
+
 void CopyMon(void *dest, void *src, size_t size)
 {
     memcpy(dest, src, size);
@@ -3391,6 +3481,7 @@ void PokemonToBattleMon(struct Pokemon *src, struct BattlePokemon *dst)
 void CopyPlayerPartyMonToBattleData(u8 battlerId, u8 partyIndex)
 {
     PokemonToBattleMon(&gPlayerParty[partyIndex], &gBattleMons[battlerId]);
+    InvalidateBattlerAbilityCache();
     gBattleStruct->hpOnSwitchout[GetBattlerSide(battlerId)] = gBattleMons[battlerId].hp;
     UpdateSentPokesToOpponentValue(battlerId);
     ClearTemporarySpeciesSpriteData(battlerId, FALSE);
@@ -5196,7 +5287,6 @@ u8 CanLearnTeachableMove(u16 species, u16 move)
     else
     {
         u32 i, j;
-        const u16 *teachableLearnset = GetSpeciesTeachableLearnset(species);
         for (i = 0; i < ARRAY_COUNT(sUniversalMoves); i++)
         {
             if (sUniversalMoves[i] == move)
@@ -5225,15 +5315,23 @@ u8 CanLearnTeachableMove(u16 species, u16 move)
                 }
             }
         }
-        for (i = 0; teachableLearnset[i] != MOVE_UNAVAILABLE; i++)
-        {
-            if (teachableLearnset[i] == move)
-                return TRUE;
-        }
-        return FALSE;
+        return IsMoveInTeachableLearnset(species, move);
     }
 }
 
+// Every teachable learnset is generated with a bitset of its moves
+// immediately before it.
+bool32 IsMoveInTeachableLearnset(u16 species, u16 move)
+{
+    const u32 *bitset = (const u32 *)GetSpeciesTeachableLearnset(species) - TEACHABLE_BITSET_WORDS;
+    u32 column;
+
+    if (move >= MOVES_COUNT_ALL || sTeachableMoveColumns[move] == 0)
+        return FALSE;
+    column = sTeachableMoveColumns[move] - 1;
+    return (bitset[column / 32] >> (column % 32)) & 1;
+}
+
 u8 GetMoveRelearnerMoves(struct Pokemon *mon, u16 *moves)
 {
     u16 learnedMoves[4];
@@ -401,6 +401,15 @@ struct ItemIcon
     bool8 active;
 };
 
+// The decoded data needed to draw a box, kept so that showing or scrolling
+// boxes doesn't decrypt every Pokémon in them again.
+struct BoxMonSummary
+{
+    u16 species;
+    u16 speciesOrEgg;
+    u16 heldItem;
+};
+
 struct PokemonStorageSystemData
 {
     u8 state;
@@ -464,6 +473,8 @@ struct PokemonStorageSystemData
     u16 iconSpeciesList[MAX_MON_ICONS];
     u16 boxSpecies[IN_BOX_COUNT];
     u32 boxPersonalities[IN_BOX_COUNT];
+    struct BoxMonSummary boxMonSummaries[TOTAL_BOXES_COUNT][IN_BOX_COUNT];
+    u32 boxMonSummariesValid[TOTAL_BOXES_COUNT]; // One bit per box position
     u8 incomingBoxId;
     u8 shiftTimer;
     u8 numPartyToCompact;
@@ -820,6 +831,8 @@ static void SetUpScrollToBox(u8);
 static bool8 ScrollToBox(void);
 static s8 DetermineBoxScrollDirection(u8);
 static void SetCurrentBox(u8);
+static const struct BoxMonSummary *GetBoxMonSummary(u8, u8);
+static void InvalidateBoxMonSummary(u8, u8);
 
 // Misc
 static void CreateMainMenu(u8, s16 *);
@@ -2100,6 +2113,8 @@ static void Task_InitPokeStorage(u8 taskId)
         SetVBlankCallback(NULL);
         SetGpuReg(REG_OFFSET_DISPCNT, 0);
         ResetForPokeStorage();
+        // The boxes may have changed while the storage system was closed
+        memset(sStorage->boxMonSummariesValid, 0, sizeof(sStorage->boxMonSummariesValid));
         if (sStorage->isReopening)
         {
             switch (sWhichToReshow)
@@ -4476,7 +4491,7 @@ static void InitBoxMonSprites(u8 boxId)
     {
         for (j = 0; j < IN_BOX_COLUMNS; j++)
         {
-            species = GetBoxMonDataAt(boxId, boxPosition, MON_DATA_SPECIES_OR_EGG);
+            species = GetBoxMonSummary(boxId, boxPosition)->speciesOrEgg;
             if (species != SPECIES_NONE)
             {
                 personality = GetBoxMonDataAt(boxId, boxPosition, MON_DATA_PERSONALITY);
@@ -4496,7 +4511,7 @@ static void InitBoxMonSprites(u8 boxId)
     {
         for (boxPosition = 0; boxPosition < IN_BOX_COUNT; boxPosition++)
         {
-            if (GetBoxMonDataAt(boxId, boxPosition, MON_DATA_HELD_ITEM) == ITEM_NONE)
+            if (GetBoxMonSummary(boxId, boxPosition)->heldItem == ITEM_NONE)
                 sStorage->boxMonsSprites[boxPosition]->oam.objMode = ST_OAM_OBJ_BLEND;
         }
     }
@@ -4504,7 +4519,7 @@ static void InitBoxMonSprites(u8 boxId)
 
 static void CreateBoxMonIconAtPos(u8 boxPosition)
 {
-    u16 species = GetCurrentBoxMonData(boxPosition, MON_DATA_SPECIES_OR_EGG);
+    u16 species = GetBoxMonSummary(StorageGetCurrentBox(), boxPosition)->speciesOrEgg;
 
     if (species != SPECIES_NONE)
     {
@@ -4642,7 +4657,7 @@ static u8 CreateBoxMonIconsInColumn(u8 column, u16 distance, s16 speed)
                     sStorage->boxMonsSprites[boxPosition]->sSpeed = speed;
                     sStorage->boxMonsSprites[boxPosition]->sScrollInDestX = xDest;
                     sStorage->boxMonsSprites[boxPosition]->callback = SpriteCB_BoxMonIconScrollIn;
-                    if (GetBoxMonDataAt(sStorage->incomingBoxId, boxPosition, MON_DATA_HELD_ITEM) == ITEM_NONE)
+                    if (GetBoxMonSummary(sStorage->incomingBoxId, boxPosition)->heldItem == ITEM_NONE)
                         sStorage->boxMonsSprites[boxPosition]->oam.objMode = ST_OAM_OBJ_BLEND;
                     iconsCreated++;
                 }
@@ -4738,7 +4753,7 @@ static void GetIncomingBoxMonData(u8 boxId)
     {
         for (j = 0; j < IN_BOX_COLUMNS; j++)
         {
-            sStorage->boxSpecies[boxPosition] = GetBoxMonDataAt(boxId, boxPosition, MON_DATA_SPECIES_OR_EGG);
+            sStorage->boxSpecies[boxPosition] = GetBoxMonSummary(boxId, boxPosition)->speciesOrEgg;
             if (sStorage->boxSpecies[boxPosition] != SPECIES_NONE)
                 sStorage->boxPersonalities[boxPosition] = GetBoxMonDataAt(boxId, boxPosition, MON_DATA_PERSONALITY);
             boxPosition++;
@@ -5917,7 +5932,7 @@ static u16 GetSpeciesAtCursorPosition(void)
     case CURSOR_AREA_IN_PARTY:
         return GetMonData(&gPlayerParty[sCursorPosition], MON_DATA_SPECIES);
     case CURSOR_AREA_IN_BOX:
-        return GetCurrentBoxMonData(sCursorPosition, MON_DATA_SPECIES);
+        return GetBoxMonSummary(StorageGetCurrentBox(), sCursorPosition)->species;
     default:
         return SPECIES_NONE;
     }
@@ -6837,7 +6852,7 @@ static bool8 CanPlaceMon(void)
     {
         if (sCursorArea == CURSOR_AREA_IN_PARTY && GetMonData(&gPlayerParty[sCursorPosition], MON_DATA_SPECIES) == SPECIES_NONE)
             return TRUE;
-        else if (sCursorArea == CURSOR_AREA_IN_BOX && GetBoxMonDataAt(StorageGetCurrentBox(), sCursorPosition, MON_DATA_SPECIES_OR_EGG) == SPECIES_NONE)
+        else if (sCursorArea == CURSOR_AREA_IN_BOX && GetBoxMonSummary(StorageGetCurrentBox(), sCursorPosition)->speciesOrEgg == SPECIES_NONE)
             return TRUE;
         else
             return FALSE;
@@ -6960,28 +6975,30 @@ static void SetDisplayMonData(void *pokemon, u8 mode)
     }
     else if (mode == MODE_BOX)
     {
-        struct BoxPokemon *boxMon = (struct BoxPokemon *)pokemon;
+        struct BoxMonSession session;
 
-        sStorage->displayMonSpecies = GetBoxMonData(pokemon, MON_DATA_SPECIES_OR_EGG);
+        OpenBoxMon(&session, (struct BoxPokemon *)pokemon);
+        sStorage->displayMonSpecies = GetBoxMonSessionData(&session, MON_DATA_SPECIES_OR_EGG);
         if (sStorage->displayMonSpecies != SPECIES_NONE)
         {
-            bool8 isShiny = GetBoxMonData(boxMon, MON_DATA_IS_SHINY);
-            sanityIsBadEgg = GetBoxMonData(boxMon, MON_DATA_SANITY_IS_BAD_EGG);
+            bool8 isShiny = GetBoxMonSessionData(&session, MON_DATA_IS_SHINY);
+            sanityIsBadEgg = GetBoxMonSessionData(&session, MON_DATA_SANITY_IS_BAD_EGG);
             if (sanityIsBadEgg)
                 sStorage->displayMonIsEgg = TRUE;
             else
-                sStorage->displayMonIsEgg = GetBoxMonData(boxMon, MON_DATA_IS_EGG);
+                sStorage->displayMonIsEgg = GetBoxMonSessionData(&session, MON_DATA_IS_EGG);
 
 
-            GetBoxMonData(boxMon, MON_DATA_NICKNAME, sStorage->displayMonName);
+            GetBoxMonSessionData(&session, MON_DATA_NICKNAME, sStorage->displayMonName);
             StringGet_Nickname(sStorage->displayMonName);
-            sStorage->displayMonLevel = GetLevelFromBoxMonExp(boxMon);
-            sStorage->displayMonMarkings = GetBoxMonData(boxMon, MON_DATA_MARKINGS);
-            sStorage->displayMonPersonality = GetBoxMonData(boxMon, MON_DATA_PERSONALITY);
+            sStorage->displayMonLevel = GetLevelFromSpeciesAndExp(GetBoxMonSessionData(&session, MON_DATA_SPECIES), GetBoxMonSessionData(&session, MON_DATA_EXP));
+            sStorage->displayMonMarkings = GetBoxMonSessionData(&session, MON_DATA_MARKINGS);
+            sStorage->displayMonPersonality = GetBoxMonSessionData(&session, MON_DATA_PERSONALITY);
             sStorage->displayMonPalette = GetMonSpritePalFromSpeciesAndPersonality(sStorage->displayMonSpecies, isShiny, sStorage->displayMonPersonality);
             gender = GetGenderFromSpeciesAndPersonality(sStorage->displayMonSpecies, sStorage->displayMonPersonality);
-            sStorage->displayMonItemId = GetBoxMonData(boxMon, MON_DATA_HELD_ITEM);
+            sStorage->displayMonItemId = GetBoxMonSessionData(&session, MON_DATA_HELD_ITEM);
         }
+        CloseBoxMon(&session);
     }
     else
     {
@@ -8509,7 +8526,7 @@ static void MultiMove_DeselectRow(u8 row, u8 minColumn, u8 maxColumn)
 static void MultiMove_SetIconToBg(u8 x, u8 y)
 {
     u8 position = x + (IN_BOX_COLUMNS * y);
-    u16 species = GetCurrentBoxMonData(position, MON_DATA_SPECIES_OR_EGG);
+    u16 species = GetBoxMonSummary(StorageGetCurrentBox(), position)->speciesOrEgg;
     u32 personality = GetCurrentBoxMonData(position, MON_DATA_PERSONALITY);
 
     if (species != SPECIES_NONE)
@@ -8534,7 +8551,7 @@ static void MultiMove_SetIconToBg(u8 x, u8 y)
 static void MultiMove_ClearIconFromBg(u8 x, u8 y)
 {
     u8 position = x + (IN_BOX_COLUMNS * y);
-    u16 species = GetCurrentBoxMonData(position, MON_DATA_SPECIES_OR_EGG);
+    u16 species = GetBoxMonSummary(StorageGetCurrentBox(), position)->speciesOrEgg;
 
     if (species != SPECIES_NONE)
     {
@@ -9501,6 +9518,33 @@ static void SetCurrentBox(u8 boxId)
         gPokemonStoragePtr->currentBox = boxId;
 }
 
+// Only valid while the storage system is open.
+static const struct BoxMonSummary *GetBoxMonSummary(u8 boxId, u8 boxPosition)
+{
+    struct BoxMonSummary *summary = &sStorage->boxMonSummaries[boxId][boxPosition];
+
+    if (!(sStorage->boxMonSummariesValid[boxId] & (1u << boxPosition)))
+    {
+        struct BoxMonSession session;
+
+        OpenBoxMon(&session, &gPokemonStoragePtr->boxes[boxId][boxPosition]);
+        summary->species = GetBoxMonSessionData(&session, MON_DATA_SPECIES);
+        summary->speciesOrEgg = GetBoxMonSessionData(&session, MON_DATA_SPECIES_OR_EGG);
+        summary->heldItem = GetBoxMonSessionData(&session, MON_DATA_HELD_ITEM);
+        CloseBoxMon(&session);
+
+        sStorage->boxMonSummariesValid[boxId] |= 1u << boxPosition;
+    }
+
+    return summary;
+}
+
+static void InvalidateBoxMonSummary(u8 boxId, u8 boxPosition)
+{
+    if (sStorage != NULL)
+        sStorage->boxMonSummariesValid[boxId] &= ~(1u << boxPosition);
+}
+
 u32 GetBoxMonDataAt(u8 boxId, u8 boxPosition, s32 request)
 {
     if (boxId < TOTAL_BOXES_COUNT && boxPosition < IN_BOX_COUNT)
@@ -9512,7 +9556,10 @@ u32 GetBoxMonDataAt(u8 boxId, u8 boxPosition, s32 request)
 void SetBoxMonDataAt(u8 boxId, u8 boxPosition, s32 request, const void *value)
 {
     if (boxId < TOTAL_BOXES_COUNT && boxPosition < IN_BOX_COUNT)
+    {
         SetBoxMonData(&gPokemonStoragePtr->boxes[boxId][boxPosition], request, value);
+        InvalidateBoxMonSummary(boxId, boxPosition);
+    }
 }
 
 u32 GetCurrentBoxMonData(u8 boxPosition, s32 request)
@@ -9564,7 +9611,10 @@ u32 GetAndCopyBoxMonDataAt(u8 boxId, u8 boxPosition, s32 request, void *dst)
 void SetBoxMonAt(u8 boxId, u8 boxPosition, struct BoxPokemon *src)
 {
     if (boxId < TOTAL_BOXES_COUNT && boxPosition < IN_BOX_COUNT)
+    {
         gPokemonStoragePtr->boxes[boxId][boxPosition] = *src;
+        InvalidateBoxMonSummary(boxId, boxPosition);
+    }
 }
 
 void CopyBoxMonAt(u8 boxId, u8 boxPosition, struct BoxPokemon *dst)
@@ -9583,13 +9633,17 @@ void CreateBoxMonAt(u8 boxId, u8 boxPosition, u16 species, u8 level, u8 fixedIV,
                      fixedIV,
                      hasFixedPersonality, personality,
                      otIDType, otID);
+        InvalidateBoxMonSummary(boxId, boxPosition);
     }
 }
 
 void ZeroBoxMonAt(u8 boxId, u8 boxPosition)
 {
     if (boxId < TOTAL_BOXES_COUNT && boxPosition < IN_BOX_COUNT)
+    {
         ZeroBoxMonData(&gPokemonStoragePtr->boxes[boxId][boxPosition]);
+        InvalidateBoxMonSummary(boxId, boxPosition);
+    }
 }
 
 void BoxMonAtToMon(u8 boxId, u8 boxPosition, struct Pokemon *dst)
@@ -10173,6 +10227,7 @@ void UpdateSpeciesSpritePSS(struct BoxPokemon *boxMon)
         else
         {
             DestroyBoxMonIcon(sStorage->boxMonsSprites[sCursorPosition]);
+            InvalidateBoxMonSummary(StorageGetCurrentBox(), sCursorPosition);
             CreateBoxMonIconAtPos(sCursorPosition);
             SetBoxMonIconObjMode(sCursorPosition, GetBoxMonData(boxMon, MON_DATA_HELD_ITEM) == ITEM_NONE);
         }
@@ -1458,32 +1458,36 @@ static bool8 ExtractMonDataToSummaryStruct(struct Pokemon *mon)
 {
     u32 i;
     struct PokeSummary *sum = &sMonSummaryScreen->summary;
+    struct BoxMonSession session;
     // Spread the data extraction over multiple frames.
     switch (sMonSummaryScreen->switchCounter)
     {
     case 0:
-        sum->species = GetMonData(mon, MON_DATA_SPECIES);
-        sum->species2 = GetMonData(mon, MON_DATA_SPECIES_OR_EGG);
-        sum->exp = GetMonData(mon, MON_DATA_EXP);
+        OpenBoxMon(&session, &mon->box);
+        sum->species = GetBoxMonSessionData(&session, MON_DATA_SPECIES);
+        sum->species2 = GetBoxMonSessionData(&session, MON_DATA_SPECIES_OR_EGG);
+        sum->exp = GetBoxMonSessionData(&session, MON_DATA_EXP);
         sum->level = GetMonData(mon, MON_DATA_LEVEL);
-        sum->abilityNum = GetMonData(mon, MON_DATA_ABILITY_NUM);
-        sum->item = GetMonData(mon, MON_DATA_HELD_ITEM);
-        sum->pid = GetMonData(mon, MON_DATA_PERSONALITY);
-        sum->sanity = GetMonData(mon, MON_DATA_SANITY_IS_BAD_EGG);
+        sum->abilityNum = GetBoxMonSessionData(&session, MON_DATA_ABILITY_NUM);
+        sum->item = GetBoxMonSessionData(&session, MON_DATA_HELD_ITEM);
+        sum->pid = GetBoxMonSessionData(&session, MON_DATA_PERSONALITY);
+        sum->sanity = GetBoxMonSessionData(&session, MON_DATA_SANITY_IS_BAD_EGG);
 
         if (sum->sanity)
             sum->isEgg = TRUE;
         else
-            sum->isEgg = GetMonData(mon, MON_DATA_IS_EGG);
-
+            sum->isEgg = GetBoxMonSessionData(&session, MON_DATA_IS_EGG);
+        CloseBoxMon(&session);
         break;
     case 1:
+        OpenBoxMon(&session, &mon->box);
         for (i = 0; i < MAX_MON_MOVES; i++)
         {
-            sum->moves[i] = GetMonData(mon, MON_DATA_MOVE1+i);
-            sum->pp[i] = GetMonData(mon, MON_DATA_PP1+i);
+            sum->moves[i] = GetBoxMonSessionData(&session, MON_DATA_MOVE1+i);
+            sum->pp[i] = GetBoxMonSessionData(&session, MON_DATA_PP1+i);
         }
-        sum->ppBonuses = GetMonData(mon, MON_DATA_PP_BONUSES);
+        sum->ppBonuses = GetBoxMonSessionData(&session, MON_DATA_PP_BONUSES);
+        CloseBoxMon(&session);
         break;
     case 2:
         if (sMonSummaryScreen->monList.mons == gPlayerParty || sMonSummaryScreen->mode == SUMMARY_MODE_BOX || sMonSummaryScreen->handleDeoxys == TRUE)
@@ -1515,12 +1519,14 @@ static bool8 ExtractMonDataToSummaryStruct(struct Pokemon *mon)
         GetMonData(mon, MON_DATA_OT_NAME, sum->OTName);
         ConvertInternationalString(sum->OTName, GetMonData(mon, MON_DATA_LANGUAGE));
         sum->ailment = GetMonAilment(mon);
-        sum->OTGender = GetMonData(mon, MON_DATA_OT_GENDER);
-        sum->OTID = GetMonData(mon, MON_DATA_OT_ID);
-        sum->metLocation = GetMonData(mon, MON_DATA_MET_LOCATION);
-        sum->metLevel = GetMonData(mon, MON_DATA_MET_LEVEL);
-        sum->metGame = GetMonData(mon, MON_DATA_MET_GAME);
-        sum->friendship = GetMonData(mon, MON_DATA_FRIENDSHIP);
+        OpenBoxMon(&session, &mon->box);
+        sum->OTGender = GetBoxMonSessionData(&session, MON_DATA_OT_GENDER);
+        sum->OTID = GetBoxMonSessionData(&session, MON_DATA_OT_ID);
+        sum->metLocation = GetBoxMonSessionData(&session, MON_DATA_MET_LOCATION);
+        sum->metLevel = GetBoxMonSessionData(&session, MON_DATA_MET_LEVEL);
+        sum->metGame = GetBoxMonSessionData(&session, MON_DATA_MET_GAME);
+        sum->friendship = GetBoxMonSessionData(&session, MON_DATA_FRIENDSHIP);
+        CloseBoxMon(&session);
         break;
     default:
         sum->ribbonCount = GetMonData(mon, MON_DATA_RIBBON_COUNT);
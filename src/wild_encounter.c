@@ -66,8 +66,14 @@ EWRAM_DATA static u8 sWildEncountersDisabled = 0;
 EWRAM_DATA static u32 sFeebasRngValue = 0;
 EWRAM_DATA bool8 gIsFishingEncounter = 0;
 EWRAM_DATA bool8 gIsSurfingEncounter = 0;
+// The map whose header was last looked up, plus one, and that header.
+EWRAM_DATA static u16 sWildMonHeaderMap = 0;
+EWRAM_DATA static u16 sWildMonHeaderId = 0;
 
 #include "data/wild_encounters.h"
+#include "data/wild_encounter_index.h"
+
+STATIC_ASSERT(WILD_MON_HEADER_INDEX_GROUPS == MAP_GROUPS_COUNT, WildMonHeaderIndexGroupsMismatch);
 
 static const struct WildPokemon sWildFeebas = {20, 25, SPECIES_FEEBAS};
 
@@ -352,34 +358,47 @@ static u8 ChooseWildMonLevel(const struct WildPokemon *wildPokemon, u8 wildMonIn
     }
 }
 
+static u16 GetMapWildMonHeaderId(u32 mapGroup, u32 mapNum)
+{
+    u32 index;
+
+    if (mapGroup >= WILD_MON_HEADER_INDEX_GROUPS)
+        return HEADER_NONE;
+
+    index = sWildMonHeaderIndexGroupOffsets[mapGroup] + mapNum;
+    if (index >= sWildMonHeaderIndexGroupOffsets[mapGroup + 1] || sWildMonHeaderIndex[index] == 0)
+        return HEADER_NONE;
+
+    return sWildMonHeaderIndex[index] - 1;
+}
+
 static u16 GetCurrentMapWildMonHeaderId(void)
 {
-    u16 i;
+    u32 mapGroup = gSaveBlock1Ptr->location.mapGroup;
+    u32 mapNum = gSaveBlock1Ptr->location.mapNum;
+    u32 map = ((mapGroup << 8) | mapNum) + 1;
+    u16 headerId;
 
-    for (i = 0; ; i++)
+    // Only look the header up again once the player has changed maps.
+    if (sWildMonHeaderMap != map)
     {
-        const struct WildPokemonHeader *wildHeader = &gWildMonHeaders[i];
-        if (wildHeader->mapGroup == MAP_GROUP(UNDEFINED))
-            break;
-
-        if (gWildMonHeaders[i].mapGroup == gSaveBlock1Ptr->location.mapGroup &&
-            gWildMonHeaders[i].mapNum == gSaveBlock1Ptr->location.mapNum)
-        {
-            if (gSaveBlock1Ptr->location.mapGroup == MAP_GROUP(ALTERING_CAVE) &&
-                gSaveBlock1Ptr->location.mapNum == MAP_NUM(ALTERING_CAVE))
-            {
-                u16 alteringCaveId = VarGet(VAR_ALTERING_CAVE_WILD_SET);
-                if (alteringCaveId >= NUM_ALTERING_CAVE_TABLES)
-                    alteringCaveId = 0;
+        sWildMonHeaderId = GetMapWildMonHeaderId(mapGroup, mapNum);
+        sWildMonHeaderMap = map;
+    }
 
-                i += alteringCaveId;
-            }
+    headerId = sWildMonHeaderId;
+    if (headerId != HEADER_NONE
+     && mapGroup == MAP_GROUP(ALTERING_CAVE)
+     && mapNum == MAP_NUM(ALTERING_CAVE))
+    {
+        u16 alteringCaveId = VarGet(VAR_ALTERING_CAVE_WILD_SET);
+        if (alteringCaveId >= NUM_ALTERING_CAVE_TABLES)
+            alteringCaveId = 0;
 
-            return i;
-        }
+        headerId += alteringCaveId;
     }
 
-    return HEADER_NONE;
+    return headerId;
 }
 
 u8 PickWildMonNature(void)
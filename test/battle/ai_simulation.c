@@ -0,0 +1,4 @@
+#include "global.h"
+#include "test/battle.h"
+
+AI_SIMULATION("Roxanne vs Brawly", TRAINER_ROXANNE_1, TRAINER_BRAWLY_1, 200);
@@ -0,0 +1,159 @@
+#include "global.h"
+#include "dma3.h"
+#include "malloc.h"
+#include "test/test.h"
+
+// The VBlank handler also processes the requests, so interrupts are
+// disabled while they're made and processed, and only checked afterwards.
+static u16 DisableInterrupts(void)
+{
+    u16 ime = REG_IME;
+    REG_IME = 0;
+    ClearDma3Requests();
+    return ime;
+}
+
+static void RestoreInterrupts(u16 ime)
+{
+    ClearDma3Requests();
+    REG_IME = ime;
+}
+
+static void WaitForScanline(u32 scanline)
+{
+    while (REG_VCOUNT == scanline)
+        ;
+    while (REG_VCOUNT != scanline)
+        ;
+}
+
+static u32 *AllocPattern(u32 size, u32 seed)
+{
+    u32 *buffer = Alloc(size);
+    u32 i;
+
+    for (i = 0; i < size / sizeof(u32); i++)
+        buffer[i] = seed + i;
+    return buffer;
+}
+
+TEST("RequestDma3Copy merges requests which continue or repeat a pending one")
+{
+    u32 *src = AllocPattern(0x40, 1);
+    u32 *dest = AllocZeroed(0x40);
+    s16 first, next, repeat;
+    struct Dma3Stats stats;
+    u16 ime;
+
+    ime = DisableInterrupts();
+    first = RequestDma3Copy(src, dest, 0x20, 1);
+    next = RequestDma3Copy(src + 8, dest + 8, 0x20, 1);
+    repeat = RequestDma3Copy(src, dest, 0x40, 1);
+    WaitForScanline(DISPLAY_HEIGHT);
+    ProcessDma3Requests();
+    GetDma3Stats(&stats);
+    RestoreInterrupts(ime);
+
+    EXPECT_EQ(next, first);
+    EXPECT_EQ(repeat, first);
+    EXPECT_EQ(stats.requestsMerged, 2);
+    EXPECT_EQ(stats.requestsMoved, 1);
+    EXPECT_EQ(stats.bytesMoved, 0x40);
+    EXPECT(memcmp(src, dest, 0x40) == 0);
+
+    Free(src);
+    Free(dest);
+}
+
+TEST("ProcessDma3Requests starts high priority requests first")
+{
+    u32 *normalSrc = AllocPattern(0x400, 1);
+    u32 *normalDest = AllocZeroed(0x400);
+    u32 *highSrc = AllocPattern(0x20, 0x1000);
+    u32 *highDest = (u32 *)OBJ_VRAM0;
+    struct Dma3Stats deferred, finished;
+    bool32 highDone, normalDeferred, normalDone;
+    u16 ime;
+
+    CpuFill32(0, highDest, 0x20);
+
+    // Scanlines 223 and 224 are enough for the OBJ VRAM copy, but not for
+    // both copies.
+    ime = DisableInterrupts();
+    RequestDma3Copy(normalSrc, normalDest, 0x400, 1);
+    RequestDma3Copy(highSrc, highDest, 0x20, 1);
+    WaitForScanline(223);
+    ProcessDma3Requests();
+    GetDma3Stats(&deferred);
+    highDone = memcmp(highSrc, highDest, 0x20) == 0;
+    normalDeferred = normalDest[0] == 0;
+    WaitForScanline(DISPLAY_HEIGHT);
+    ProcessDma3Requests();
+    GetDma3Stats(&finished);
+    normalDone = memcmp(normalSrc, normalDest, 0x400) == 0;
+    RestoreInterrupts(ime);
+
+    EXPECT(highDone);
+    EXPECT(normalDeferred);
+    EXPECT_EQ(deferred.requestsMoved, 1);
+    EXPECT_EQ(deferred.bytesMoved, 0x20);
+    EXPECT_EQ(deferred.requestsDeferred, 1);
+    EXPECT_EQ(deferred.bytesDeferred, 0x400);
+    EXPECT(normalDone);
+    EXPECT_EQ(finished.requestsMoved, 1);
+    EXPECT_EQ(finished.requestsDeferred, 0);
+
+    Free(normalSrc);
+    Free(normalDest);
+    Free(highSrc);
+}
+
+TEST("ProcessDma3Requests keeps conflicting requests in order")
+{
+    u32 *src = AllocPattern(0x20, 1);
+    u32 *buffer = AllocZeroed(0x20);
+    u32 *dest = (u32 *)OBJ_VRAM0;
+    struct Dma3Stats stats;
+    u16 ime;
+
+    CpuFill32(0, dest, 0x20);
+
+    // The OBJ VRAM copy reads what the first copy writes.
+    ime = DisableInterrupts();
+    RequestDma3Copy(src, buffer, 0x20, 1);
+    RequestDma3Copy(buffer, dest, 0x20, 1);
+    WaitForScanline(DISPLAY_HEIGHT);
+    ProcessDma3Requests();
+    GetDma3Stats(&stats);
+    RestoreInterrupts(ime);
+
+    EXPECT_EQ(stats.requestsMoved, 2);
+    EXPECT(memcmp(src, dest, 0x20) == 0);
+
+    Free(src);
+    Free(buffer);
+}
+
+TEST("ProcessDma3Requests doesn't start requests outside VBlank")
+{
+    u32 *src = AllocPattern(0x20, 1);
+    u32 *dest = AllocZeroed(0x20);
+    struct Dma3Stats stats;
+    bool32 untouched;
+    u16 ime;
+
+    ime = DisableInterrupts();
+    RequestDma3Copy(src, dest, 0x20, 1);
+    WaitForScanline(0);
+    ProcessDma3Requests();
+    GetDma3Stats(&stats);
+    untouched = dest[0] == 0;
+    RestoreInterrupts(ime);
+
+    EXPECT(untouched);
+    EXPECT_EQ(stats.requestsMoved, 0);
+    EXPECT_EQ(stats.requestsDeferred, 1);
+
+    Free(src);
+    Free(dest);
+}
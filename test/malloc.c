@@ -0,0 +1,83 @@
+#include "global.h"
+#include "malloc.h"
+#include "random.h"
+#include "test/test.h"
+
+TEST("Alloc uses the smallest free block that fits")
+{
+    void *small, *large, *p;
+    void *guards[3];
+
+    guards[0] = Alloc(4);
+    large = Alloc(256);
+    guards[1] = Alloc(4);
+    small = Alloc(64);
+    guards[2] = Alloc(4);
+    Free(large);
+    Free(small);
+
+    p = Alloc(48);
+    EXPECT_EQ(p, small);
+
+    Free(p);
+    Free(guards[0]);
+    Free(guards[1]);
+    Free(guards[2]);
+    EXPECT(CheckHeap());
+}
+
+TEST("Alloc and Free keep the heap consistent")
+{
+    u32 i, j;
+    void *pointers[64] = {0};
+    struct HeapStats before, after;
+
+    GetHeapStats(&before);
+    SeedRng(0);
+    for (i = 0; i < 2000; i++)
+    {
+        j = Random() % ARRAY_COUNT(pointers);
+        if (pointers[j] != NULL)
+        {
+            Free(pointers[j]);
+            pointers[j] = NULL;
+        }
+        else if (Random() % 4 == 0)
+        {
+            pointers[j] = Alloc(Random() % 2048);
+        }
+        else
+        {
+            pointers[j] = AllocZeroed(Random() % 64);
+        }
+    }
+    EXPECT(CheckHeap());
+
+    for (j = 0; j < ARRAY_COUNT(pointers); j++)
+        Free(pointers[j]);
+    EXPECT(CheckHeap());
+
+    GetHeapStats(&after);
+    EXPECT_EQ(after.allocatedBytes, before.allocatedBytes);
+    EXPECT_EQ(after.allocatedBlocks, before.allocatedBlocks);
+    EXPECT_EQ(after.freeBytes, before.freeBytes);
+}
+
+TEST("GetHeapStats reports peak usage since ResetHeapStatsPeak")
+{
+    void *p;
+    struct HeapStats stats;
+
+    ResetHeapStatsPeak();
+    GetHeapStats(&stats);
+    EXPECT_EQ(stats.peakAllocatedBytes, stats.allocatedBytes);
+
+    p = Alloc(1024);
+    Free(p);
+    GetHeapStats(&stats);
+    EXPECT_EQ(stats.peakAllocatedBytes, stats.allocatedBytes + 1024);
+
+    ResetHeapStatsPeak();
+    GetHeapStats(&stats);
+    EXPECT_EQ(stats.peakAllocatedBytes, stats.allocatedBytes);
+}
@@ -2,6 +2,7 @@
 #include "battle.h"
 #include "event_data.h"
 #include "pokemon.h"
+#include "string_util.h"
 #include "test/overworld_script.h"
 #include "test/test.h"
 
@@ -307,3 +308,48 @@ TEST("givemon [vars]")
     EXPECT_EQ(GetMonData(&gPlayerParty[0], MON_DATA_GIGANTAMAX_FACTOR), TRUE);
     EXPECT_EQ(GetMonData(&gPlayerParty[0], MON_DATA_TERA_TYPE), TYPE_FIRE);
 }
+
+TEST("BoxPokemon sessions read the same data as GetBoxMonData")
+{
+    u32 i;
+    struct Pokemon mon;
+    struct BoxMonSession session;
+    u8 nickname[POKEMON_NAME_LENGTH + 1], sessionNickname[POKEMON_NAME_LENGTH + 1];
+    CreateMon(&mon, SPECIES_WOBBUFFET, 100, 0, FALSE, 0, OT_ID_PRESET, 0);
+    OpenBoxMon(&session, &mon.box);
+    for (i = MON_DATA_PERSONALITY; i <= MON_DATA_EVOLUTION_TRACKER; i++)
+    {
+        if (i == MON_DATA_NICKNAME || i == MON_DATA_OT_NAME || i == MON_DATA_KNOWN_MOVES)
+            continue;
+        EXPECT_EQ(GetBoxMonSessionData(&session, i), GetBoxMonData(&mon.box, i));
+    }
+    GetBoxMonData(&mon.box, MON_DATA_NICKNAME, nickname);
+    GetBoxMonSessionData(&session, MON_DATA_NICKNAME, sessionNickname);
+    EXPECT_EQ(StringCompare(nickname, sessionNickname), 0);
+    CloseBoxMon(&session);
+}
+
+TEST("BoxPokemon sessions write the same bytes as SetBoxMonData")
+{
+    u32 move = MOVE_CELEBRATE, pp = 7, item = ITEM_LEFTOVERS, markings = 3;
+    struct Pokemon mon, sessionMon;
+    struct BoxMonSession session;
+    CreateMon(&mon, SPECIES_WOBBUFFET, 100, 0, FALSE, 0, OT_ID_PRESET, 0);
+    sessionMon = mon;
+
+    SetBoxMonData(&mon.box, MON_DATA_MOVE2, &move);
+    SetBoxMonData(&mon.box, MON_DATA_PP2, &pp);
+    SetBoxMonData(&mon.box, MON_DATA_HELD_ITEM, &item);
+    SetBoxMonData(&mon.box, MON_DATA_MARKINGS, &markings);
+
+    OpenBoxMon(&session, &sessionMon.box);
+    SetBoxMonSessionData(&session, MON_DATA_MOVE2, &move);
+    SetBoxMonSessionData(&session, MON_DATA_PP2, &pp);
+    SetBoxMonSessionData(&session, MON_DATA_HELD_ITEM, &item);
+    SetBoxMonSessionData(&session, MON_DATA_MARKINGS, &markings);
+    CloseBoxMon(&session);
+
+    EXPECT_EQ(memcmp(&mon.box, &sessionMon.box, sizeof(mon.box)), 0);
+    EXPECT_EQ(GetBoxMonData(&sessionMon.box, MON_DATA_SANITY_IS_BAD_EGG), FALSE);
+    EXPECT_EQ(GetBoxMonData(&sessionMon.box, MON_DATA_HELD_ITEM), ITEM_LEFTOVERS);
+}
@@ -1,6 +1,7 @@
 #include "global.h"
 #include "test/test.h"
 #include "constants/form_change_types.h"
+#include "constants/moves.h"
 
 TEST("Form species ID tables are shared between all forms")
 {
@@ -78,3 +79,25 @@ TEST("Form change targets have the appropriate species flags")
        }
     }
 }
+
+TEST("Teachable learnset bitsets match the teachable learnsets")
+{
+    u32 i;
+    u32 species = SPECIES_NONE;
+    for (i = 0; i < NUM_SPECIES; i++)
+    {
+        if (IsSpeciesEnabled(i)) PARAMETRIZE { species = i; }
+    }
+
+    const u16 *teachableLearnset = GetSpeciesTeachableLearnset(species);
+    for (i = MOVE_NONE + 1; i < MOVES_COUNT; i++)
+    {
+        u32 j;
+        for (j = 0; teachableLearnset[j] != MOVE_UNAVAILABLE; j++)
+        {
+            if (teachableLearnset[j] == i)
+                break;
+        }
+        EXPECT_EQ(IsMoveInTeachableLearnset(species, i), teachableLearnset[j] != MOVE_UNAVAILABLE);
+    }
+}
@@ -11,6 +11,9 @@ EWRAM_DATA static u16 sSpritePriorities[MAX_SPRITES] = {0};
 EWRAM_DATA static u8 sSpriteOrder[MAX_SPRITES] = {0};
 
 static void Old_BuildOamBuffer(void);
+static void Old_ResetSpriteTiles(void);
+static s16 Old_AllocSpriteTiles(u16 tileCount);
+static void Old_FreeSpriteTiles(u16 start, u16 count);
 
 static void ExpectEqOamBuffers(const struct OamData *oldOamBuffer, const struct OamData *newOamBuffer)
 {
@@ -121,6 +124,103 @@ TEST("BuildOamBuffer faster with mix of sprites")
     BenchmarkBuildOamBuffer(FALSE);
 }
 
+static const u8 sSpriteSheetData[128 * TILE_SIZE_4BPP] = {0};
+
+static u16 LoadSpriteSheetOfSize(u16 tag, u32 tileCount)
+{
+    struct SpriteSheet sheet = { sSpriteSheetData, tileCount * TILE_SIZE_4BPP, tag };
+    LoadSpriteSheet(&sheet);
+    return GetSpriteTileStartByTag(tag);
+}
+
+TEST("LoadSpriteSheet uses the smallest hole that fits")
+{
+    ResetSpriteData_();
+    EXPECT_EQ(LoadSpriteSheetOfSize(1, 32), 0);
+    EXPECT_EQ(LoadSpriteSheetOfSize(2, 16), 32);
+    EXPECT_EQ(LoadSpriteSheetOfSize(3, 16), 48);
+    EXPECT_EQ(LoadSpriteSheetOfSize(4, 16), 64);
+    FreeSpriteTilesByTag(1);
+    FreeSpriteTilesByTag(3);
+    EXPECT_EQ(LoadSpriteSheetOfSize(5, 16), 48);
+    EXPECT_EQ(LoadSpriteSheetOfSize(6, 32), 0);
+    FreeSpriteTilesByTag(6);
+    // Small sheets go at the end of the hole.
+    EXPECT_EQ(LoadSpriteSheetOfSize(7, 4), 28);
+}
+
+static const u16 sStressSheetSizes[] = { 4, 4, 8, 16, 16, 32, 64, 64, 128 };
+
+// Randomly loads and frees sheets, and returns how many loads failed.
+static u32 StressSpriteTileAllocator(u32 seed, bool32 old)
+{
+    u16 starts[MAX_SPRITES], counts[MAX_SPRITES], tags[MAX_SPRITES];
+    u32 i, j, n = 0, failures = 0, nextTag = 0;
+    u32 rng = seed;
+
+    ResetSpriteData_();
+    Old_ResetSpriteTiles();
+    for (i = 0; i < 1000; i++)
+    {
+        rng = ISO_RANDOMIZE1(rng);
+        if ((n != 0 && ((rng >> 16) & 1) == 0) || n == MAX_SPRITES)
+        {
+            rng = ISO_RANDOMIZE1(rng);
+            j = (rng >> 16) % n;
+            if (old)
+                Old_FreeSpriteTiles(starts[j], counts[j]);
+            else
+                FreeSpriteTilesByTag(tags[j]);
+            n--;
+            starts[j] = starts[n];
+            counts[j] = counts[n];
+            tags[j] = tags[n];
+        }
+        else
+        {
+            rng = ISO_RANDOMIZE1(rng);
+            counts[n] = sStressSheetSizes[(rng >> 16) % ARRAY_COUNT(sStressSheetSizes)];
+            tags[n] = nextTag++;
+            if (old)
+                starts[n] = Old_AllocSpriteTiles(counts[n]);
+            else
+                starts[n] = LoadSpriteSheetOfSize(tags[n], counts[n]);
+            if (starts[n] == 0xFFFF)
+                failures++;
+            else
+                n++;
+        }
+    }
+
+    if (!old)
+    {
+        struct SpriteTileAllocStats stats;
+        u32 allocatedTiles = 0;
+        GetSpriteTileAllocStats(&stats);
+        for (j = 0; j < n; j++)
+            allocatedTiles += counts[j];
+        EXPECT_EQ(stats.failures, failures);
+        EXPECT_EQ(stats.freeTiles, TOTAL_OBJ_TILE_COUNT - allocatedTiles);
+        EXPECT_LE(stats.largestHole, stats.freeTiles);
+    }
+
+    return failures;
+}
+
+TEST("LoadSpriteSheet fails less often than the first-fit allocator")
+{
+    u32 seed;
+    u32 oldFailures = 0, newFailures = 0;
+
+    for (seed = 0; seed < 8; seed++)
+    {
+        oldFailures += StressSpriteTileAllocator(seed, TRUE);
+        newFailures += StressSpriteTileAllocator(seed, FALSE);
+    }
+
+    EXPECT_LT(newFailures, oldFailures);
+}
+
 // Old implementation.
 
 #define UBFIX
@@ -301,3 +401,73 @@ static void Old_BuildOamBuffer(void)
     gMain.oamLoadDisabled = temp;
     //sShouldProcessSpriteCopyRequests = TRUE;
 }
+
+#define ALLOC_SPRITE_TILE(n)                                \
+{                                                           \
+    sOldSpriteTileAllocBitmap[(n) / 8] |= (1 << ((n) % 8)); \
+}
+
+#define FREE_SPRITE_TILE(n)                                  \
+{                                                            \
+    sOldSpriteTileAllocBitmap[(n) / 8] &= ~(1 << ((n) % 8)); \
+}
+
+#define SPRITE_TILE_IS_ALLOCATED(n) ((sOldSpriteTileAllocBitmap[(n) / 8] >> ((n) % 8)) & 1)
+
+EWRAM_DATA static u8 sOldSpriteTileAllocBitmap[128] = {0};
+
+static void Old_ResetSpriteTiles(void)
+{
+    memset(sOldSpriteTileAllocBitmap, 0, sizeof(sOldSpriteTileAllocBitmap));
+}
+
+static s16 Old_AllocSpriteTiles(u16 tileCount)
+{
+    u16 i;
+    s16 start;
+    u16 numTilesFound;
+
+    i = 0;
+
+    for (;;)
+    {
+        while (SPRITE_TILE_IS_ALLOCATED(i))
+        {
+            i++;
+
+            if (i == TOTAL_OBJ_TILE_COUNT)
+                return -1;
+        }
+
+        start = i;
+        numTilesFound = 1;
+
+        while (numTilesFound != tileCount)
+        {
+            i++;
+
+            if (i == TOTAL_OBJ_TILE_COUNT)
+                return -1;
+
+            if (!SPRITE_TILE_IS_ALLOCATED(i))
+                numTilesFound++;
+            else
+                break;
+        }
+
+        if (numTilesFound == tileCount)
+            break;
+    }
+
+    for (i = start; i < tileCount + start; i++)
+        ALLOC_SPRITE_TILE(i);
+
+    return start;
+}
+
+static void Old_FreeSpriteTiles(u16 start, u16 count)
+{
+    u16 i;
+    for (i = start; i < start + count; i++)
+        FREE_SPRITE_TILE(i);
+}
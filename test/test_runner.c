@@ -62,47 +62,175 @@ enum
     STATE_EXIT,
 };
 
-static u32 MinCostProcess(void)
+#ifdef TEST_COSTS
+struct TestCost
 {
-    u32 i;
-    u32 minCost, minCostProcess;
+    u32 cost;
+    const char *name;
+};
+
+// Frames each test took when it was last run, written by
+// mgba-rom-test-hydra and sorted by name.
+static const struct TestCost sTestCosts[] =
+{
+#define TEST_COST(_cost, _name) { _cost, _name },
+#include "test_costs.h"
+#undef TEST_COST
+};
 
-    minCost = gTestRunnerState.processCosts[0];
-    minCostProcess = 0;
-    for (i = 1; i < gTestRunnerN; i++)
+static s32 CompareTestNames(const char *a, const char *b)
+{
+    while (*a && *a == *b)
     {
-        if (gTestRunnerState.processCosts[i] < minCost)
-        {
-            minCost = gTestRunnerState.processCosts[i];
-            minCostProcess = i;
-        }
+        a++;
+        b++;
     }
+    return (u8)*a - (u8)*b;
+}
 
-    return minCostProcess;
+static u32 MeasuredTestCost(const char *name)
+{
+    s32 lo = 0, hi = ARRAY_COUNT(sTestCosts) - 1;
+    while (lo <= hi)
+    {
+        s32 mid = (lo + hi) / 2;
+        s32 cmp = CompareTestNames(name, sTestCosts[mid].name);
+        if (cmp == 0)
+            return sTestCosts[mid].cost;
+        else if (cmp < 0)
+            hi = mid - 1;
+        else
+            lo = mid + 1;
+    }
+    return 0;
 }
 
-// Greedily assign tests to processes based on estimated cost.
-// TODO: Make processCosts a min heap.
-static u32 AssignCostToRunner(void)
+// Used to convert estimateCost into frames for tests which have not
+// been measured yet.
+static u32 AverageMeasuredTestCost(void)
 {
-    u32 minCostProcess;
+    static u32 averageCost = 0;
+    if (averageCost == 0)
+    {
+        u32 i, total = 0;
+        for (i = 0; i < ARRAY_COUNT(sTestCosts); i++)
+            total += sTestCosts[i].cost;
+        averageCost = total / ARRAY_COUNT(sTestCosts);
+        if (averageCost == 0)
+            averageCost = 1;
+    }
+    return averageCost;
+}
+#endif
 
-    if (gTestRunnerState.test->runner == &gAssumptionsRunner)
-        return gTestRunnerI;
+static u32 EstimateTestCost(const struct Test *test)
+{
+    u32 cost;
 
-    minCostProcess = MinCostProcess();
+#ifdef TEST_COSTS
+    if ((cost = MeasuredTestCost(test->name)) != 0)
+        return cost;
+#endif
 
     // XXX: If estimateCost returns only on some processes, or
     // returns inconsistent results then processCosts will be
     // inconsistent and some tests may not run.
-    if (gTestRunnerState.test->runner->estimateCost)
-        gTestRunnerState.processCosts[minCostProcess] += gTestRunnerState.test->runner->estimateCost(gTestRunnerState.test->data);
+    if (test->runner->estimateCost)
+        cost = test->runner->estimateCost(test->data);
     else
-        gTestRunnerState.processCosts[minCostProcess] += 1;
+        cost = 1;
+
+#ifdef TEST_COSTS
+    cost *= AverageMeasuredTestCost();
+#endif
+
+    return cost;
+}
+
+static bool32 ProcessCostLessThan(u32 a, u32 b)
+{
+    if (gTestRunnerState.processCosts[a] != gTestRunnerState.processCosts[b])
+        return gTestRunnerState.processCosts[a] < gTestRunnerState.processCosts[b];
+    return a < b;
+}
+
+static void InitProcessHeap(void)
+{
+    u32 i;
+    for (i = 0; i < gTestRunnerN; i++)
+    {
+        gTestRunnerState.processCosts[i] = 0;
+        gTestRunnerState.processHeap[i] = i;
+    }
+}
+
+// Adds cost to the process with the lowest cost (ties going to the
+// lowest index) and returns that process.
+static u32 AddCostToMinCostProcess(u32 cost)
+{
+    u8 *heap = gTestRunnerState.processHeap;
+    u32 minCostProcess = heap[0];
+    u32 i = 0;
+
+    gTestRunnerState.processCosts[minCostProcess] += cost;
+    while (TRUE)
+    {
+        u32 child = 2 * i + 1;
+        if (child >= gTestRunnerN)
+            break;
+        if (child + 1 < gTestRunnerN && ProcessCostLessThan(heap[child + 1], heap[child]))
+            child++;
+        if (!ProcessCostLessThan(heap[child], minCostProcess))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = minCostProcess;
 
     return minCostProcess;
 }
 
+// mgba-rom-test-hydra can hand out batches of tests to processes as
+// they become idle, instead of assigning them with gTestRunnerN and
+// gTestRunnerI.
+static bool32 IsTestInBatch(const struct Test *test)
+{
+    const struct Test *batchTest;
+
+    if (gTestRunnerBatchEnd == 0)
+        return TRUE;
+
+    if (test->runner != &gAssumptionsRunner)
+        return __start_tests + gTestRunnerBatchStart <= test && test < __start_tests + gTestRunnerBatchEnd;
+
+    // Assumptions only need to run for files which have tests in the batch.
+    for (batchTest = __start_tests + gTestRunnerBatchStart; batchTest < __start_tests + gTestRunnerBatchEnd; batchTest++)
+    {
+        if (batchTest->filename == test->filename)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+// AI simulations take far longer than tests, so they are only run by
+// make simulate (gTestRunnerSimulations), which runs nothing else.
+static bool32 IsSimulationSelected(const struct Test *test)
+{
+    if (gTestRunnerSimulations)
+        return test->runner == &gAiSimulationRunner;
+    else
+        return test->runner != &gAiSimulationRunner;
+}
+
+// Greedily assign tests to processes based on estimated cost.
+static u32 AssignCostToRunner(void)
+{
+    if (gTestRunnerState.test->runner == &gAssumptionsRunner || gTestRunnerBatchEnd != 0)
+        return gTestRunnerI;
+
+    return AddCostToMinCostProcess(EstimateTestCost(gTestRunnerState.test));
+}
+
 void CB2_TestRunner(void)
 {
 top:
@@ -124,6 +252,8 @@ top:
 
         gIntrTable[7] = Intr_Timer2;
 
+        InitProcessHeap();
+
         // The current test restarted the ROM (e.g. by jumping to NULL).
         if (sCurrentTest.address != 0)
         {
@@ -135,8 +265,7 @@ top:
             }
             if (sCurrentTest.state == CURRENT_TEST_STATE_ESTIMATE)
             {
-                u32 runner = MinCostProcess();
-                gTestRunnerState.processCosts[runner] += 1;
+                u32 runner = AddCostToMinCostProcess(1);
                 if (runner == gTestRunnerI)
                 {
                     gTestRunnerState.state = STATE_REPORT_RESULT;
@@ -166,13 +295,16 @@ top:
     case STATE_ASSIGN_TEST:
         while (1)
         {
-            if (gTestRunnerState.test == __stop_tests)
+            if (gTestRunnerState.test == __stop_tests
+             || (gTestRunnerBatchEnd != 0 && gTestRunnerState.test >= __start_tests + gTestRunnerBatchEnd))
             {
                 gTestRunnerState.state = STATE_EXIT;
                 return;
             }
-            if (gTestRunnerState.test->runner != &gAssumptionsRunner
-              && !PrefixMatch(gTestRunnerArgv, gTestRunnerState.test->name))
+            if (!IsTestInBatch(gTestRunnerState.test)
+             || (gTestRunnerState.test->runner != &gAssumptionsRunner
+              && (!PrefixMatch(gTestRunnerArgv, gTestRunnerState.test->name)
+               || !IsSimulationSelected(gTestRunnerState.test))))
                 ++gTestRunnerState.test;
             else
                 break;
@@ -206,6 +338,7 @@ top:
     case STATE_RUN_TEST:
         gTestRunnerState.state = STATE_REPORT_RESULT;
         sCurrentTest.state = CURRENT_TEST_STATE_RUN;
+        gTestRunnerState.startFrame = gMain.vblankCounter1;
         SeedRng(0);
         SeedRng2(0);
         if (gTestRunnerState.test->runner->setUp)
@@ -337,6 +470,10 @@ top:
                 break;
             }
 
+            // Frames taken, for mgba-rom-test-hydra's cost profile.
+            if (gTestRunnerState.result != TEST_RESULT_CRASH)
+                MgbaPrintf_(":C%d %s", gMain.vblankCounter1 - gTestRunnerState.startFrame + 1, gTestRunnerState.test->name);
+
             if (gTestRunnerState.result == TEST_RESULT_PASS)
             {
                 if (gTestRunnerState.result != gTestRunnerState.expectedResult)
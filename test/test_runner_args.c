@@ -6,3 +6,7 @@ const bool8 gTestRunnerEnabled = TRUE;
 const u8 gTestRunnerN = 0;
 const u8 gTestRunnerI = 0;
 const char gTestRunnerArgv[256] = {'\0'};
+const u16 gTestRunnerBatchStart = 0;
+const u16 gTestRunnerBatchEnd = 0;
+const bool8 gTestRunnerSnapshots = FALSE;
+const bool8 gTestRunnerSimulations = FALSE;
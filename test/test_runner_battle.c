@@ -3,13 +3,18 @@
 #include "battle_ai_util.h"
 #include "battle_anim.h"
 #include "battle_controllers.h"
+#include "battle_main.h"
+#include "battle_setup.h"
+#include "bg.h"
 #include "characters.h"
+#include "data.h"
 #include "event_data.h"
 #include "fieldmap.h"
 #include "item_menu.h"
 #include "main.h"
 #include "malloc.h"
 #include "random.h"
+#include "recorded_battle.h"
 #include "test/battle.h"
 #include "window.h"
 #include "text.h"
@@ -21,9 +26,11 @@
 #undef TestRunner_Battle_RecordHP
 #undef TestRunner_Battle_RecordMessage
 #undef TestRunner_Battle_RecordStatus1
+#undef TestRunner_Battle_BeforeFirstTurn
 #undef TestRunner_Battle_AfterLastTurn
 #undef TestRunner_Battle_CheckBattleRecordActionType
 #undef TestRunner_Battle_GetForcedAbility
+#undef TestRunner_Battle_IsAiVsAiBattle
 #endif
 
 #define INVALID(fmt, ...) Test_ExitWithResult(TEST_RESULT_INVALID, "%s:%d: " fmt, gTestRunnerState.test->filename, sourceLine, ##__VA_ARGS__)
@@ -55,8 +62,37 @@ static inline bool32 RngSeedNotDefault(const rng_value_t *seed)
 struct BattleTestRunnerState *const gBattleTestRunnerState = (void *)sBackupMapData;
 STATIC_ASSERT(sizeof(struct BattleTestRunnerState) <= sizeof(sBackupMapData), sBackupMapDataSpace);
 
+#define MAX_AI_SIMULATION_MOVES 32
+
+struct AiSimulationMoveUses
+{
+    u16 move;
+    u32 count;
+};
+
+struct AiSimulationState
+{
+    u16 battle;
+    u16 checkProgressBattle;
+    u16 checkProgressTurn;
+    u8 moveUsesCount[NUM_BATTLE_SIDES];
+    struct AiSimulationMoveUses moveUses[NUM_BATTLE_SIDES][MAX_AI_SIMULATION_MOVES];
+};
+
+// AI simulations leave STATE zeroed so that the hooks which record
+// and check a BATTLE_TEST's SCENE have nothing to do, and keep their
+// own state after it.
+#define SIMULATION ((struct AiSimulationState *)(gBattleTestRunnerState + 1))
+STATIC_ASSERT(sizeof(struct BattleTestRunnerState) + sizeof(struct AiSimulationState) <= sizeof(sBackupMapData), sAiSimulationSpace);
+
+static bool32 IsAiSimulation(void)
+{
+    return gTestRunnerState.test->runner == &gAiSimulationRunner;
+}
+
 static void CB2_BattleTest_NextParameter(void);
 static void CB2_BattleTest_NextTrial(void);
+static void RecordAiSimulationMove(u32 battlerId, u32 moveId);
 static void PushBattlerAction(u32 sourceLine, s32 battlerId, u32 actionType, u32 byte);
 static void PrintAiMoveLog(u32 battlerId, u32 moveSlot, u32 moveId, s32 totalScore);
 static void ClearAiLog(u32 battlerId);
@@ -274,6 +310,7 @@ static void BattleTest_Run(void *data)
     const struct BattleTest *test = data;
 
     memset(&DATA, 0, sizeof(DATA));
+    STATE->setupUsedRng = FALSE;
 
     DATA.recordedBattle.rngSeed = defaultSeed;
     DATA.recordedBattle.textSpeed = OPTIONS_TEXT_SPEED_FAST;
@@ -363,6 +400,7 @@ static void BattleTest_Run(void *data)
     else
         gMain.savedCallback = CB2_TestRunner;
     SetMainCallback2(CB2_InitBattle);
+    STATE->setupStartFrame = gMain.vblankCounter1;
 
     STATE->checkProgressParameter = 0;
     STATE->checkProgressTrial = 0;
@@ -375,6 +413,9 @@ u32 RandomUniform(enum RandomTag tag, u32 lo, u32 hi)
 {
     const struct BattlerTurn *turn = NULL;
 
+    if (IsAiSimulation())
+        return RandomUniformDefault(tag, lo, hi);
+
     if (gCurrentTurnActionNumber < gBattlersCount)
     {
         u32 battlerId = gBattlerByTurnOrder[gCurrentTurnActionNumber];
@@ -385,6 +426,7 @@ u32 RandomUniform(enum RandomTag tag, u32 lo, u32 hi)
 
     if (tag == STATE->rngTag)
     {
+        STATE->setupUsedRng = TRUE;
         u32 n = hi - lo + 1;
         if (STATE->trials == 1)
         {
@@ -407,6 +449,9 @@ u32 RandomUniformExcept(enum RandomTag tag, u32 lo, u32 hi, bool32 (*reject)(u32
     const struct BattlerTurn *turn = NULL;
     u32 default_;
 
+    if (IsAiSimulation())
+        return RandomUniformExceptDefault(tag, lo, hi, reject);
+
     if (gCurrentTurnActionNumber < gBattlersCount)
     {
         u32 battlerId = gBattlerByTurnOrder[gCurrentTurnActionNumber];
@@ -421,6 +466,7 @@ u32 RandomUniformExcept(enum RandomTag tag, u32 lo, u32 hi, bool32 (*reject)(u32
 
     if (tag == STATE->rngTag)
     {
+        STATE->setupUsedRng = TRUE;
         if (STATE->trials == 1)
         {
             u32 n = 0, i;
@@ -456,6 +502,9 @@ u32 RandomWeightedArray(enum RandomTag tag, u32 sum, u32 n, const u8 *weights)
 {
     const struct BattlerTurn *turn = NULL;
 
+    if (IsAiSimulation())
+        return RandomWeightedArrayDefault(tag, sum, n, weights);
+
     if (sum == 0)
         Test_ExitWithResult(TEST_RESULT_ERROR, "RandomWeightedArray called with zero sum");
 
@@ -469,6 +518,7 @@ u32 RandomWeightedArray(enum RandomTag tag, u32 sum, u32 n, const u8 *weights)
 
     if (tag == STATE->rngTag)
     {
+        STATE->setupUsedRng = TRUE;
         if (STATE->trials == 1)
         {
             STATE->trials = n;
@@ -522,6 +572,9 @@ const void *RandomElementArray(enum RandomTag tag, const void *array, size_t siz
     const struct BattlerTurn *turn = NULL;
     u32 index = count-1;
 
+    if (IsAiSimulation())
+        return RandomElementArrayDefault(tag, array, size, count);
+
     if (gCurrentTurnActionNumber < gBattlersCount)
     {
         u32 battlerId = gBattlerByTurnOrder[gCurrentTurnActionNumber];
@@ -542,6 +595,7 @@ const void *RandomElementArray(enum RandomTag tag, const void *array, size_t siz
 
     if (tag == STATE->rngTag)
     {
+        STATE->setupUsedRng = TRUE;
         if (STATE->trials == 1)
         {
             STATE->trials = count;
@@ -799,6 +853,12 @@ void TestRunner_Battle_CheckChosenMove(u32 battlerId, u32 moveId, u32 target)
     u32 id = DATA.aiActionsPlayed[battlerId];
     struct ExpectedAIAction *expectedAction = &DATA.expectedAiActions[battlerId][id];
 
+    if (IsAiSimulation())
+    {
+        RecordAiSimulationMove(battlerId, moveId);
+        return;
+    }
+
     if (!expectedAction->actionSet)
         return;
 
@@ -868,7 +928,7 @@ void TestRunner_Battle_CheckSwitch(u32 battlerId, u32 partyIndex)
     u32 id = DATA.aiActionsPlayed[battlerId];
     struct ExpectedAIAction *expectedAction = &DATA.expectedAiActions[battlerId][id];
 
-    if (!expectedAction->actionSet)
+    if (IsAiSimulation() || !expectedAction->actionSet)
         return;
 
     if (!expectedAction->pass)
@@ -1010,6 +1070,9 @@ void TestRunner_Battle_CheckAiMoveScores(u32 battlerId)
     const char *filename = gTestRunnerState.test->filename;
     s32 turn = gBattleResults.battleTurnCounter;
 
+    if (IsAiSimulation())
+        return;
+
     for (i = 0; i < MAX_AI_SCORE_COMPARISION_PER_TURN; i++)
     {
         struct ExpectedAiScore *scoreCtx = &DATA.expectedAiScores[battlerId][turn][i];
@@ -1328,6 +1391,12 @@ void TestRunner_Battle_AfterLastTurn(void)
 {
     const struct BattleTest *test = GetBattleTest();
 
+    if (IsAiSimulation())
+        return;
+
+    if (DATA.logAI)
+        MgbaPrintf_("AI damage calcs: %d performed, %d avoided\n", AI_DATA->dmgCalcsPerformed, AI_DATA->dmgCalcsEager - AI_DATA->dmgCalcsPerformed);
+
     if (DATA.turns - 1 != DATA.lastActionTurn)
     {
         const char *filename = gTestRunnerState.test->filename;
@@ -1362,6 +1431,227 @@ static void TearDownBattle(void)
     FreeAllWindowBuffers();
 }
 
+// Trials of the same test only differ in their RNG seed, so if setting
+// up a battle did not use the RNG then every trial reaches its first
+// turn in the same state. With gTestRunnerSnapshots, that state is
+// captured in the first trial and later trials restore it instead of
+// playing through the intro again. Only the battle's logic is restored,
+// so this is limited to headless runs.
+extern u8 __battle_snapshot_ewram_start[];
+extern u8 __battle_snapshot_ewram_end[];
+extern u8 __battle_snapshot_iwram_start[];
+extern u8 __battle_snapshot_iwram_end[];
+
+// Heap which must remain free for the rest of the trial after the
+// snapshot is allocated.
+#define SNAPSHOT_HEAP_MARGIN 0x4000
+
+struct BattleTestSnapshot
+{
+    u32 setupFrames;
+    MainCallback callback1;
+    MainCallback callback2;
+    IntrCallback vblankCallback;
+    IntrCallback hblankCallback;
+    IntrCallback vcountCallback;
+    bool8 inBattle;
+    u8 queuedEvent;
+    u8 lastActionTurn;
+    // EWRAM, then IWRAM, then each heap block's header, data size and data.
+    u8 data[];
+};
+
+// Buffers which only hold graphics and so do not need to be restored.
+static bool32 IsSnapshotGfxBuffer(const void *data)
+{
+    u32 i;
+
+    if (data == gBattleAnimBgTileBuffer || data == gBattleAnimBgTilemapBuffer)
+        return TRUE;
+    if (!(gBattleTypeFlags & BATTLE_TYPE_LINK)
+     && (data == gLinkBattleSendBuffer || data == gLinkBattleRecvBuffer))
+        return TRUE;
+    if (gMonSpritesGfxPtr != NULL
+     && (data == gMonSpritesGfxPtr->firstDecompressed || data == gMonSpritesGfxPtr->barFontGfx))
+        return TRUE;
+    for (i = 0; i < NUM_BACKGROUNDS; i++)
+    {
+        if (data == GetBgTilemapBuffer(i))
+            return TRUE;
+    }
+    for (i = 0; i < WINDOWS_MAX; i++)
+    {
+        if (data == gWindows[i].tileData)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static u32 SnapshotBlockDataSize(struct MemBlock *block)
+{
+    if (!block->allocated || IsSnapshotGfxBuffer(block->data))
+        return 0;
+    return block->size;
+}
+
+static bool32 ShouldCaptureSnapshot(void)
+{
+    rng_value_t seed = gRecordedBattleRngSeed;
+
+    // Tagged RNG calls return trial-dependent values without advancing
+    // gRngValue, so they are tracked separately.
+    return gTestRunnerSnapshots
+        && gTestRunnerHeadless
+        && STATE->trials != 0
+        && STATE->runTrial == 0
+        && STATE->snapshot == NULL
+        && !STATE->setupUsedRng
+        && gTestRunnerState.result == TEST_RESULT_PASS
+        && memcmp(&gRngValue, &seed, sizeof(seed)) == 0;
+}
+
+static void CaptureSnapshot(void)
+{
+    struct BattleTestSnapshot *snapshot;
+    struct MemBlock *head = (struct MemBlock *)gHeap;
+    struct MemBlock *block;
+    u32 ewramSize = __battle_snapshot_ewram_end - __battle_snapshot_ewram_start;
+    u32 iwramSize = __battle_snapshot_iwram_end - __battle_snapshot_iwram_start;
+    u32 size, freeSize;
+    u8 *dest;
+
+    // Allocating the snapshot adds at most one block.
+    size = sizeof(*snapshot) + ewramSize + iwramSize + sizeof(struct MemBlock) + sizeof(u32);
+    freeSize = 0;
+    block = head;
+    do
+    {
+        size += sizeof(struct MemBlock) + sizeof(u32) + SnapshotBlockDataSize(block);
+        if (!block->allocated)
+            freeSize += block->size;
+        block = block->next;
+    } while (block != head);
+
+    if (size + SNAPSHOT_HEAP_MARGIN > freeSize)
+        return;
+    if (!(snapshot = Alloc(size)))
+        return;
+
+    snapshot->setupFrames = gMain.vblankCounter1 - STATE->setupStartFrame;
+    snapshot->callback1 = gMain.callback1;
+    snapshot->callback2 = gMain.callback2;
+    snapshot->vblankCallback = gMain.vblankCallback;
+    snapshot->hblankCallback = gMain.hblankCallback;
+    snapshot->vcountCallback = gMain.vcountCallback;
+    snapshot->inBattle = gMain.inBattle;
+    snapshot->queuedEvent = DATA.queuedEvent;
+    snapshot->lastActionTurn = DATA.lastActionTurn;
+
+    dest = snapshot->data;
+    memcpy(dest, __battle_snapshot_ewram_start, ewramSize);
+    dest += ewramSize;
+    memcpy(dest, __battle_snapshot_iwram_start, iwramSize);
+    dest += iwramSize;
+    block = head;
+    do
+    {
+        u32 dataSize = (void *)block->data == (void *)snapshot ? 0 : SnapshotBlockDataSize(block);
+        memcpy(dest, block, sizeof(struct MemBlock));
+        dest += sizeof(struct MemBlock);
+        memcpy(dest, &dataSize, sizeof(dataSize));
+        dest += sizeof(dataSize);
+        memcpy(dest, block->data, dataSize);
+        dest += dataSize;
+        block = block->next;
+    } while (block != head);
+
+    STATE->snapshot = snapshot;
+}
+
+// The heap blocks are only restored if the previous trial freed
+// everything, otherwise its leftovers would be overwritten.
+static bool32 CanRestoreSnapshot(void)
+{
+    struct MemBlock *head = (struct MemBlock *)gHeap;
+    struct MemBlock *block = head;
+
+    if (STATE->snapshot == NULL)
+        return FALSE;
+
+    do
+    {
+        if (block->allocated && (void *)block->data != (void *)STATE->snapshot)
+            return FALSE;
+        block = block->next;
+    } while (block != head);
+    return TRUE;
+}
+
+static void RestoreSnapshot(void)
+{
+    const struct BattleTestSnapshot *snapshot = STATE->snapshot;
+    struct MemBlock *head = (struct MemBlock *)gHeap;
+    struct MemBlock *block;
+    const u8 *src;
+    u32 ewramSize = __battle_snapshot_ewram_end - __battle_snapshot_ewram_start;
+    u32 iwramSize = __battle_snapshot_iwram_end - __battle_snapshot_iwram_start;
+
+    src = snapshot->data;
+    memcpy(__battle_snapshot_ewram_start, src, ewramSize);
+    src += ewramSize;
+    memcpy(__battle_snapshot_iwram_start, src, iwramSize);
+    src += iwramSize;
+    block = head;
+    do
+    {
+        u32 dataSize;
+        memcpy(block, src, sizeof(struct MemBlock));
+        src += sizeof(struct MemBlock);
+        memcpy(&dataSize, src, sizeof(dataSize));
+        src += sizeof(dataSize);
+        memcpy(block->data, src, dataSize);
+        src += dataSize;
+        block = block->next;
+    } while (block != head);
+    // The free lists are kept in the free blocks, which aren't restored.
+    RebuildHeapFreeLists();
+
+    gMain.callback1 = snapshot->callback1;
+    gMain.callback2 = snapshot->callback2;
+    SetVBlankCallback(snapshot->vblankCallback);
+    SetHBlankCallback(snapshot->hblankCallback);
+    SetVCountCallback(snapshot->vcountCallback);
+    gMain.inBattle = snapshot->inBattle;
+    DATA.queuedEvent = snapshot->queuedEvent;
+    DATA.lastActionTurn = snapshot->lastActionTurn;
+
+    gRecordedBattleRngSeed = gRngValue = DATA.recordedBattle.rngSeed;
+    MgbaPrintf_(":S%d", snapshot->setupFrames);
+}
+
+static void FreeSnapshot(void)
+{
+    TRY_FREE_AND_SET_NULL(STATE->snapshot);
+}
+
+// Captures the snapshot once the frame in which the first turn is set
+// up has finished.
+static void CB2_BattleTest_CaptureSnapshot(void)
+{
+    BattleMainCB2();
+    if (gMain.callback2 == CB2_BattleTest_CaptureSnapshot)
+    {
+        gMain.callback2 = BattleMainCB2;
+        CaptureSnapshot();
+    }
+}
+
+void TestRunner_Battle_BeforeFirstTurn(void)
+{
+    if (gMain.callback2 == BattleMainCB2 && ShouldCaptureSnapshot())
+        gMain.callback2 = CB2_BattleTest_CaptureSnapshot;
+}
+
 static void CB2_BattleTest_NextParameter(void)
 {
     if (++STATE->runParameter >= STATE->parameters)
@@ -1418,10 +1708,19 @@ static void CB2_BattleTest_NextTrial(void)
         DATA.queuedEvent = 0;
         DATA.lastActionTurn = 0;
         SetVariablesForRecordedBattle(&DATA.recordedBattle);
-        SetMainCallback2(CB2_InitBattle);
+        if (CanRestoreSnapshot())
+        {
+            RestoreSnapshot();
+        }
+        else
+        {
+            SetMainCallback2(CB2_InitBattle);
+            STATE->setupStartFrame = gMain.vblankCounter1;
+        }
     }
     else
     {
+        FreeSnapshot();
         // This is a tolerance of +/- ~2%.
         if (abs(STATE->observedRatio - STATE->expectedRatio) <= Q_4_12(0.02))
             gTestRunnerState.result = TEST_RESULT_PASS;
@@ -1435,6 +1734,7 @@ static void BattleTest_TearDown(void *data)
     // Free resources that aren't cleaned up when the battle was
     // aborted unexpectedly.
     ClearFlagAfterTest();
+    FreeSnapshot();
     if (STATE->tearDownBattle)
         TearDownBattle();
 }
@@ -1524,6 +1824,166 @@ const struct TestRunner gBattleTestRunner =
     .handleExitWithResult = BattleTest_HandleExitWithResult,
 };
 
+static void CB2_AiSimulation_NextBattle(void);
+
+static const struct AiSimulationShard *GetAiSimulationShard(void)
+{
+    return gTestRunnerState.test->data;
+}
+
+static void RecordAiSimulationMove(u32 battlerId, u32 moveId)
+{
+    s32 i;
+    u32 side = GetBattlerSide(battlerId);
+    struct AiSimulationMoveUses *moveUses = SIMULATION->moveUses[side];
+
+    for (i = 0; i < SIMULATION->moveUsesCount[side]; i++)
+    {
+        if (moveUses[i].move == moveId)
+        {
+            moveUses[i].count++;
+            return;
+        }
+    }
+
+    // Moves beyond the table are not reported.
+    if (i < MAX_AI_SIMULATION_MOVES)
+    {
+        moveUses[i].move = moveId;
+        moveUses[i].count = 1;
+        SIMULATION->moveUsesCount[side]++;
+    }
+}
+
+static void PrintAiSimulationMoveUses(void)
+{
+    s32 i, side;
+    const char *name = GetAiSimulationShard()->simulation->name;
+
+    for (side = 0; side < NUM_BATTLE_SIDES; side++)
+    {
+        for (i = 0; i < SIMULATION->moveUsesCount[side]; i++)
+            MgbaPrintf_(":M%d %d %s\t%S", side, SIMULATION->moveUses[side][i].count, name, GetMoveName(SIMULATION->moveUses[side][i].move));
+    }
+}
+
+// Battles are dealt out to the shards round-robin.
+static u32 AiSimulation_EstimateCost(void *data)
+{
+    const struct AiSimulationShard *shard = data;
+    if (shard->shard >= shard->simulation->battles)
+        return 1;
+    return (shard->simulation->battles - shard->shard + AI_SIMULATION_SHARDS - 1) / AI_SIMULATION_SHARDS;
+}
+
+static void AiSimulation_SetUp(void *data)
+{
+    const struct AiSimulationShard *shard = data;
+    memset(STATE, 0, sizeof(*STATE));
+    memset(SIMULATION, 0, sizeof(*SIMULATION));
+    SIMULATION->battle = shard->shard;
+}
+
+static void AiSimulation_StartBattle(void)
+{
+    const struct AiSimulation *simulation = GetAiSimulationShard()->simulation;
+
+    MgbaPrintf_(":N%s (%d/%d)", gTestRunnerState.test->name, SIMULATION->battle + 1, simulation->battles);
+
+    // Seeding by the battle index makes each battle reproducible
+    // regardless of which shard or process plays it.
+    gRngValue = MakeRngValue(SIMULATION->battle);
+
+    ZeroPlayerPartyMons();
+    gPartnerTrainerId = simulation->trainerA;
+    CreateNPCTrainerPartyFromTrainer(gPlayerParty, GetTrainerStructFromId(simulation->trainerA), TRUE, BATTLE_TYPE_TRAINER);
+    CalculatePlayerPartyCount();
+
+    gBattleTypeFlags = BATTLE_TYPE_TRAINER;
+    gTrainerBattleOpponent_A = simulation->trainerB;
+    gTrainerBattleOpponent_B = 0;
+
+    gMain.savedCallback = CB2_AiSimulation_NextBattle;
+    SetMainCallback2(CB2_InitBattle);
+}
+
+static void AiSimulation_Run(void *data)
+{
+    const struct AiSimulationShard *shard = data;
+    if (SIMULATION->battle < shard->simulation->battles)
+        AiSimulation_StartBattle();
+}
+
+static void CB2_AiSimulation_NextBattle(void)
+{
+    u32 outcome;
+    const struct AiSimulation *simulation = GetAiSimulationShard()->simulation;
+
+    TearDownBattle();
+
+    switch (gBattleOutcome & ~B_OUTCOME_LINK_BATTLE_RAN)
+    {
+    case B_OUTCOME_WON:
+        outcome = 0;
+        break;
+    case B_OUTCOME_LOST:
+        outcome = 1;
+        break;
+    default:
+        outcome = 2;
+        break;
+    }
+    MgbaPrintf_(":W%d %d %s", outcome, gBattleResults.battleTurnCounter, simulation->name);
+
+    SIMULATION->battle += AI_SIMULATION_SHARDS;
+    if (SIMULATION->battle < simulation->battles)
+    {
+        AiSimulation_StartBattle();
+    }
+    else
+    {
+        PrintAiSimulationMoveUses();
+        SetMainCallback2(CB2_TestRunner);
+    }
+}
+
+static void AiSimulation_TearDown(void *data)
+{
+    if (STATE->tearDownBattle)
+        TearDownBattle();
+}
+
+static bool32 AiSimulation_CheckProgress(void *data)
+{
+    bool32 madeProgress
+         = SIMULATION->checkProgressBattle != SIMULATION->battle
+        || SIMULATION->checkProgressTurn != gBattleResults.battleTurnCounter;
+    SIMULATION->checkProgressBattle = SIMULATION->battle;
+    SIMULATION->checkProgressTurn = gBattleResults.battleTurnCounter;
+    return madeProgress;
+}
+
+static bool32 AiSimulation_HandleExitWithResult(void *data, enum TestResult result)
+{
+    STATE->tearDownBattle = TRUE;
+    return FALSE;
+}
+
+const struct TestRunner gAiSimulationRunner =
+{
+    .estimateCost = AiSimulation_EstimateCost,
+    .setUp = AiSimulation_SetUp,
+    .run = AiSimulation_Run,
+    .tearDown = AiSimulation_TearDown,
+    .checkProgress = AiSimulation_CheckProgress,
+    .handleExitWithResult = AiSimulation_HandleExitWithResult,
+};
+
+bool32 TestRunner_Battle_IsAiVsAiBattle(void)
+{
+    return IsAiSimulation();
+}
+
 void SetFlagForTest(u32 sourceLine, u16 flagId)
 {
     INVALID_IF(DATA.flagId != 0, "FLAG can only be set once per test");
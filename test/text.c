@@ -0,0 +1,211 @@
+#include "global.h"
+#include "item.h"
+#include "malloc.h"
+#include "menu.h"
+#include "text.h"
+#include "window.h"
+#include "test/test.h"
+
+#define TEST_WINDOW_WIDTH 20
+#define TEST_WINDOW_HEIGHT 2
+#define TEST_WINDOW_SIZE (TEST_WINDOW_WIDTH * TEST_WINDOW_HEIGHT * TILE_SIZE_4BPP)
+
+static const u8 sTextColors[] = {TEXT_COLOR_WHITE, TEXT_COLOR_DARK_GRAY, TEXT_COLOR_LIGHT_GRAY};
+static const u8 sAltTextColors[] = {TEXT_COLOR_WHITE, TEXT_COLOR_RED, TEXT_COLOR_LIGHT_RED};
+static const u8 sText[] = _("The quick brown fox jumps over");
+
+// Points window 1 at a fresh buffer filled with the background color.
+static u8 *SetUpTestWindow(const u8 *color)
+{
+    gWindows[1].window.width = TEST_WINDOW_WIDTH;
+    gWindows[1].window.height = TEST_WINDOW_HEIGHT;
+    gWindows[1].tileData = Alloc(TEST_WINDOW_SIZE);
+    FillWindowPixelBuffer(1, PIXEL_FILL(color[0]));
+    return gWindows[1].tileData;
+}
+
+static void PrintTestText(const u8 *color, u32 x)
+{
+    AddTextPrinterParameterized3(1, FONT_NORMAL, x, 0, color, TEXT_SKIP_DRAW, sText);
+}
+
+TEST("Text printed from cached glyphs matches decompressed glyphs")
+{
+    struct Window window = gWindows[1];
+    struct GlyphCacheStats before, after;
+    u8 *first, *alt, *second;
+
+    SetDefaultFontsPointer();
+    ClearGlyphCache();
+    first = SetUpTestWindow(sTextColors);
+    PrintTestText(sTextColors, 0);
+    alt = SetUpTestWindow(sAltTextColors);
+    PrintTestText(sAltTextColors, 0);
+    second = SetUpTestWindow(sTextColors);
+    GetGlyphCacheStats(&before);
+    PrintTestText(sTextColors, 0);
+    GetGlyphCacheStats(&after);
+
+    EXPECT_EQ(after.misses, before.misses);
+    EXPECT(memcmp(first, second, TEST_WINDOW_SIZE) == 0);
+    EXPECT(memcmp(first, alt, TEST_WINDOW_SIZE) != 0);
+
+    Free(first);
+    Free(alt);
+    Free(second);
+    gWindows[1] = window;
+}
+
+TEST("Printing text again loads its glyphs from the cache")
+{
+    struct Window window = gWindows[1];
+    struct GlyphCacheStats first, second;
+    u8 *tiles;
+
+    SetDefaultFontsPointer();
+    tiles = SetUpTestWindow(sTextColors);
+    ClearGlyphCache();
+    AddTextPrinterParameterized3(1, FONT_NORMAL, 0, 0, sTextColors, TEXT_SKIP_DRAW, COMPOUND_STRING("Hello"));
+    GetGlyphCacheStats(&first);
+    AddTextPrinterParameterized3(1, FONT_NORMAL, 0, 0, sTextColors, TEXT_SKIP_DRAW, COMPOUND_STRING("Hello"));
+    GetGlyphCacheStats(&second);
+
+    EXPECT_EQ(first.misses, 4);
+    EXPECT_EQ(first.hits, 1);
+    EXPECT_EQ(second.misses, first.misses);
+    EXPECT_EQ(second.hits, first.hits + 5);
+    EXPECT_EQ(second.evictions, 0);
+
+    Free(tiles);
+    gWindows[1] = window;
+}
+
+TEST("A full glyph cache set replaces its least recently used glyph")
+{
+    struct Window window = gWindows[1];
+    struct GlyphCacheStats filled, stillCached, evicted;
+    u8 *tiles;
+
+    // These glyph ids are 16 apart, so they all go in the same set.
+    SetDefaultFontsPointer();
+    tiles = SetUpTestWindow(sTextColors);
+    ClearGlyphCache();
+    AddTextPrinterParameterized3(1, FONT_NORMAL, 0, 0, sTextColors, TEXT_SKIP_DRAW, COMPOUND_STRING("4Kaq="));
+    GetGlyphCacheStats(&filled);
+    AddTextPrinterParameterized3(1, FONT_NORMAL, 0, 0, sTextColors, TEXT_SKIP_DRAW, COMPOUND_STRING("K"));
+    GetGlyphCacheStats(&stillCached);
+    AddTextPrinterParameterized3(1, FONT_NORMAL, 0, 0, sTextColors, TEXT_SKIP_DRAW, COMPOUND_STRING("4"));
+    GetGlyphCacheStats(&evicted);
+
+    EXPECT_EQ(filled.misses, 5);
+    EXPECT_EQ(filled.evictions, 1);
+    EXPECT_EQ(stillCached.hits, filled.hits + 1);
+    EXPECT_EQ(evicted.misses, filled.misses + 1);
+    EXPECT_EQ(evicted.evictions, filled.evictions + 1);
+
+    Free(tiles);
+    gWindows[1] = window;
+}
+
+TEST("Redrawing a page of the bag's item list only hits the glyph cache")
+{
+    struct Window window = gWindows[1];
+    struct GlyphCacheStats first, second;
+    u32 i, redraw;
+    u8 *tiles;
+
+    // One page of the Medicine pocket, printed like the bag's list menu does.
+    SetDefaultFontsPointer();
+    tiles = SetUpTestWindow(sTextColors);
+    ClearGlyphCache();
+    for (redraw = 0; redraw < 2; redraw++)
+    {
+        for (i = 0; i < 8; i++)
+            AddTextPrinterParameterized3(1, FONT_NARROW, 8, 0, sTextColors, TEXT_SKIP_DRAW, ItemId_GetName(ITEM_POTION + i));
+        GetGlyphCacheStats(redraw == 0 ? &first : &second);
+    }
+
+    EXPECT_EQ(second.misses, first.misses);
+    EXPECT_EQ(second.evictions, first.evictions);
+
+    Free(tiles);
+    gWindows[1] = window;
+}
+
+TEST("Reprinting text from the glyph cache is faster than decompressing it")
+{
+    struct Window window = gWindows[1];
+    struct Benchmark uncached, cached;
+    u8 *tiles;
+
+    SetDefaultFontsPointer();
+    tiles = SetUpTestWindow(sTextColors);
+    ClearGlyphCache();
+    BENCHMARK(&uncached)
+    {
+        PrintTestText(sTextColors, 0);
+    }
+
+    BENCHMARK(&cached)
+    {
+        PrintTestText(sTextColors, 0);
+    }
+
+    EXPECT_FASTER(cached, uncached);
+    Free(tiles);
+    gWindows[1] = window;
+}
+
+TEST("Prerendered text blits the same pixels as printing it")
+{
+    struct Window window = gWindows[1];
+    struct PrerenderedText text;
+    u32 x;
+    PARAMETRIZE { x = 0; }
+    PARAMETRIZE { x = 8; }
+    PARAMETRIZE { x = 3; }
+
+    SetDefaultFontsPointer();
+    EXPECT(PrerenderText(&text, FONT_NORMAL, sTextColors, sText));
+    {
+        u8 *printed = SetUpTestWindow(sTextColors);
+        u8 *blitted;
+        PrintTestText(sTextColors, x);
+        blitted = SetUpTestWindow(sTextColors);
+        BlitPrerenderedText(&text, 1, x, 0);
+
+        EXPECT(memcmp(printed, blitted, TEST_WINDOW_SIZE) == 0);
+
+        Free(printed);
+        Free(blitted);
+    }
+    FreePrerenderedText(&text);
+    gWindows[1] = window;
+}
+
+TEST("Blitting prerendered text is faster than printing it")
+{
+    struct Window window = gWindows[1];
+    struct Benchmark printing, blitting;
+    struct PrerenderedText text;
+    u8 *tiles;
+
+    SetDefaultFontsPointer();
+    tiles = SetUpTestWindow(sTextColors);
+    PrintTestText(sTextColors, 0);
+    BENCHMARK(&printing)
+    {
+        PrintTestText(sTextColors, 0);
+    }
+
+    PrerenderText(&text, FONT_NORMAL, sTextColors, sText);
+    BENCHMARK(&blitting)
+    {
+        BlitPrerenderedText(&text, 1, 0, 0);
+    }
+
+    EXPECT_FASTER(blitting, printing);
+    FreePrerenderedText(&text);
+    Free(tiles);
+    gWindows[1] = window;
+}
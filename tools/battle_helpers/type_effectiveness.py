@@ -0,0 +1,142 @@
+import itertools
+import re
+import sys
+
+# Generates the effectiveness of each attacking type against each pair of
+# defending types from sTypeEffectivenessTable, so that a dual-typed
+# defender costs a single lookup instead of one per type. The table is
+# emitted for normal and inverse battles, and once for every combination
+# of the preprocessor conditions found in sTypeEffectivenessTable.
+#
+# usage: type_effectiveness.py <battle_util.c> <pokemon.h> <output.h>
+
+if len(sys.argv) != 4:
+    print("usage: %s <battle_util.c> <pokemon.h> <output.h>" % sys.argv[0], file=sys.stderr)
+    sys.exit(1)
+
+source_path = sys.argv[1]
+constants_path = sys.argv[2]
+output_path = sys.argv[3]
+
+UQ_4_12_SHIFT = 12
+
+type_define = re.compile(r"^#define (TYPE_\w+)\s+(\d+)")
+types = {}
+with open(constants_path, "r") as file:
+    for line in file:
+        match = type_define.match(line)
+        if match and match.group(1) != "TYPE_NONE":
+            types[match.group(1)] = int(match.group(2))
+        elif line.startswith("#define NUMBER_OF_MON_TYPES"):
+            type_count = int(line.split()[2])
+
+with open(source_path, "r") as file:
+    lines = file.read().split("\n")
+
+start = next(i for i, line in enumerate(lines) if line.startswith("static const uq4_12_t sTypeEffectivenessTable["))
+row_entry = re.compile(r"^\s*\[(TYPE_\w+)\]\s*=\s*\{(.*)\},\s*$")
+
+def parse_value(value):
+    value = value.strip()
+    if value == "______":
+        return 1 << UQ_4_12_SHIFT
+    match = re.match(r"^X\(([\d.]+)\)$", value)
+    if not match:
+        print("%s: can't parse type effectiveness '%s'" % (source_path, value), file=sys.stderr)
+        sys.exit(1)
+    return int(float(match.group(1)) * (1 << UQ_4_12_SHIFT))
+
+# Each row is (conditions, attacking type, values), where conditions is a
+# list of (condition, required value) pairs.
+rows = []
+conditions = []
+stack = []
+for line in lines[start + 1:]:
+    stripped = line.strip()
+    if stripped == "};":
+        break
+    if stripped.startswith("#if "):
+        condition = stripped[4:].strip()
+        if condition not in conditions:
+            conditions.append(condition)
+        stack.append([condition, True])
+    elif stripped.startswith("#else"):
+        stack[-1][1] = False
+    elif stripped.startswith("#endif"):
+        stack.pop()
+    else:
+        match = row_entry.match(line)
+        if match:
+            values = [parse_value(value) for value in match.group(2).split(",")]
+            if len(values) != type_count:
+                print("%s: %s has %d entries instead of %d" % (source_path, match.group(1), len(values), type_count), file=sys.stderr)
+                sys.exit(1)
+            rows.append(([tuple(entry) for entry in stack], types[match.group(1)], values))
+
+def multiply(a, b):
+    return (a * b + (1 << (UQ_4_12_SHIFT - 1))) >> UQ_4_12_SHIFT
+
+# Matches GetInverseTypeMultiplier.
+def inverse(value):
+    if value == 0 or value == 1 << (UQ_4_12_SHIFT - 1):
+        return 2 << UQ_4_12_SHIFT
+    if value == 2 << UQ_4_12_SHIFT:
+        return 1 << (UQ_4_12_SHIFT - 1)
+    return 1 << UQ_4_12_SHIFT
+
+def dual_table(chart, invert):
+    table = []
+    for atk in range(type_count):
+        for def1 in range(type_count):
+            entries = []
+            for def2 in range(type_count):
+                mod1 = chart[atk][def1]
+                mod2 = chart[atk][def2]
+                if invert:
+                    mod1 = inverse(mod1)
+                    mod2 = inverse(mod2)
+                # Matches MulByTypeEffectiveness, which doesn't count a repeated type twice.
+                value = multiply(1 << UQ_4_12_SHIFT, mod1)
+                if def2 != def1:
+                    value = multiply(value, mod2)
+                entries.append(value)
+            table.append(entries)
+    return table
+
+out = []
+out.append("//")
+out.append("// DO NOT MODIFY THIS FILE! It is auto-generated from %s" % source_path)
+out.append("// by tools/battle_helpers/type_effectiveness.py")
+out.append("//")
+out.append("")
+out.append("// Effectiveness of each attacking type against a defender's first and second type,")
+out.append("// [inverse battle][attacking type][type 1][type 2]. Read it through GetDualTypeModifier.")
+
+combinations = list(itertools.product([True, False], repeat=len(conditions)))
+for index, combination in enumerate(combinations):
+    values = dict(zip(conditions, combination))
+    if conditions:
+        expression = " && ".join(("(%s)" if value else "!(%s)") % condition for condition, value in values.items())
+        out.append("%s %s" % ("#if" if index == 0 else "#elif", expression))
+    chart = [[1 << UQ_4_12_SHIFT] * type_count for i in range(type_count)]
+    for row_conditions, atk, row in rows:
+        if all(values[condition] == required for condition, required in row_conditions):
+            chart[atk] = row
+    out.append("static const u16 sDualTypeEffectivenessTable[2][NUMBER_OF_MON_TYPES][NUMBER_OF_MON_TYPES][NUMBER_OF_MON_TYPES] =")
+    out.append("{")
+    for invert in (False, True):
+        out.append("    {")
+        table = dual_table(chart, invert)
+        for atk in range(type_count):
+            out.append("        {")
+            for def1 in range(type_count):
+                out.append("            {%s}," % ", ".join("0x%04X" % value for value in table[atk * type_count + def1]))
+            out.append("        },")
+        out.append("    },")
+    out.append("};")
+if conditions:
+    out.append("#endif")
+out.append("")
+
+with open(output_path, "w") as file:
+    file.write("\n".join(out))
@@ -0,0 +1,98 @@
+import re
+import sys
+
+# Generates a bitset of each teachable learnset's moves, so that checking
+# whether a species can be taught a move does not have to scan its
+# learnset. The learnsets are re-emitted with their bitset immediately
+# before their moves, and the moves are given columns in the bitsets in
+# the order in which they first appear.
+#
+# usage: teachable_bitsets.py <teachable_learnsets.h> <output.h>
+
+if len(sys.argv) != 3:
+    print("usage: %s <teachable_learnsets.h> <output.h>" % sys.argv[0], file=sys.stderr)
+    sys.exit(1)
+
+input_path = sys.argv[1]
+output_path = sys.argv[2]
+
+with open(input_path, "r") as file:
+    lines = file.read().split("\n")
+
+learnset_start = re.compile(r"^static const u16 (s\w+TeachableLearnset)\[\] = \{$")
+move_entry = re.compile(r"^\s*(MOVE_\w+),?\s*(//.*)?$")
+
+# Each item is either a preprocessor or blank line, passed through
+# unchanged so that the learnsets keep their conditions, or a
+# (name, moves) learnset.
+items = []
+columns = {}
+i = 0
+while i < len(lines):
+    line = lines[i]
+    match = learnset_start.match(line)
+    if match:
+        name = match.group(1)
+        moves = []
+        i += 1
+        while lines[i].strip() != "};":
+            entry = move_entry.match(lines[i])
+            if entry:
+                moves.append(entry.group(1))
+            elif lines[i].strip() != "" and not lines[i].strip().startswith("//"):
+                print("%s:%d: unexpected line in %s" % (input_path, i + 1, name), file=sys.stderr)
+                sys.exit(1)
+            i += 1
+        if not moves or moves[-1] != "MOVE_UNAVAILABLE":
+            print("%s: %s does not end with MOVE_UNAVAILABLE" % (input_path, name), file=sys.stderr)
+            sys.exit(1)
+        for move in moves[:-1]:
+            if move not in columns:
+                columns[move] = len(columns)
+        items.append((name, moves))
+    elif line.lstrip().startswith("#") or line.strip() == "":
+        items.append(line.strip() and line)
+    i += 1
+
+words = max(1, (len(columns) + 31) // 32)
+column_type = "u8" if len(columns) < 0xFF else "u16"
+
+out = []
+out.append("//")
+out.append("// DO NOT MODIFY THIS FILE! It is auto-generated from %s" % input_path)
+out.append("// by tools/learnset_helpers/teachable_bitsets.py")
+out.append("//")
+out.append("")
+out.append("#define TEACHABLE_BITSET_WORDS %d" % words)
+out.append("")
+out.append("// Column of each move in the bitsets plus one, or 0 if no learnset has the move.")
+out.append("static const %s sTeachableMoveColumns[MOVES_COUNT_ALL] =" % column_type)
+out.append("{")
+for move, column in columns.items():
+    out.append("    [%s] = %d," % (move, column + 1))
+out.append("};")
+out.append("")
+for item in items:
+    if isinstance(item, str):
+        if item != "" or out[-1] != "":
+            out.append(item)
+        continue
+    name, moves = item
+    bitset = [0] * words
+    for move in moves[:-1]:
+        bitset[columns[move] // 32] |= 1 << (columns[move] % 32)
+    out.append("static const struct { u32 bitset[TEACHABLE_BITSET_WORDS]; u16 moves[%d]; } %sWithBitset =" % (len(moves), name))
+    out.append("{")
+    out.append("    .bitset = { %s }," % ", ".join("0x%08X" % word for word in bitset))
+    out.append("    .moves =")
+    out.append("    {")
+    for move in moves:
+        out.append("        %s," % move)
+    out.append("    },")
+    out.append("};")
+    out.append("#define %s (%sWithBitset.moves)" % (name, name))
+if out[-1] != "":
+    out.append("")
+
+with open(output_path, "w") as file:
+    file.write("\n".join(out))
@@ -13,7 +13,42 @@
  * P/K/F/A: Sets the result to the remaining of the line, flushes any
  *    output since the previous P/K/F/A and increment the number of
  *    passes/known fails/assumption fails/fails.
+ * C: Records the cost in frames of the test named by the remainder of
+ *    the line, in the form "<frames> <name>".
+ * S: Records that a trial restored a snapshot instead of spending the
+ *    remainder of the line in frames setting up its battle.
+ * W: Records the outcome of one battle of an AI simulation, in the form
+ *    "<outcome> <turns> <name>", where outcome is 0 (won), 1 (lost) or
+ *    2 (anything else) from trainer A's side.
+ * M: Records how often a side of an AI simulation chose a move, in the
+ *    form "<side> <count> <name>\t<move>".
+ *
+ * TEST COSTS
+ * If a fourth argument is given, the costs of the tests which ran are
+ * merged into that file, which is included into test/test_runner.c as
+ * a list of TEST_COST(frames, "name") sorted by name. The file is only
+ * rewritten if its contents change.
+ *
+ * BATCHES
+ * With -b, the tests are read from the ELF and handed out in batches
+ * instead of being split between the runners up front. Each runner is
+ * an mgba-rom-test process whose ROM is patched with the range of test
+ * indices to run (gTestRunnerBatchStart/End); when it exits, the runner
+ * is restarted with the next batch. Batches are a share of the
+ * remaining tests, so they shrink towards the end of the run.
+ *
+ * SNAPSHOTS
+ * With -s, battle tests snapshot the state before their first turn and
+ * restore it in later trials (gTestRunnerSnapshots), and the number of
+ * setup frames which that saved is reported at the end.
+ *
+ * SIMULATIONS
+ * The W and M results of each AI simulation are summed over its shards
+ * and reported at the end: the win/loss/draw rates of trainer A with
+ * their 95% Wilson score intervals, the average number of turns, and
+ * the moves chosen by each trainer.
  */
+#include "../patchelf/elf.h"
 #include <fcntl.h>
 #include <math.h>
 #include <poll.h>
@@ -66,6 +101,120 @@ struct Runner
 static unsigned nrunners = 0;
 static unsigned runners_digits = 0;
 static struct Runner *runners = NULL;
+static pid_t parent_pid;
+static int exit_code = 0;
+
+// Indices into the tests section of the tests which batch mode hands
+// out, in order.
+static bool batch_tests = false;
+static bool snapshots = false;
+static unsigned long snapshot_frames_saved = 0;
+static unsigned *batch_test_indices = NULL;
+static size_t batch_test_indices_size = 0;
+static size_t next_batch_test_index = 0;
+
+struct TestCost
+{
+    char *name;
+    unsigned cost;
+    size_t order;
+};
+
+static struct TestCost *test_costs = NULL;
+static size_t test_costs_size = 0;
+static size_t test_costs_capacity = 0;
+
+#define MAX_SIMULATION_MOVES 64
+
+struct SimulationMove
+{
+    char *name;
+    unsigned long count;
+};
+
+struct Simulation
+{
+    char *name;
+    unsigned long battles;
+    unsigned long outcomes[3];
+    unsigned long turns;
+    size_t moves_size[2];
+    struct SimulationMove moves[2][MAX_SIMULATION_MOVES];
+};
+
+static struct Simulation *simulations = NULL;
+static size_t simulations_size = 0;
+
+static void add_test_cost(const char *name, size_t name_length, unsigned cost)
+{
+    if (test_costs_size == test_costs_capacity)
+    {
+        test_costs_capacity = test_costs_capacity ? test_costs_capacity * 2 : 1024;
+        test_costs = realloc(test_costs, test_costs_capacity * sizeof(*test_costs));
+        if (!test_costs)
+        {
+            perror("realloc test_costs failed");
+            exit(2);
+        }
+    }
+    struct TestCost *test_cost = &test_costs[test_costs_size];
+    if (!(test_cost->name = strndup(name, name_length)))
+    {
+        perror("strndup test_cost->name failed");
+        exit(2);
+    }
+    test_cost->cost = cost;
+    test_cost->order = test_costs_size++;
+}
+
+static struct Simulation *find_simulation(const char *name, size_t name_length)
+{
+    for (size_t i = 0; i < simulations_size; i++)
+    {
+        if (strlen(simulations[i].name) == name_length
+         && !strncmp(simulations[i].name, name, name_length))
+            return &simulations[i];
+    }
+    simulations = realloc(simulations, (simulations_size + 1) * sizeof(*simulations));
+    if (!simulations)
+    {
+        perror("realloc simulations failed");
+        exit(2);
+    }
+    struct Simulation *simulation = &simulations[simulations_size++];
+    memset(simulation, 0, sizeof(*simulation));
+    if (!(simulation->name = strndup(name, name_length)))
+    {
+        perror("strndup simulation->name failed");
+        exit(2);
+    }
+    return simulation;
+}
+
+static void add_simulation_move(struct Simulation *simulation, unsigned side, const char *move, size_t move_length, unsigned long count)
+{
+    size_t i;
+    if (side >= 2)
+        return;
+    for (i = 0; i < simulation->moves_size[side]; i++)
+    {
+        if (strlen(simulation->moves[side][i].name) == move_length
+         && !strncmp(simulation->moves[side][i].name, move, move_length))
+        {
+            simulation->moves[side][i].count += count;
+            return;
+        }
+    }
+    if (i == MAX_SIMULATION_MOVES)
+        return;
+    if (!(simulation->moves[side][i].name = strndup(move, move_length)))
+    {
+        perror("strndup move name failed");
+        exit(2);
+    }
+    simulation->moves[side][i].count = count;
+    simulation->moves_size[side]++;
+}
 
 static void handle_read(int i, struct Runner *runner)
 {
@@ -103,6 +252,50 @@ static void handle_read(int i, struct Runner *runner)
                     runner->test_name[eol - soc - 1] = '\0';
                     break;
 
+                case 'C':
+                {
+                    char *name;
+                    unsigned long cost = strtoul(soc + 2, &name, 10);
+                    if (name[0] != ' ' || name + 1 >= eol)
+                        goto buffer_output;
+                    name++;
+                    add_test_cost(name, eol - name - 1, cost);
+                    break;
+                }
+
+                case 'S':
+                    snapshot_frames_saved += strtoul(soc + 2, NULL, 10);
+                    break;
+
+                case 'W':
+                {
+                    char *turns, *name;
+                    unsigned long outcome = strtoul(soc + 2, &turns, 10);
+                    unsigned long turns_ = strtoul(turns, &name, 10);
+                    if (outcome > 2 || name[0] != ' ' || name + 1 >= eol)
+                        goto buffer_output;
+                    name++;
+                    struct Simulation *simulation = find_simulation(name, eol - name - 1);
+                    simulation->battles++;
+                    simulation->outcomes[outcome]++;
+                    simulation->turns += turns_;
+                    break;
+                }
+
+                case 'M':
+                {
+                    char *count, *name, *move;
+                    unsigned long side = strtoul(soc + 2, &count, 10);
+                    unsigned long count_ = strtoul(count, &name, 10);
+                    if (name[0] != ' ' || !(move = memchr(name, '\t', eol - name)))
+                        goto buffer_output;
+                    name++;
+                    struct Simulation *simulation = find_simulation(name, move - name);
+                    move++;
+                    add_simulation_move(simulation, side, move, eol - move - 1, count_);
+                    break;
+                }
+
                 case 'P':
                     runner->passes++;
                     goto add_to_results;
@@ -206,6 +399,344 @@ static void exit2(int _)
     exit(2);
 }
 
+static const void *elf_address(const unsigned char *elf, uint32_t address, uint32_t size)
+{
+    const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)elf;
+    const Elf32_Shdr *shdrs = (const Elf32_Shdr *)(elf + ehdr->e_shoff);
+    for (int i = 0; i < ehdr->e_shnum; i++)
+    {
+        if (!(shdrs[i].sh_flags & SHF_ALLOC) || shdrs[i].sh_type == SHT_NOBITS)
+            continue;
+        if (shdrs[i].sh_addr <= address && address + size <= shdrs[i].sh_addr + shdrs[i].sh_size)
+            return elf + shdrs[i].sh_offset + (address - shdrs[i].sh_addr);
+    }
+    return NULL;
+}
+
+static const char *elf_string(const unsigned char *elf, uint32_t address)
+{
+    // Strings are only compared against prefixes and filenames, so
+    // requiring the first byte to be mapped is enough in practice.
+    return address == 0 ? NULL : elf_address(elf, address, 1);
+}
+
+static bool prefix_match(const char *pattern, const char *string)
+{
+    if (string == NULL)
+        return true;
+    return strncmp(pattern, string, strlen(pattern)) == 0;
+}
+
+// Finds the tests which the runners would run, so that they can be
+// handed out in batches. Mirrors the filtering in test/test_runner.c.
+static void read_batch_tests(const unsigned char *elf)
+{
+    const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)elf;
+    const Elf32_Shdr *shdrs = (const Elf32_Shdr *)(elf + ehdr->e_shoff);
+    const Elf32_Shdr *shdr_symtab = NULL;
+    const Elf32_Shdr *shdr_strtab = NULL;
+    const char *shstr = (const char *)(elf + shdrs[ehdr->e_shstrndx].sh_offset);
+    for (int i = 0; i < ehdr->e_shnum; i++)
+    {
+        const char *sh_name = shstr + shdrs[i].sh_name;
+        if (strcmp(sh_name, ".symtab") == 0)
+            shdr_symtab = &shdrs[i];
+        else if (strcmp(sh_name, ".strtab") == 0)
+            shdr_strtab = &shdrs[i];
+    }
+    if (!shdr_symtab || !shdr_strtab)
+    {
+        fprintf(stderr, "no .symtab or .strtab section, not batching tests\n");
+        batch_tests = false;
+        return;
+    }
+
+    uint32_t start_tests = 0, stop_tests = 0, assumptions_runner = 0, simulation_runner = 0, argv_address = 0, simulations_address = 0;
+    const Elf32_Sym *symtab = (const Elf32_Sym *)(elf + shdr_symtab->sh_offset);
+    const char *strtab = (const char *)(elf + shdr_strtab->sh_offset);
+    for (int i = 0; i < shdr_symtab->sh_size / shdr_symtab->sh_entsize; i++)
+    {
+        if (symtab[i].st_name == 0) continue;
+        const char *st_name = strtab + symtab[i].st_name;
+        if (strcmp(st_name, "__start_tests") == 0)
+            start_tests = symtab[i].st_value;
+        else if (strcmp(st_name, "__stop_tests") == 0)
+            stop_tests = symtab[i].st_value;
+        else if (strcmp(st_name, "gAssumptionsRunner") == 0)
+            assumptions_runner = symtab[i].st_value;
+        else if (strcmp(st_name, "gAiSimulationRunner") == 0)
+            simulation_runner = symtab[i].st_value;
+        else if (strcmp(st_name, "gTestRunnerArgv") == 0)
+            argv_address = symtab[i].st_value;
+        else if (strcmp(st_name, "gTestRunnerSimulations") == 0)
+            simulations_address = symtab[i].st_value;
+    }
+
+    // struct Test is { name, filename, runner, data }.
+    size_t ntests = (stop_tests - start_tests) / (4 * sizeof(uint32_t));
+    const uint32_t *tests = elf_address(elf, start_tests, stop_tests - start_tests);
+    const char *pattern = argv_address ? elf_string(elf, argv_address) : "";
+    const unsigned char *run_simulations = simulations_address ? elf_address(elf, simulations_address, 1) : NULL;
+    if (!tests || !pattern || ntests > 0xFFFF)
+    {
+        fprintf(stderr, "could not read tests, not batching tests\n");
+        batch_tests = false;
+        return;
+    }
+
+    batch_test_indices = malloc(ntests * sizeof(*batch_test_indices));
+    if (!batch_test_indices)
+    {
+        perror("malloc batch_test_indices failed");
+        exit(2);
+    }
+    for (size_t i = 0; i < ntests; i++)
+    {
+        const uint32_t *test = &tests[i * 4];
+        if (test[2] == assumptions_runner)
+            continue;
+        if ((test[2] == simulation_runner) != (run_simulations && *run_simulations))
+            continue;
+        if (!prefix_match(pattern, elf_string(elf, test[0])))
+            continue;
+        batch_test_indices[batch_test_indices_size++] = i;
+    }
+}
+
+// Guided self-scheduling: each batch is a share of the remaining tests,
+// so batches shrink towards the end of the run and idle runners pick up
+// the stragglers instead of waiting on a long static slice.
+static bool next_batch(unsigned *batch_start, unsigned *batch_end)
+{
+    size_t remaining = batch_test_indices_size - next_batch_test_index;
+    if (remaining == 0)
+        return false;
+    size_t size = remaining / (2 * nrunners);
+    if (size == 0)
+        size = 1;
+    *batch_start = batch_test_indices[next_batch_test_index];
+    *batch_end = batch_test_indices[next_batch_test_index + size - 1] + 1;
+    next_batch_test_index += size;
+    return true;
+}
+
+static void reap_runner(int i)
+{
+    int wstatus;
+    if (waitpid(runners[i].pid, &wstatus, 0) == -1)
+    {
+        perror("waitpid runners[i] failed");
+        exit(2);
+    }
+    runners[i].pid = 0;
+    if (runners[i].output_buffer_size > 0)
+    {
+        fwrite(runners[i].output_buffer, 1, runners[i].output_buffer_size, stdout);
+        runners[i].output_buffer_size = 0;
+    }
+    if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) > exit_code)
+        exit_code = WEXITSTATUS(wstatus);
+    if (runners[i].rom_path[0])
+    {
+        if (unlink(runners[i].rom_path) == -1)
+            perror("unlink rom_path failed");
+        runners[i].rom_path[0] = '\0';
+    }
+}
+
+static void start_runner(int i, const char *rom_test, const char *objcopy, const void *elf, size_t elf_size, unsigned batch_start, unsigned batch_end)
+{
+    int pipefds[2];
+    if (pipe(pipefds) == -1)
+    {
+        perror("pipe failed");
+        exit(2);
+    }
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork mgba-rom-test failed");
+        exit(2);
+    } else if (pid == 0) {
+        #ifndef __APPLE__
+        if (prctl(PR_SET_PDEATHSIG, SIGTERM) == -1)
+        {
+            perror("prctl failed");
+            _exit(2);
+        }
+        #endif
+        if (getppid() != parent_pid) // Parent died.
+        {
+            _exit(2);
+        }
+        if (close(pipefds[0]) == -1)
+        {
+            perror("close pipefds[0] failed");
+            _exit(2);
+        }
+        if (dup2(pipefds[1], STDOUT_FILENO) == -1)
+        {
+            perror("dup2 stdout failed");
+            _exit(2);
+        }
+        if (close(pipefds[1]) == -1)
+        {
+            perror("close pipefds[1] failed");
+            _exit(2);
+        }
+        char rom_path[FILENAME_MAX];
+        sprintf(rom_path, "/tmp/mgba-rom-test-hydra-%05d", getpid());
+        int tmpfd;
+        if ((tmpfd = open(rom_path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR)) == -1)
+        {
+            perror("open tmpfd failed");
+            _exit(2);
+        }
+        if ((write(tmpfd, elf, elf_size)) == -1)
+        {
+            perror("write tmpfd failed");
+            _exit(2);
+        }
+        pid_t patchelfpid = fork();
+        if (patchelfpid == -1)
+        {
+            perror("fork patchelf failed");
+            _exit(2);
+        }
+        else if (patchelfpid == 0)
+        {
+            char n_arg[5], i_arg[5], start_arg[9], end_arg[9];
+            if (batch_end != 0)
+            {
+                snprintf(n_arg, sizeof(n_arg), "\\x%02x", 1);
+                snprintf(i_arg, sizeof(i_arg), "\\x%02x", 0);
+            }
+            else
+            {
+                snprintf(n_arg, sizeof(n_arg), "\\x%02x", nrunners);
+                snprintf(i_arg, sizeof(i_arg), "\\x%02x", i);
+            }
+            snprintf(start_arg, sizeof(start_arg), "\\x%02x\\x%02x", batch_start & 0xFF, (batch_start >> 8) & 0xFF);
+            snprintf(end_arg, sizeof(end_arg), "\\x%02x\\x%02x", batch_end & 0xFF, (batch_end >> 8) & 0xFF);
+            if (execlp("tools/patchelf/patchelf", "tools/patchelf/patchelf", rom_path, "gTestRunnerN", n_arg, "gTestRunnerI", i_arg, "gTestRunnerBatchStart", start_arg, "gTestRunnerBatchEnd", end_arg, "gTestRunnerSnapshots", snapshots ? "\\x01" : "\\x00", NULL) == -1)
+            {
+                perror("execlp patchelf failed");
+                _exit(2);
+            }
+        }
+        else
+        {
+            int wstatus;
+            if (waitpid(patchelfpid, &wstatus, 0) == -1)
+            {
+                perror("waitpid patchelfpid failed");
+                _exit(2);
+            }
+            if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
+            {
+                fprintf(stderr, "patchelf exited with an error\n");
+                _exit(2);
+            }
+        }
+#ifdef __APPLE__
+        pid_t objcopypid = fork();
+        if (objcopypid == -1)
+        {
+            perror("fork objcopy failed");
+            _exit(2);
+        }
+        else if (objcopypid == 0)
+        {
+            if (execlp(objcopy, objcopy, "-O", "binary", rom_path, rom_path, NULL) == -1)
+            {
+                perror("execlp objcopy failed");
+                _exit(2);
+            }
+        }
+        else
+        {
+            int wstatus;
+            if (waitpid(objcopypid, &wstatus, 0) == -1)
+            {
+                perror("waitpid objcopy failed");
+                _exit(2);
+            }
+            if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
+            {
+                fprintf(stderr, "objcopy exited with an error\n");
+                _exit(2);
+            }
+        }
+#endif
+        // stdbuf is required because otherwise mgba never flushes
+        // stdout.
+        if (execlp("stdbuf", "stdbuf", "-oL", rom_test, "-l15", "-ClogLevel.gba.dma=16", "-Rr0", rom_path, NULL) == -1)
+        {
+            perror("execl stdbuf mgba-rom-test failed");
+            _exit(2);
+        }
+    } else {
+        runners[i].pid = pid;
+        sprintf(runners[i].rom_path, "/tmp/mgba-rom-test-hydra-%05d", runners[i].pid);
+        runners[i].outfd = pipefds[0];
+        runners[i].input_buffer_size = 0;
+        if (close(pipefds[1]) == -1)
+        {
+            perror("close pipefds[1] failed");
+            exit(2);
+        }
+    }
+}
+
+static int compare_simulation_moves(const void *a, const void *b)
+{
+    const struct SimulationMove *move_a = a, *move_b = b;
+    if (move_a->count != move_b->count)
+        return move_a->count < move_b->count ? 1 : -1;
+    return strcmp(move_a->name, move_b->name);
+}
+
+// Wilson score interval, which unlike the normal approximation stays
+// within [0, 1] and is still meaningful when few battles are lost.
+static void wilson_interval(unsigned long successes, unsigned long trials, double *lo, double *hi)
+{
+    const double z = 1.959964;
+    double p = (double)successes / trials;
+    double denominator = 1 + z * z / trials;
+    double centre = (p + z * z / (2 * trials)) / denominator;
+    double spread = z * sqrt(p * (1 - p) / trials + z * z / (4.0 * trials * trials)) / denominator;
+    *lo = centre - spread;
+    *hi = centre + spread;
+}
+
+static void print_simulations(void)
+{
+    static const char *outcome_names[] = { "Wins", "Losses", "Draws" };
+    static const char *side_names[] = { "A", "B" };
+    for (size_t i = 0; i < simulations_size; i++)
+    {
+        struct Simulation *simulation = &simulations[i];
+        if (simulation->battles == 0)
+            continue;
+        fprintf(stdout, "- Simulation \e[34m%s\e[0m: %lu battles, %.1f turns on average\n", simulation->name, simulation->battles, (double)simulation->turns / simulation->battles);
+        for (int outcome = 0; outcome < 3; outcome++)
+        {
+            double lo, hi;
+            wilson_interval(simulation->outcomes[outcome], simulation->battles, &lo, &hi);
+            fprintf(stdout, "  - %-6s %5lu  %5.1f%% (95%% CI %.1f%%-%.1f%%)\n", outcome_names[outcome], simulation->outcomes[outcome], 100.0 * simulation->outcomes[outcome] / simulation->battles, 100.0 * lo, 100.0 * hi);
+        }
+        for (int side = 0; side < 2; side++)
+        {
+            if (simulation->moves_size[side] == 0)
+                continue;
+            qsort(simulation->moves[side], simulation->moves_size[side], sizeof(simulation->moves[side][0]), compare_simulation_moves);
+            fprintf(stdout, "  - Trainer %s moves:", side_names[side]);
+            for (size_t j = 0; j < simulation->moves_size[side]; j++)
+                fprintf(stdout, "%s %s (%lu)", j == 0 ? "" : ",", simulation->moves[side][j].name, simulation->moves[side][j].count);
+            fprintf(stdout, "\n");
+        }
+    }
+}
+
 int compare_strings(const void * a, const void * b)
 {
     const char *arg1 = (const char *) a;
@@ -214,14 +745,126 @@ int compare_strings(const void * a, const void * b)
     return strcmp(arg1, arg2);
 }
 
+static int compare_test_costs(const void *a, const void *b)
+{
+    const struct TestCost *arg1 = a;
+    const struct TestCost *arg2 = b;
+    int cmp = strcmp(arg1->name, arg2->name);
+    if (cmp != 0)
+        return cmp;
+    return arg1->order < arg2->order ? -1 : arg1->order > arg2->order;
+}
+
+static void read_test_costs(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return;
+
+    char line[1024];
+    while (fgets(line, sizeof(line), f))
+    {
+        unsigned cost;
+        int n = 0;
+        if (sscanf(line, "TEST_COST(%u, \"%n", &cost, &n) != 1 || n == 0)
+            continue;
+
+        char name[MAX_TEST_LIST_BUFFER_LENGTH];
+        size_t name_length = 0;
+        for (const char *p = line + n; *p && *p != '"' && name_length < sizeof(name); p++)
+        {
+            if (*p == '\\' && p[1])
+                p++;
+            name[name_length++] = *p;
+        }
+        add_test_cost(name, name_length, cost);
+    }
+
+    fclose(f);
+}
+
+static void write_test_costs(const char *path)
+{
+    // test/test_runner.c cannot include an empty list.
+    if (test_costs_size == 0)
+        return;
+
+    qsort(test_costs, test_costs_size, sizeof(*test_costs), compare_test_costs);
+
+    char *contents = NULL;
+    size_t contents_size = 0;
+    FILE *f = open_memstream(&contents, &contents_size);
+    if (!f)
+    {
+        perror("open_memstream test_costs failed");
+        exit(2);
+    }
+    for (size_t i = 0; i < test_costs_size; i++)
+    {
+        // Later costs replace earlier ones.
+        if (i + 1 < test_costs_size && !strcmp(test_costs[i].name, test_costs[i + 1].name))
+            continue;
+        fprintf(f, "TEST_COST(%u, \"", test_costs[i].cost);
+        for (const char *p = test_costs[i].name; *p; p++)
+        {
+            if (*p == '"' || *p == '\\')
+                fputc('\\', f);
+            fputc(*p, f);
+        }
+        fprintf(f, "\")\n");
+    }
+    fclose(f);
+
+    FILE *old = fopen(path, "r");
+    if (old)
+    {
+        bool same = true;
+        for (size_t i = 0; i < contents_size && same; i++)
+            same = fgetc(old) == (unsigned char)contents[i];
+        same = same && fgetc(old) == EOF;
+        fclose(old);
+        if (same)
+        {
+            free(contents);
+            return;
+        }
+    }
+
+    if (!(f = fopen(path, "w")))
+    {
+        perror("fopen test_costs failed");
+        exit(2);
+    }
+    fwrite(contents, 1, contents_size, f);
+    fclose(f);
+    free(contents);
+}
+
 int main(int argc, char *argv[])
 {
+    while (argc > 1 && argv[1][0] == '-')
+    {
+        if (strcmp(argv[1], "-b") == 0)
+            batch_tests = true;
+        else if (strcmp(argv[1], "-s") == 0)
+            snapshots = true;
+        else
+            break;
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+
     if (argc < 4)
     {
-        fprintf(stderr, "usage %s mgba-rom-test objcopy rom\n", argv[0]);
+        fprintf(stderr, "usage %s [-b] [-s] mgba-rom-test objcopy rom [test-costs]\n", argv[0]);
         exit(2);
     }
 
+    const char *test_costs_path = argc > 4 ? argv[4] : NULL;
+    if (test_costs_path)
+        read_test_costs(test_costs_path);
+
     bool tty = isatty(STDOUT_FILENO);
     if (!tty)
     {
@@ -265,6 +908,9 @@ int main(int argc, char *argv[])
         exit(2);
     }
 
+    if (batch_tests)
+        read_batch_tests(elf);
+
     nrunners = 1;
     const char *makeflags = getenv("MAKEFLAGS");
     if (makeflags)
@@ -313,152 +959,31 @@ int main(int argc, char *argv[])
     signal(SIGTERM, exit2);
 
     // Start test runners.
-    pid_t parent_pid = getpid();
-    for (int i = 0; i < nrunners; i++)
-    {
-        int pipefds[2];
-        if (pipe(pipefds) == -1)
-        {
-            perror("pipe failed");
-            exit(2);
-        }
-        pid_t pid = fork();
-        if (pid == -1) {
-            perror("fork mgba-rom-test failed");
-            exit(2);
-        } else if (pid == 0) {
-            #ifndef __APPLE__
-            if (prctl(PR_SET_PDEATHSIG, SIGTERM) == -1)
-            {
-                perror("prctl failed");
-                _exit(2);
-            }
-            #endif
-            if (getppid() != parent_pid) // Parent died.
-            {
-                _exit(2);
-            }
-            if (close(pipefds[0]) == -1)
-            {
-                perror("close pipefds[0] failed");
-                _exit(2);
-            }
-            if (dup2(pipefds[1], STDOUT_FILENO) == -1)
-            {
-                perror("dup2 stdout failed");
-                _exit(2);
-            }
-            if (close(pipefds[1]) == -1)
-            {
-                perror("close pipefds[1] failed");
-                _exit(2);
-            }
-            char rom_path[FILENAME_MAX];
-            sprintf(rom_path, "/tmp/mgba-rom-test-hydra-%05d", getpid());
-            int tmpfd;
-            if ((tmpfd = open(rom_path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR)) == -1)
-            {
-                perror("open tmpfd failed");
-                _exit(2);
-            }
-            if ((write(tmpfd, elf, elfst.st_size)) == -1)
-            {
-                perror("write tmpfd failed");
-                _exit(2);
-            }
-            pid_t patchelfpid = fork();
-            if (patchelfpid == -1)
-            {
-                perror("fork patchelf failed");
-                _exit(2);
-            }
-            else if (patchelfpid == 0)
-            {
-                char n_arg[5], i_arg[5];
-                snprintf(n_arg, sizeof(n_arg), "\\x%02x", nrunners);
-                snprintf(i_arg, sizeof(i_arg), "\\x%02x", i);
-                if (execlp("tools/patchelf/patchelf", "tools/patchelf/patchelf", rom_path, "gTestRunnerN", n_arg, "gTestRunnerI", i_arg, NULL) == -1)
-                {
-                    perror("execlp patchelf failed");
-                    _exit(2);
-                }
-            }
-            else
-            {
-                int wstatus;
-                if (waitpid(patchelfpid, &wstatus, 0) == -1)
-                {
-                    perror("waitpid patchelfpid failed");
-                    _exit(2);
-                }
-                if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
-                {
-                    fprintf(stderr, "patchelf exited with an error\n");
-                    _exit(2);
-                }
-            }
-#ifdef __APPLE__
-            pid_t objcopypid = fork();
-            if (objcopypid == -1)
-            {
-                perror("fork objcopy failed");
-                _exit(2);
-            }
-            else if (objcopypid == 0)
-            {
-                if (execlp(argv[2], argv[2], "-O", "binary", rom_path, rom_path, NULL) == -1)
-                {
-                    perror("execlp objcopy failed");
-                    _exit(2);
-                }
-            }
-            else
-            {
-                int wstatus;
-                if (waitpid(objcopypid, &wstatus, 0) == -1)
-                {
-                    perror("waitpid objcopy failed");
-                    _exit(2);
-                }
-                if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0)
-                {
-                    fprintf(stderr, "objcopy exited with an error\n");
-                    _exit(2);
-                }
-            }
-#endif
-            // stdbuf is required because otherwise mgba never flushes
-            // stdout.
-            if (execlp("stdbuf", "stdbuf", "-oL", argv[1], "-l15", "-ClogLevel.gba.dma=16", "-Rr0", rom_path, NULL) == -1)
-            {
-                perror("execl stdbuf mgba-rom-test failed");
-                _exit(2);
-            }
-        } else {
-            runners[i].pid = pid;
-            sprintf(runners[i].rom_path, "/tmp/mgba-rom-test-hydra-%05d", runners[i].pid);
-            runners[i].outfd = pipefds[0];
-            if (close(pipefds[1]) == -1)
-            {
-                perror("close pipefds[1] failed");
-                exit(2);
-            }
-        }
-    }
-
-    // Process test runner output.
-    int openfds = nrunners;
+    parent_pid = getpid();
     struct pollfd *pollfds = calloc(nrunners, sizeof(*pollfds));
     if (!pollfds)
     {
         perror("calloc pollfds failed");
         exit(2);
     }
+    int openfds = 0;
     for (int i = 0; i < nrunners; i++)
     {
+        unsigned batch_start = 0, batch_end = 0;
+        if (!batch_tests || next_batch(&batch_start, &batch_end))
+        {
+            start_runner(i, argv[1], argv[2], elf, elfst.st_size, batch_start, batch_end);
+            openfds++;
+        }
+        else
+        {
+            runners[i].outfd = -1;
+        }
         pollfds[i].fd = runners[i].outfd;
         pollfds[i].events = POLLIN;
     }
+
+    // Process test runner output.
     while (openfds > 0)
     {
         if (tty)
@@ -505,6 +1030,15 @@ int main(int argc, char *argv[])
                     perror("close pollfds[i] failed");
                     exit(2);
                 }
+                unsigned batch_start, batch_end;
+                if (batch_tests && next_batch(&batch_start, &batch_end))
+                {
+                    // Hand the next batch to the now idle runner.
+                    reap_runner(i);
+                    start_runner(i, argv[1], argv[2], elf, elfst.st_size, batch_start, batch_end);
+                    pollfds[i].fd = runners[i].outfd;
+                    continue;
+                }
                 runners[i].outfd = pollfds[i].fd = -pollfds[i].fd;
                 openfds--;
             }
@@ -523,7 +1057,6 @@ int main(int argc, char *argv[])
     }
 
     // Reap test runners and collate exit codes.
-    int exit_code = 0;
     int passes = 0;
     int knownFails = 0;
     int knownFailsPassing = 0;
@@ -537,16 +1070,8 @@ int main(int argc, char *argv[])
 
     for (int i = 0; i < nrunners; i++)
     {
-        int wstatus;
-        if (waitpid(runners[i].pid, &wstatus, 0) == -1)
-        {
-            perror("waitpid runners[i] failed");
-            exit(2);
-        }
-        if (runners[i].output_buffer_size > 0)
-            fwrite(runners[i].output_buffer, 1, runners[i].output_buffer_size, stdout);
-        if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) > exit_code)
-            exit_code = WEXITSTATUS(wstatus);
+        if (runners[i].pid != 0)
+            reap_runner(i);
         passes += runners[i].passes;
         knownFails += runners[i].knownFails;
         for (int j = 0; j < runners[i].knownFailsPassing; j++)
@@ -611,9 +1136,15 @@ int main(int argc, char *argv[])
             fprintf(stdout, "- \e[33mASSUMPTIONS_FAILED\e[0m:   %d\n", assumptionFails);
 
         fprintf(stdout, "- Tests \e[34mTOTAL\e[0m:          %d\n", results);
+        if (snapshots)
+            fprintf(stdout, "- Snapshots saved:      %lu frames (%.1fs)\n", snapshot_frames_saved, snapshot_frames_saved / 59.7275);
+        print_simulations();
     }
     fprintf(stdout, "\n");
 
+    if (test_costs_path)
+        write_test_costs(test_costs_path);
+
     fflush(stdout);
     return exit_code;
 }
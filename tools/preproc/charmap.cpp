@@ -21,6 +21,7 @@
 #include <cstdio>
 #include <cstdint>
 #include <cstdarg>
+#include <cstring>
 #include "preproc.h"
 #include "charmap.h"
 #include "char_util.h"
@@ -369,8 +370,44 @@ void CharmapReader::SkipWhitespace()
         m_pos++;
 }
 
+// A compiled charmap is a header, followed by tables sorted so that
+// lookups can binary search them, followed by the byte sequences. All
+// offsets are from the start of the image and all integers are
+// little-endian, so the image is used as it is loaded.
+//
+//     char     magic[8]           "PPCHARM1"
+//     u32      numChars
+//     u32      numConstants
+//     u32      escapes[128][2]    (offset, length) of each escape
+//     u32      chars[][3]         code, offset, length, sorted by code
+//     u32      constants[][4]     name offset, name length, offset,
+//                                 length, sorted by name
+//     u8       sequences and names
+static const char kCompiledMagic[8] = { 'P', 'P', 'C', 'H', 'A', 'R', 'M', '1' };
+static const std::size_t kHeaderSize = 16;
+static const std::size_t kEscapesSize = 128 * 2 * 4;
+
+static std::uint32_t ReadU32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((std::uint32_t)p[3] << 24);
+}
+
+static void AppendU32(std::vector<unsigned char>& image, std::uint32_t value)
+{
+    image.push_back(value & 0xFF);
+    image.push_back((value >> 8) & 0xFF);
+    image.push_back((value >> 16) & 0xFF);
+    image.push_back((value >> 24) & 0xFF);
+}
+
 Charmap::Charmap(std::string filename)
 {
+    if (Load(filename))
+        return;
+
+    std::map<std::int32_t, std::string> chars;
+    std::string escapes[128];
+    std::map<std::string, std::string> constants;
     CharmapReader reader(filename);
 
     for (;;)
@@ -378,7 +415,7 @@ Charmap::Charmap(std::string filename)
         Lhs lhs = reader.ReadLhs();
 
         if (lhs.type == LhsType::None)
-            return;
+            break;
 
         reader.ExpectEqualsSign();
 
@@ -387,22 +424,173 @@ Charmap::Charmap(std::string filename)
         switch (lhs.type)
         {
         case LhsType::Char:
-            if (m_chars.find(lhs.code) != m_chars.end())
+            if (chars.find(lhs.code) != chars.end())
                 reader.RaiseError("redefining char");
-            m_chars[lhs.code] = sequence;
+            chars[lhs.code] = sequence;
             break;
         case LhsType::Escape:
-            if (m_escapes[lhs.code].length() != 0)
+            if (escapes[lhs.code].length() != 0)
                 reader.RaiseError("redefining escape");
-            m_escapes[lhs.code] = sequence;
+            escapes[lhs.code] = sequence;
             break;
         case LhsType::Constant:
-            if (m_constants.find(lhs.name) != m_constants.end())
+            if (constants.find(lhs.name) != constants.end())
                 reader.RaiseError("redefining constant");
-            m_constants[lhs.name] = sequence;
+            constants[lhs.name] = sequence;
             break;
         }
 
         reader.ExpectEmptyRestOfLine();
     }
+
+    Compile(chars, escapes, constants);
+}
+
+void Charmap::Compile(const std::map<std::int32_t, std::string>& chars, const std::string (&escapes)[128], const std::map<std::string, std::string>& constants)
+{
+    std::size_t tablesSize = kHeaderSize + kEscapesSize + chars.size() * 12 + constants.size() * 16;
+    std::vector<unsigned char> sequences;
+
+    m_image.clear();
+    for (char c : kCompiledMagic)
+        m_image.push_back(c);
+    AppendU32(m_image, chars.size());
+    AppendU32(m_image, constants.size());
+
+    auto appendSequence = [&](const std::string& sequence) {
+        AppendU32(m_image, tablesSize + sequences.size());
+        AppendU32(m_image, sequence.length());
+        sequences.insert(sequences.end(), sequence.begin(), sequence.end());
+    };
+
+    for (int i = 0; i < 128; i++)
+        appendSequence(escapes[i]);
+
+    // std::map iterates in key order, so the tables come out sorted.
+    for (const auto& it : chars)
+    {
+        AppendU32(m_image, it.first);
+        appendSequence(it.second);
+    }
+
+    for (const auto& it : constants)
+    {
+        appendSequence(it.first);
+        appendSequence(it.second);
+    }
+
+    m_image.insert(m_image.end(), sequences.begin(), sequences.end());
+}
+
+// Returns false if the file is not a compiled charmap.
+bool Charmap::Load(std::string filename)
+{
+    FILE *fp = std::fopen(filename.c_str(), "rb");
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\" for reading.\n", filename.c_str());
+
+    char magic[sizeof(kCompiledMagic)];
+
+    if (std::fread(magic, sizeof(magic), 1, fp) != 1 || std::memcmp(magic, kCompiledMagic, sizeof(magic)) != 0)
+    {
+        std::fclose(fp);
+        return false;
+    }
+
+    std::fseek(fp, 0, SEEK_END);
+    long size = std::ftell(fp);
+    std::rewind(fp);
+
+    if (size < (long)(kHeaderSize + kEscapesSize))
+        FATAL_ERROR("Compiled charmap \"%s\" is truncated.\n", filename.c_str());
+
+    m_image.resize(size);
+
+    if (std::fread(m_image.data(), size, 1, fp) != 1)
+        FATAL_ERROR("Failed to read \"%s\".\n", filename.c_str());
+
+    std::fclose(fp);
+
+    std::uint32_t numChars = ReadU32(&m_image[8]);
+    std::uint32_t numConstants = ReadU32(&m_image[12]);
+
+    if (kHeaderSize + kEscapesSize + (std::uint64_t)numChars * 12 + (std::uint64_t)numConstants * 16 > (std::uint64_t)size)
+        FATAL_ERROR("Compiled charmap \"%s\" is truncated.\n", filename.c_str());
+
+    return true;
+}
+
+void Charmap::Save(std::string filename)
+{
+    FILE *fp = std::fopen(filename.c_str(), "wb");
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\" for writing.\n", filename.c_str());
+
+    if (std::fwrite(m_image.data(), m_image.size(), 1, fp) != 1 || std::fclose(fp) != 0)
+        FATAL_ERROR("Failed to write \"%s\".\n", filename.c_str());
+}
+
+std::string Charmap::Sequence(std::uint32_t offset, std::uint32_t length)
+{
+    if ((std::uint64_t)offset + length > m_image.size())
+        FATAL_ERROR("Compiled charmap is corrupt.\n");
+
+    return std::string(reinterpret_cast<const char *>(&m_image[offset]), length);
+}
+
+std::string Charmap::Char(std::int32_t code)
+{
+    const unsigned char *chars = &m_image[kHeaderSize + kEscapesSize];
+    std::uint32_t lo = 0;
+    std::uint32_t hi = ReadU32(&m_image[8]);
+
+    while (lo < hi)
+    {
+        std::uint32_t mid = lo + (hi - lo) / 2;
+        const unsigned char *entry = chars + mid * 12;
+        std::int32_t entryCode = (std::int32_t)ReadU32(entry);
+
+        if (entryCode == code)
+            return Sequence(ReadU32(entry + 4), ReadU32(entry + 8));
+        else if (entryCode < code)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return std::string();
+}
+
+std::string Charmap::Escape(unsigned char code)
+{
+    if (code >= 128)
+        return std::string();
+
+    const unsigned char *entry = &m_image[kHeaderSize + code * 8];
+    return Sequence(ReadU32(entry), ReadU32(entry + 4));
+}
+
+std::string Charmap::Constant(std::string identifier)
+{
+    const unsigned char *constants = &m_image[kHeaderSize + kEscapesSize + ReadU32(&m_image[8]) * 12];
+    std::uint32_t lo = 0;
+    std::uint32_t hi = ReadU32(&m_image[12]);
+
+    while (lo < hi)
+    {
+        std::uint32_t mid = lo + (hi - lo) / 2;
+        const unsigned char *entry = constants + mid * 16;
+        int cmp = Sequence(ReadU32(entry), ReadU32(entry + 4)).compare(identifier);
+
+        if (cmp == 0)
+            return Sequence(ReadU32(entry + 8), ReadU32(entry + 12));
+        else if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return std::string();
 }
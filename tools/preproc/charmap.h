@@ -31,34 +31,18 @@ class Charmap
 public:
     Charmap(std::string filename);
 
-    std::string Char(std::int32_t code)
-    {
-        auto it = m_chars.find(code);
+    std::string Char(std::int32_t code);
+    std::string Escape(unsigned char code);
+    std::string Constant(std::string identifier);
+    void Save(std::string filename);
 
-        if (it == m_chars.end())
-            return std::string();
-
-        return it->second;
-    }
-
-    std::string Escape(unsigned char code)
-    {
-        return m_escapes[code];
-    }
-
-    std::string Constant(std::string identifier)
-    {
-        auto it = m_constants.find(identifier);
-
-        if (it == m_constants.end())
-            return std::string();
-
-        return it->second;
-    }
 private:
-    std::map<std::int32_t, std::string> m_chars;
-    std::string m_escapes[128];
-    std::map<std::string, std::string> m_constants;
+    // The charmap compiled by Compile, or loaded as it was saved.
+    std::vector<unsigned char> m_image;
+
+    void Compile(const std::map<std::int32_t, std::string>& chars, const std::string (&escapes)[128], const std::map<std::string, std::string>& constants);
+    bool Load(std::string filename);
+    std::string Sequence(std::uint32_t offset, std::uint32_t length);
 };
 
 #endif // CHARMAP_H
@@ -18,6 +18,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <cstring>
 #include <string>
 #include <stack>
 #include "preproc.h"
@@ -140,35 +141,76 @@ char* GetFileExtension(char* filename)
     return extension;
 }
 
+void PreprocFile(char *filename, bool isStdin)
+{
+    char* extension = GetFileExtension(filename);
+
+    if (!extension)
+        FATAL_ERROR("\"%s\" has no file extension.\n", filename);
+
+    if ((extension[0] == 's') && extension[1] == 0)
+        PreprocAsmFile(filename);
+    else if ((extension[0] == 'c' || extension[0] == 'i') && extension[1] == 0)
+        PreprocCFile(filename, isStdin);
+    else
+        FATAL_ERROR("\"%s\" has an unknown file extension of \"%s\".\n", filename, extension);
+}
+
+// Preprocesses each SRC_FILE:OUT_FILE pair with one load of the charmap.
+void PreprocFiles(int count, char **pairs)
+{
+    for (int i = 0; i < count; i++)
+    {
+        char *separator = std::strrchr(pairs[i], ':');
+
+        if (separator == nullptr)
+            FATAL_ERROR("expected SRC_FILE:OUT_FILE, got \"%s\".\n", pairs[i]);
+
+        *separator = '\0';
+
+        if (std::freopen(separator + 1, "w", stdout) == nullptr)
+            FATAL_ERROR("Failed to open \"%s\" for writing.\n", separator + 1);
+
+        PreprocFile(pairs[i], false);
+
+        if (std::fflush(stdout) != 0)
+            FATAL_ERROR("Failed to write \"%s\".\n", separator + 1);
+    }
+}
+
 int main(int argc, char **argv)
 {
+    if (argc == 4 && std::strcmp(argv[1], "-c") == 0)
+    {
+        Charmap(argv[2]).Save(argv[3]);
+        return 0;
+    }
+
+    if (argc >= 3 && std::strcmp(argv[1], "-m") == 0)
+    {
+        g_charmap = new Charmap(argv[2]);
+        PreprocFiles(argc - 3, argv + 3);
+        return 0;
+    }
+
     if (argc < 3 || argc > 4)
     {
-        std::fprintf(stderr, "Usage: %s SRC_FILE CHARMAP_FILE [-i]\nwhere -i denotes if input is from stdin\n", argv[0]);
+        std::fprintf(stderr,
+            "Usage: %s SRC_FILE CHARMAP_FILE [-i]\n"
+            "       %s -m CHARMAP_FILE SRC_FILE:OUT_FILE...\n"
+            "       %s -c CHARMAP_FILE OUT_FILE\n"
+            "where -i denotes if input is from stdin, -m preprocesses several files\n"
+            "and -c compiles a charmap so that it can be loaded without parsing it\n",
+            argv[0], argv[0], argv[0]);
         return 1;
     }
 
     g_charmap = new Charmap(argv[2]);
 
-    char* extension = GetFileExtension(argv[1]);
-
-    if (!extension)
-        FATAL_ERROR("\"%s\" has no file extension.\n", argv[1]);
+    if (argc == 4 && !(argv[3][0] == '-' && argv[3][1] == 'i' && argv[3][2] == '\0'))
+        FATAL_ERROR("unknown argument flag \"%s\".\n", argv[3]);
 
-    if ((extension[0] == 's') && extension[1] == 0)
-        PreprocAsmFile(argv[1]);
-    else if ((extension[0] == 'c' || extension[0] == 'i') && extension[1] == 0) {
-        if (argc == 4) {
-            if (argv[3][0] == '-' && argv[3][1] == 'i' && argv[3][2] == '\0') {
-                PreprocCFile(argv[1], true);
-            } else {
-                FATAL_ERROR("unknown argument flag \"%s\".\n", argv[3]);
-            }
-        } else {
-            PreprocCFile(argv[1], false);
-        }
-    } else
-        FATAL_ERROR("\"%s\" has an unknown file extension of \"%s\".\n", argv[1], extension);
+    PreprocFile(argv[1], argc == 4);
 
     return 0;
 }
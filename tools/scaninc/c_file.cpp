@@ -18,6 +18,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <cctype>
 #include "c_file.h"
 
 CFile::CFile(std::string path)
@@ -192,6 +193,11 @@ void CFile::CheckInclude()
 
     ConsumeHorizontalWhitespace();
 
+    // Computed includes (#include MACRO) can't be followed, their
+    // dependencies have to be given in the Makefile.
+    if (std::isalpha(m_buffer[m_pos]) || m_buffer[m_pos] == '_')
+        return;
+
     std::string path = ReadPath();
 
     if (!path.empty()) {
@@ -0,0 +1,159 @@
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include "dependency_cache.h"
+
+#define CACHE_VERSION "scaninc cache 1"
+
+static bool GetModificationTime(const std::string& path, long long& mtime, long long& size)
+{
+    struct stat st;
+
+    if (stat(path.c_str(), &st) != 0)
+        return false;
+
+#if defined(__APPLE__)
+    mtime = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    mtime = st.st_mtime * 1000000000LL;
+#else
+    mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    size = st.st_size;
+    return true;
+}
+
+static std::string GetSrcDir(const std::string& path)
+{
+    std::size_t slash = path.rfind('/');
+
+    if (slash != std::string::npos)
+        return path.substr(0, slash + 1);
+    else
+        return std::string("");
+}
+
+DependencyCache::DependencyCache(std::string path) : m_path(path), m_dirty(false)
+{
+    if (!m_path.empty())
+        Load();
+}
+
+// Reads the cache written by Save. A cache which cannot be read is
+// treated as empty, so every file is scanned again.
+void DependencyCache::Load()
+{
+    FILE *fp = std::fopen(m_path.c_str(), "rb");
+
+    if (fp == NULL)
+        return;
+
+    char line[4 * SCANINC_MAX_PATH];
+    Entry *entry = NULL;
+
+    if (std::fgets(line, sizeof(line), fp) == NULL || std::strcmp(line, CACHE_VERSION "\n") != 0)
+    {
+        std::fclose(fp);
+        return;
+    }
+
+    while (std::fgets(line, sizeof(line), fp) != NULL)
+    {
+        std::size_t length = std::strlen(line);
+
+        if (length < 3 || line[length - 1] != '\n' || line[1] != '\t')
+            break;
+        line[length - 1] = '\0';
+
+        if (line[0] == 'F')
+        {
+            char *mtime = std::strchr(line + 2, '\t');
+            char *size = mtime ? std::strchr(mtime + 1, '\t') : NULL;
+            char *type = size ? std::strchr(size + 1, '\t') : NULL;
+
+            if (type == NULL)
+                break;
+            *mtime = *size = *type = '\0';
+
+            std::string path(line + 2);
+            entry = &m_entries[path];
+            entry->mtime = std::strtoll(mtime + 1, NULL, 10);
+            entry->size = std::strtoll(size + 1, NULL, 10);
+            entry->file.type = static_cast<SourceFileType>(std::atoi(type + 1));
+            entry->file.srcDir = GetSrcDir(path);
+        }
+        else if (line[0] == 'I' && entry != NULL)
+        {
+            entry->file.includes.insert(line + 2);
+        }
+        else if (line[0] == 'B' && entry != NULL)
+        {
+            entry->file.incbins.insert(line + 2);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    std::fclose(fp);
+}
+
+void DependencyCache::Save()
+{
+    if (m_path.empty() || !m_dirty)
+        return;
+
+    std::string tmpPath = m_path + ".tmp";
+    FILE *fp = std::fopen(tmpPath.c_str(), "wb");
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\" for writing.\n", tmpPath.c_str());
+
+    std::fprintf(fp, CACHE_VERSION "\n");
+    for (const auto& it : m_entries)
+    {
+        const Entry& entry = it.second;
+        std::fprintf(fp, "F\t%s\t%lld\t%lld\t%d\n", it.first.c_str(), entry.mtime, entry.size, static_cast<int>(entry.file.type));
+        for (const std::string& include : entry.file.includes)
+            std::fprintf(fp, "I\t%s\n", include.c_str());
+        for (const std::string& incbin : entry.file.incbins)
+            std::fprintf(fp, "B\t%s\n", incbin.c_str());
+    }
+
+    if (std::fclose(fp) != 0)
+        FATAL_ERROR("Failed to write \"%s\".\n", tmpPath.c_str());
+
+    std::remove(m_path.c_str());
+    if (std::rename(tmpPath.c_str(), m_path.c_str()) != 0)
+        FATAL_ERROR("Failed to rename \"%s\" to \"%s\".\n", tmpPath.c_str(), m_path.c_str());
+}
+
+const ScannedFile& DependencyCache::Scan(const std::string& path)
+{
+    auto it = m_entries.find(path);
+
+    // Each file is only checked against the disk once per run.
+    if (it != m_entries.end() && m_checked.count(path))
+        return it->second.file;
+
+    long long mtime, size;
+
+    if (!GetModificationTime(path, mtime, size))
+        FATAL_ERROR("Failed to open \"%s\" for reading.\n", path.c_str());
+
+    m_checked.insert(path);
+    if (it != m_entries.end() && it->second.mtime == mtime && it->second.size == size)
+        return it->second.file;
+
+    SourceFile file(path);
+    Entry& entry = m_entries[path];
+    entry.mtime = mtime;
+    entry.size = size;
+    entry.file.type = file.FileType();
+    entry.file.srcDir = file.GetSrcDir();
+    entry.file.incbins = file.GetIncbins();
+    entry.file.includes = file.GetIncludes();
+    m_dirty = true;
+    return entry.file;
+}
@@ -0,0 +1,47 @@
+#ifndef DEPENDENCY_CACHE_H
+#define DEPENDENCY_CACHE_H
+
+#include <map>
+#include <set>
+#include <string>
+#include "scaninc.h"
+#include "source_file.h"
+
+// The includes and incbins found in a file by CFile or AsmFile, before
+// they are resolved against the include directories.
+struct ScannedFile
+{
+    SourceFileType type;
+    std::string srcDir;
+    std::set<std::string> incbins;
+    std::set<std::string> includes;
+};
+
+// Remembers what each file includes, keyed by its path and tagged with
+// its mtime and size, so that files which have not changed since the
+// last run are not read again. The cache is a text file which is only
+// rewritten if a file had to be scanned.
+class DependencyCache
+{
+public:
+    DependencyCache(std::string path);
+    const ScannedFile& Scan(const std::string& path);
+    void Save();
+
+private:
+    struct Entry
+    {
+        long long mtime;
+        long long size;
+        ScannedFile file;
+    };
+
+    std::string m_path;
+    std::map<std::string, Entry> m_entries;
+    std::set<std::string> m_checked;
+    bool m_dirty;
+
+    void Load();
+};
+
+#endif // DEPENDENCY_CACHE_H
@@ -20,12 +20,16 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <list>
+#include <map>
 #include <queue>
 #include <set>
 #include <string>
+#include <vector>
 #include "scaninc.h"
 #include "source_file.h"
+#include "dependency_cache.h"
 
 bool CanOpenFile(std::string path)
 {
@@ -38,14 +42,102 @@ bool CanOpenFile(std::string path)
     return true;
 }
 
-const char *const USAGE = "Usage: scaninc [-I INCLUDE_PATH] FILE_PATH\n";
+const char *const USAGE = "Usage: scaninc [-I INCLUDE_PATH] FILE_PATH\n"
+                          "       scaninc [-I INCLUDE_PATH] [-c CACHE_PATH] -o DEP_PATH TARGET=FILE_PATH...\n";
 
-int main(int argc, char **argv)
+struct Dependency
+{
+    std::string path;
+    bool exists;
+};
+
+class DependencyScanner
+{
+public:
+    DependencyScanner(DependencyCache& cache, std::vector<std::string>& includeDirs)
+        : m_cache(cache), m_includeDirs(includeDirs) {}
+    std::set<std::string> Scan(const std::string& initialPath);
+
+private:
+    DependencyCache& m_cache;
+    std::vector<std::string>& m_includeDirs;
+    std::map<std::string, std::vector<Dependency>> m_resolved;
+
+    const std::vector<Dependency>& Resolve(const std::string& filePath);
+};
+
+// Includes are resolved against the include directories and the
+// directory of the file which includes them, so what a file depends on
+// is the same whichever source included it, and is only worked out once
+// per run.
+const std::vector<Dependency>& DependencyScanner::Resolve(const std::string& filePath)
+{
+    auto it = m_resolved.find(filePath);
+    if (it != m_resolved.end())
+        return it->second;
+
+    const ScannedFile& file = m_cache.Scan(filePath);
+    std::vector<Dependency>& dependencies = m_resolved[filePath];
+
+    m_includeDirs.push_back(file.srcDir);
+    for (auto incbin : file.incbins)
+    {
+        dependencies.push_back({incbin, false});
+    }
+    for (auto include : file.includes)
+    {
+        bool exists = false;
+        std::string path("");
+        for (auto includeDir : m_includeDirs)
+        {
+            path = includeDir + include;
+            if (CanOpenFile(path))
+            {
+                exists = true;
+                break;
+            }
+        }
+        if (!exists && (file.type == SourceFileType::Asm || file.type == SourceFileType::Inc))
+        {
+            path = include;
+        }
+        dependencies.push_back({path, exists});
+    }
+    m_includeDirs.pop_back();
+
+    return dependencies;
+}
+
+std::set<std::string> DependencyScanner::Scan(const std::string& initialPath)
 {
     std::queue<std::string> filesToProcess;
     std::set<std::string> dependencies;
 
+    filesToProcess.push(initialPath);
+
+    while (!filesToProcess.empty())
+    {
+        std::string filePath = filesToProcess.front();
+        filesToProcess.pop();
+
+        for (const Dependency& dependency : Resolve(filePath))
+        {
+            bool inserted = dependencies.insert(dependency.path).second;
+            if (inserted && dependency.exists)
+            {
+                filesToProcess.push(dependency.path);
+            }
+        }
+    }
+
+    return dependencies;
+}
+
+int main(int argc, char **argv)
+{
     std::vector<std::string> includeDirs;
+    std::string cachePath;
+    std::string depPath;
 
     argc--;
     argv++;
@@ -68,61 +160,69 @@ int main(int argc, char **argv)
             }
             includeDirs.push_back(includeDir);
         }
+        else if (arg == "-c")
+        {
+            argc--;
+            argv++;
+            cachePath = std::string(argv[0]);
+        }
+        else if (arg == "-o")
+        {
+            argc--;
+            argv++;
+            depPath = std::string(argv[0]);
+        }
         else
         {
-            FATAL_ERROR(USAGE);
+            break;
         }
         argc--;
         argv++;
     }
 
-    if (argc != 1) {
-        FATAL_ERROR(USAGE);
-    }
-
-    std::string initialPath(argv[0]);
-
-    filesToProcess.push(initialPath);
+    DependencyCache cache(cachePath);
+    DependencyScanner scanner(cache, includeDirs);
 
-    while (!filesToProcess.empty())
+    if (depPath.empty())
     {
-        std::string filePath = filesToProcess.front();
-        SourceFile file(filePath);
-        filesToProcess.pop();
+        if (argc != 1 || argv[0][0] == '-')
+            FATAL_ERROR(USAGE);
 
-        includeDirs.push_back(file.GetSrcDir());
-        for (auto incbin : file.GetIncbins())
+        for (const std::string &path : scanner.Scan(std::string(argv[0])))
         {
-            dependencies.insert(incbin);
+            std::printf("%s\n", path.c_str());
         }
-        for (auto include : file.GetIncludes())
+    }
+    else
+    {
+        // Batch mode: writes a make rule listing the dependencies of
+        // each TARGET=FILE_PATH.
+        std::string rules;
+
+        if (argc < 1)
+            FATAL_ERROR(USAGE);
+
+        for (; argc > 0; argc--, argv++)
         {
-            bool exists = false;
-            std::string path("");
-            for (auto includeDir : includeDirs)
-            {
-                path = includeDir + include;
-                if (CanOpenFile(path))
-                {
-                    exists = true;
-                    break;
-                }
-            }
-            if (!exists && (file.FileType() == SourceFileType::Asm || file.FileType() == SourceFileType::Inc))
-            {
-                path = include;
-            }
-            bool inserted = dependencies.insert(path).second;
-            if (inserted && exists)
+            const char *equals = std::strchr(argv[0], '=');
+            if (equals == NULL || equals == argv[0] || argv[0][0] == '-')
+                FATAL_ERROR(USAGE);
+
+            rules += std::string(argv[0], equals - argv[0]) + ":";
+            for (const std::string &path : scanner.Scan(std::string(equals + 1)))
             {
-                filesToProcess.push(path);
+                rules += " " + path;
             }
+            rules += "\n";
         }
-        includeDirs.pop_back();
-    }
 
-    for (const std::string &path : dependencies)
-    {
-        std::printf("%s\n", path.c_str());
+        FILE *fp = std::fopen(depPath.c_str(), "wb");
+        if (fp == NULL)
+            FATAL_ERROR("Failed to open \"%s\" for writing.\n", depPath.c_str());
+        std::fwrite(rules.data(), 1, rules.size(), fp);
+        if (std::fclose(fp) != 0)
+            FATAL_ERROR("Failed to write \"%s\".\n", depPath.c_str());
     }
+
+    cache.Save();
 }
@@ -0,0 +1,84 @@
+import json
+import re
+import sys
+
+# Generates a table of the wild encounter header used by each map, so
+# that finding the current map's header does not have to scan
+# gWildMonHeaders. The maps are laid out group by group in the order
+# given by map_groups.h, and each entry is the index of the map's first
+# header in gWildMonHeaders plus one, or 0 if the map has no header.
+#
+# usage: header_index.py <wild_encounters.json> <map_groups.h> <output.h>
+
+if len(sys.argv) != 4:
+    print("usage: %s <wild_encounters.json> <map_groups.h> <output.h>" % sys.argv[0], file=sys.stderr)
+    sys.exit(1)
+
+encounters_path = sys.argv[1]
+map_groups_path = sys.argv[2]
+output_path = sys.argv[3]
+
+map_define = re.compile(r"^#define (MAP_\w+)\s+\((\d+) \| \((\d+) << 8\)\)$")
+
+maps = {}
+group_sizes = []
+with open(map_groups_path, "r") as file:
+    for line in file:
+        match = map_define.match(line.strip())
+        if match:
+            num = int(match.group(2))
+            group = int(match.group(3))
+            maps[match.group(1)] = (group, num)
+            while len(group_sizes) <= group:
+                group_sizes.append(0)
+            group_sizes[group] = max(group_sizes[group], num + 1)
+
+with open(encounters_path, "r") as file:
+    data = json.load(file)
+
+header_ids = {}
+header_count = 0
+for group in data["wild_encounter_groups"]:
+    if not group.get("for_maps"):
+        continue
+    header_count = len(group["encounters"])
+    for i, encounter in enumerate(group["encounters"]):
+        name = encounter["map"]
+        if name not in maps:
+            print("%s: %s is not defined in %s" % (encounters_path, name, map_groups_path), file=sys.stderr)
+            sys.exit(1)
+        if name not in header_ids:
+            header_ids[name] = i
+
+offsets = [0]
+for size in group_sizes:
+    offsets.append(offsets[-1] + size)
+
+id_type = "u8" if header_count < 0xFF else "u16"
+
+out = []
+out.append("//")
+out.append("// DO NOT MODIFY THIS FILE! It is auto-generated from %s" % encounters_path)
+out.append("// by tools/wild_encounter_helpers/header_index.py")
+out.append("//")
+out.append("")
+out.append("#define WILD_MON_HEADER_INDEX_GROUPS %d" % len(group_sizes))
+out.append("")
+out.append("// Index in sWildMonHeaderIndex of each map group's first map.")
+out.append("static const u16 sWildMonHeaderIndexGroupOffsets[WILD_MON_HEADER_INDEX_GROUPS + 1] =")
+out.append("{")
+for offset in offsets:
+    out.append("    %d," % offset)
+out.append("};")
+out.append("")
+out.append("// Index in gWildMonHeaders of each map's header plus one, or 0 if the map has none.")
+out.append("static const %s sWildMonHeaderIndex[%d] =" % (id_type, offsets[-1]))
+out.append("{")
+for name, header_id in sorted(header_ids.items(), key=lambda item: maps[item[0]]):
+    group, num = maps[name]
+    out.append("    [%d] = %d, // %s" % (offsets[group] + num, header_id + 1, name))
+out.append("};")
+out.append("")
+
+with open(output_path, "w") as file:
+    file.write("\n".join(out))